@@ -0,0 +1,105 @@
+// Custom Non‑Commercial License
+
+// Copyright (c) 2025 Mgoodell97
+
+// Permission is hereby granted, free of charge, to any individual or
+// non‑commercial entity obtaining a copy of this software and associated
+// documentation files (the "Software"), to use, copy, modify, merge, publish,
+// and distribute the Software for personal, educational, or research purposes,
+// subject to the following conditions:
+
+// 1. Commercial Use:
+//    Any company, corporation, or organization intending to use the Software
+//    must first notify the copyright holder and obtain explicit written
+//    permission. Commercial use without such permission is strictly prohibited.
+
+// 2. Unauthorized Commercial Use:
+//    If a company is found to be using the Software without prior authorization,
+//    the copyright holder is entitled to receive 1% of the company’s gross
+//    profits moving forward, enforceable as a licensing fee.
+
+// 3. Artificial Intelligence / Machine Learning Use:
+//    If the Software is incorporated into machine learning
+//    models, neural networks, generative pre‑trained transformers (GPTs), or similar AI systems,
+//    the company deploying such use is solely responsible for compliance with
+//    this license. Responsibility cannot be shifted to the provider of training
+//    data or third‑party services.
+
+// 4. Attribution:
+//    The above copyright notice and this permission notice shall be included in
+//    all copies or substantial portions of the Software.
+
+// Disclaimer:
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Per step time of a fixed particle count against KLD-sampling on the same run. The first steps still need the
+// whole cloud, the converged phase is where KLD-sampling should pay off.
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <string>
+
+#include "particle_filter.hpp"
+
+void runBenchmark(const std::string& name, const PF_Params& pf_params)
+{
+    constexpr int64_t NUM_STEPS = 40;
+    constexpr int64_t CONVERGED_STEP = 20;
+    const double sensor_std = 1.0;
+    const State waypoint{75.0, 75.0};
+    State robot{10.0, 10.0};
+    ParticleFilter pf{pf_params, &likelihoodFunction, &moveEstimatedState};
+
+    double first_step_ms = 0.0;
+    double converged_ms = 0.0;
+    int64_t converged_particles = 0;
+    for (int64_t step = 0; step < NUM_STEPS; ++step)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        pf.updateWeights(sensorFunction(robot), sensor_std);
+        pf.getXHat();
+        pf.resample();
+        pf.mutateParticles(pf_params.particle_propogation_std);
+        pf.propogateState(waypoint);
+        const auto stop = std::chrono::steady_clock::now();
+        moveEstimatedState(robot, waypoint);
+
+        const double step_ms = std::chrono::duration<double, std::milli>(stop - start).count();
+        if (step == 0)
+        {
+            first_step_ms = step_ms;
+        }
+        if (step >= CONVERGED_STEP)
+        {
+            converged_ms += step_ms;
+            converged_particles += pf.getNumParticles();
+        }
+    }
+
+    const int64_t num_converged_steps = NUM_STEPS - CONVERGED_STEP;
+    std::cout << std::setw(14) << name << std::setw(18) << first_step_ms << std::setw(22) << converged_ms / num_converged_steps
+              << std::setw(22) << converged_particles / num_converged_steps << "\n";
+}
+
+int main()
+{
+    PF_Params pf_params;
+    pf_params.num_of_particles = 1000000;
+    pf_params.particle_propogation_std = {0.5, 0.5};
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << std::setw(14) << "particles" << std::setw(18) << "first step (ms)" << std::setw(22) << "converged step (ms)"
+              << std::setw(22) << "converged count" << "\n";
+    runBenchmark("fixed", pf_params);
+    pf_params.adaptive_particle_count = true;
+    runBenchmark("KLD-sampling", pf_params);
+
+    return 0;
+}
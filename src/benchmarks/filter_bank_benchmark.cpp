@@ -0,0 +1,121 @@
+// Custom Non‑Commercial License
+
+// Copyright (c) 2025 Mgoodell97
+
+// Permission is hereby granted, free of charge, to any individual or
+// non‑commercial entity obtaining a copy of this software and associated
+// documentation files (the "Software"), to use, copy, modify, merge, publish,
+// and distribute the Software for personal, educational, or research purposes,
+// subject to the following conditions:
+
+// 1. Commercial Use:
+//    Any company, corporation, or organization intending to use the Software
+//    must first notify the copyright holder and obtain explicit written
+//    permission. Commercial use without such permission is strictly prohibited.
+
+// 2. Unauthorized Commercial Use:
+//    If a company is found to be using the Software without prior authorization,
+//    the copyright holder is entitled to receive 1% of the company’s gross
+//    profits moving forward, enforceable as a licensing fee.
+
+// 3. Artificial Intelligence / Machine Learning Use:
+//    If the Software is incorporated into machine learning
+//    models, neural networks, generative pre‑trained transformers (GPTs), or similar AI systems,
+//    the company deploying such use is solely responsible for compliance with
+//    this license. Responsibility cannot be shifted to the provider of training
+//    data or third‑party services.
+
+// 4. Attribution:
+//    The above copyright notice and this permission notice shall be included in
+//    all copies or substantial portions of the Software.
+
+// Disclaimer:
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Filter-steps per second for K filters of N particles each, a step being updateWeights then resampleMutatePropagate.
+// "separate" is K ParticleFilters that each start their own pool, "bank" is one FilterBank sharing a single pool.
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "filter_bank.hpp"
+
+constexpr int64_t STEPS = 10;
+
+double separateFiltersStepsPerSecond(const PF_Params& pf_params, const int64_t num_filters)
+{
+    std::vector<std::unique_ptr<ParticleFilter<>>> filters;
+    for (int64_t k = 0; k < num_filters; ++k)
+    {
+        PF_Params filter_params = pf_params;
+        filter_params.random_seed = pf_params.random_seed + k;
+        filters.push_back(std::make_unique<ParticleFilter<>>(filter_params, &likelihoodFunction, &moveEstimatedState));
+    }
+    const State robot{30.0, 40.0};
+    const State waypoint{50.0, 50.0};
+
+    const auto start = std::chrono::steady_clock::now();
+    for (int64_t step = 0; step < STEPS; ++step)
+    {
+        for (auto& filter : filters)
+        {
+            filter->updateWeights(sensorFunction(robot), 5.0);
+            filter->resampleMutatePropagate(pf_params.particle_propogation_std, waypoint);
+        }
+    }
+    const auto stop = std::chrono::steady_clock::now();
+    return static_cast<double>(num_filters * STEPS) / std::chrono::duration<double>(stop - start).count();
+}
+
+double bankStepsPerSecond(const PF_Params& pf_params, const int64_t num_filters)
+{
+    FilterBank bank{pf_params, num_filters, &likelihoodFunction, &moveEstimatedState};
+    const std::vector<double> observations(num_filters, sensorFunction(State{30.0, 40.0}));
+    const std::vector<State> waypoints(num_filters, State{50.0, 50.0});
+
+    const auto start = std::chrono::steady_clock::now();
+    for (int64_t step = 0; step < STEPS; ++step)
+    {
+        bank.updateWeights(observations, 5.0);
+        bank.resampleMutatePropagate(pf_params.particle_propogation_std, waypoints);
+    }
+    const auto stop = std::chrono::steady_clock::now();
+    return static_cast<double>(num_filters * STEPS) / std::chrono::duration<double>(stop - start).count();
+}
+
+int main()
+{
+    // Same particle total in every row, spread over more and more filters
+    const std::vector<std::pair<int64_t, int64_t>> shapes{{4, 250000}, {64, 16000}, {1024, 1000}};
+
+    std::cout << std::thread::hardware_concurrency() << " hardware threads, filter-steps per second\n";
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << std::setw(10) << "filters" << std::setw(12) << "particles" << std::setw(22) << "separate (multi)"
+              << std::setw(18) << "bank (single)" << std::setw(18) << "bank (multi)" << "\n";
+    for (const auto& [num_filters, num_particles] : shapes)
+    {
+        PF_Params pf_params;
+        pf_params.num_of_particles = num_particles;
+
+        pf_params.thread_mode = PF_THREAD_MODE::MULTI_THREADED;
+        const double separate = separateFiltersStepsPerSecond(pf_params, num_filters);
+        const double bank_multi = bankStepsPerSecond(pf_params, num_filters);
+        pf_params.thread_mode = PF_THREAD_MODE::SINGLE_THREADED;
+        const double bank_single = bankStepsPerSecond(pf_params, num_filters);
+
+        std::cout << std::setw(10) << num_filters << std::setw(12) << num_particles << std::setw(22) << separate
+                  << std::setw(18) << bank_single << std::setw(18) << bank_multi << "\n";
+    }
+
+    return 0;
+}
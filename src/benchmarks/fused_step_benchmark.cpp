@@ -0,0 +1,97 @@
+// Custom Non‑Commercial License
+
+// Copyright (c) 2025 Mgoodell97
+
+// Permission is hereby granted, free of charge, to any individual or
+// non‑commercial entity obtaining a copy of this software and associated
+// documentation files (the "Software"), to use, copy, modify, merge, publish,
+// and distribute the Software for personal, educational, or research purposes,
+// subject to the following conditions:
+
+// 1. Commercial Use:
+//    Any company, corporation, or organization intending to use the Software
+//    must first notify the copyright holder and obtain explicit written
+//    permission. Commercial use without such permission is strictly prohibited.
+
+// 2. Unauthorized Commercial Use:
+//    If a company is found to be using the Software without prior authorization,
+//    the copyright holder is entitled to receive 1% of the company’s gross
+//    profits moving forward, enforceable as a licensing fee.
+
+// 3. Artificial Intelligence / Machine Learning Use:
+//    If the Software is incorporated into machine learning
+//    models, neural networks, generative pre‑trained transformers (GPTs), or similar AI systems,
+//    the company deploying such use is solely responsible for compliance with
+//    this license. Responsibility cannot be shifted to the provider of training
+//    data or third‑party services.
+
+// 4. Attribution:
+//    The above copyright notice and this permission notice shall be included in
+//    all copies or substantial portions of the Software.
+
+// Disclaimer:
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// resample, mutateParticles and propogateState called one after the other against the fused
+// resampleMutatePropagate. Both see the same weights and produce the same particles.
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <string>
+
+#include "particle_filter.hpp"
+
+template<typename F>
+double timeStepsMs(const PF_Params& pf_params, F&& resample_mutate_propagate)
+{
+    constexpr int64_t REPEATS = 20;
+    const State robot{30.0, 40.0};
+    ParticleFilter pf{pf_params, &likelihoodFunction, &moveEstimatedState};
+
+    double total_ms = 0.0;
+    for (int64_t i = 0; i < REPEATS; ++i)
+    {
+        pf.updateWeights(sensorFunction(robot), 5.0); // Not timed
+        const auto start = std::chrono::steady_clock::now();
+        resample_mutate_propagate(pf);
+        const auto stop = std::chrono::steady_clock::now();
+        total_ms += std::chrono::duration<double, std::milli>(stop - start).count();
+    }
+    return total_ms / static_cast<double>(REPEATS);
+}
+
+int main()
+{
+    PF_Params pf_params;
+    pf_params.num_of_particles = 1000000;
+    const State waypoint{50.0, 50.0};
+
+    std::cout << pf_params.num_of_particles << " particles\n";
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << std::setw(18) << "thread mode" << std::setw(20) << "separate (ms)" << std::setw(20) << "fused (ms)" << "\n";
+    for (const PF_THREAD_MODE thread_mode : {PF_THREAD_MODE::SINGLE_THREADED, PF_THREAD_MODE::MULTI_THREADED})
+    {
+        pf_params.thread_mode = thread_mode;
+        const double separate_ms = timeStepsMs(pf_params, [&](auto& pf)
+        {
+            pf.resample();
+            pf.mutateParticles(pf_params.particle_propogation_std);
+            pf.propogateState(waypoint);
+        });
+        const double fused_ms = timeStepsMs(pf_params, [&](auto& pf)
+        {
+            pf.resampleMutatePropagate(pf_params.particle_propogation_std, waypoint);
+        });
+        const std::string name = thread_mode == PF_THREAD_MODE::SINGLE_THREADED ? "single threaded" : "multithreaded";
+        std::cout << std::setw(18) << name << std::setw(20) << separate_ms << std::setw(20) << fused_ms << "\n";
+    }
+
+    return 0;
+}
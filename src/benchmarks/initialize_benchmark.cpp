@@ -0,0 +1,124 @@
+// Custom Non‑Commercial License
+
+// Copyright (c) 2025 Mgoodell97
+
+// Permission is hereby granted, free of charge, to any individual or
+// non‑commercial entity obtaining a copy of this software and associated
+// documentation files (the "Software"), to use, copy, modify, merge, publish,
+// and distribute the Software for personal, educational, or research purposes,
+// subject to the following conditions:
+
+// 1. Commercial Use:
+//    Any company, corporation, or organization intending to use the Software
+//    must first notify the copyright holder and obtain explicit written
+//    permission. Commercial use without such permission is strictly prohibited.
+
+// 2. Unauthorized Commercial Use:
+//    If a company is found to be using the Software without prior authorization,
+//    the copyright holder is entitled to receive 1% of the company’s gross
+//    profits moving forward, enforceable as a licensing fee.
+
+// 3. Artificial Intelligence / Machine Learning Use:
+//    If the Software is incorporated into machine learning
+//    models, neural networks, generative pre‑trained transformers (GPTs), or similar AI systems,
+//    the company deploying such use is solely responsible for compliance with
+//    this license. Responsibility cannot be shifted to the provider of training
+//    data or third‑party services.
+
+// 4. Attribution:
+//    The above copyright notice and this permission notice shall be included in
+//    all copies or substantial portions of the Software.
+
+// Disclaimer:
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Time from constructing a ParticleFilter to having an initialized cloud, the first step (which pays for any buffer
+// the constructor left untouched) and the steady state step time after it, with and without pin_threads. Construction allocates the particle buffers, first touches them from the pool and
+// draws the initial particles in parallel, so on a NUMA machine each worker's pages land on its own node.
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <string>
+
+#include "particle_filter.hpp"
+
+struct StartupResult
+{
+    double construct_ms{0.0};
+    double first_step_ms{0.0};
+    double step_ms{0.0};
+};
+
+StartupResult runBenchmark(PF_Params pf_params, const PF_THREAD_MODE thread_mode, const bool pin_threads)
+{
+    constexpr int64_t REPEATS = 5;
+    constexpr int64_t STEPS = 10;
+    const State robot{30.0, 40.0};
+    const State waypoint{50.0, 50.0};
+    pf_params.thread_mode = thread_mode;
+    pf_params.pin_threads = pin_threads;
+
+    StartupResult result;
+    for (int64_t repeat = 0; repeat < REPEATS; ++repeat)
+    {
+        const auto construct_start = std::chrono::steady_clock::now();
+        ParticleFilter pf{pf_params, &likelihoodFunction, &moveEstimatedState};
+        const auto construct_stop = std::chrono::steady_clock::now();
+        result.construct_ms += std::chrono::duration<double, std::milli>(construct_stop - construct_start).count();
+
+        for (int64_t step = 0; step <= STEPS; ++step)
+        {
+            const auto step_start = std::chrono::steady_clock::now();
+            pf.updateWeights(sensorFunction(robot), 5.0);
+            pf.resampleMutatePropagate(pf_params.particle_propogation_std, waypoint);
+            const auto step_stop = std::chrono::steady_clock::now();
+            const double step_ms = std::chrono::duration<double, std::milli>(step_stop - step_start).count();
+            if (step == 0)
+            {
+                result.first_step_ms += step_ms;
+            }
+            else
+            {
+                result.step_ms += step_ms / STEPS;
+            }
+        }
+    }
+
+    result.construct_ms /= REPEATS;
+    result.first_step_ms /= REPEATS;
+    result.step_ms /= REPEATS;
+    return result;
+}
+
+int main()
+{
+    PF_Params pf_params;
+    pf_params.num_of_particles = 1000000;
+
+    std::cout << pf_params.num_of_particles << " particles\n";
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << std::setw(26) << "configuration" << std::setw(20) << "construct (ms)" << std::setw(20) << "first step (ms)" << std::setw(16) << "step (ms)" << "\n";
+    for (const PF_THREAD_MODE thread_mode : {PF_THREAD_MODE::SINGLE_THREADED, PF_THREAD_MODE::MULTI_THREADED})
+    {
+        for (const bool pin_threads : {false, true})
+        {
+            if (thread_mode == PF_THREAD_MODE::SINGLE_THREADED && pin_threads)
+            {
+                continue; // No pool to pin
+            }
+            const StartupResult result = runBenchmark(pf_params, thread_mode, pin_threads);
+            std::string name = thread_mode == PF_THREAD_MODE::SINGLE_THREADED ? "single threaded" : "multithreaded";
+            name += pin_threads ? " pinned" : "";
+            std::cout << std::setw(26) << name << std::setw(20) << result.construct_ms << std::setw(20) << result.first_step_ms << std::setw(16) << result.step_ms << "\n";
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,128 @@
+// Custom Non‑Commercial License
+
+// Copyright (c) 2025 Mgoodell97
+
+// Permission is hereby granted, free of charge, to any individual or
+// non‑commercial entity obtaining a copy of this software and associated
+// documentation files (the "Software"), to use, copy, modify, merge, publish,
+// and distribute the Software for personal, educational, or research purposes,
+// subject to the following conditions:
+
+// 1. Commercial Use:
+//    Any company, corporation, or organization intending to use the Software
+//    must first notify the copyright holder and obtain explicit written
+//    permission. Commercial use without such permission is strictly prohibited.
+
+// 2. Unauthorized Commercial Use:
+//    If a company is found to be using the Software without prior authorization,
+//    the copyright holder is entitled to receive 1% of the company’s gross
+//    profits moving forward, enforceable as a licensing fee.
+
+// 3. Artificial Intelligence / Machine Learning Use:
+//    If the Software is incorporated into machine learning
+//    models, neural networks, generative pre‑trained transformers (GPTs), or similar AI systems,
+//    the company deploying such use is solely responsible for compliance with
+//    this license. Responsibility cannot be shifted to the provider of training
+//    data or third‑party services.
+
+// 4. Attribution:
+//    The above copyright notice and this permission notice shall be included in
+//    all copies or substantial portions of the Software.
+
+// Disclaimer:
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Compares updateWeights and propogateState for the same maths reached three ways: through the type erased
+// std::function adapter, through a compile time model the compiler can inline, and through DefaultModel's SIMD hooks.
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cmath>
+#include <string>
+
+#include "particle_filter_impl.hpp"
+
+template<typename F>
+double timeMs(F&& f, const int64_t repeats)
+{
+    const auto start = std::chrono::steady_clock::now();
+    for (int64_t i = 0; i < repeats; ++i)
+    {
+        f();
+    }
+    const auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(stop - start).count() / static_cast<double>(repeats);
+}
+
+// The stock maths written where the compiler can see it
+struct InlineRangeModel
+{
+    double sensor(const State& state) const
+    {
+        return std::sqrt(state.x * state.x + state.y * state.y);
+    }
+
+    double likelihood(const double sensor_observation, const double estimate_observation, const double sensor_std) const
+    {
+        const double diff_over_sig = (sensor_observation - estimate_observation) / sensor_std;
+        return std::exp(-0.5 * diff_over_sig * diff_over_sig);
+    }
+
+    void propagate(State& state, const State& waypoint) const
+    {
+        const double dx = waypoint.x - state.x;
+        const double dy = waypoint.y - state.y;
+        const double dist = std::sqrt(dx * dx + dy * dy);
+        const double full_step_x = state.x + (dx / dist) * MAX_STEP_SIZE;
+        const double full_step_y = state.y + (dy / dist) * MAX_STEP_SIZE;
+        const bool take_full_step = dist >= MAX_STEP_SIZE;
+        state.x = take_full_step ? full_step_x : waypoint.x;
+        state.y = take_full_step ? full_step_y : waypoint.y;
+    }
+};
+
+template<typename Filter>
+void runBenchmark(const std::string& name, Filter& pf, double& checksum)
+{
+    constexpr int64_t REPEATS = 20;
+    const State robot{30.0, 40.0};
+    const State waypoint{50.0, 50.0};
+
+    const double update_ms = timeMs([&]() { pf.updateWeights(sensorFunction(robot), 5.0); }, REPEATS);
+    const double propogate_ms = timeMs([&]() { pf.propogateState(waypoint); }, REPEATS);
+    checksum += pf.getXHat().x;
+
+    std::cout << std::setw(22) << name << std::setw(20) << update_ms << std::setw(20) << propogate_ms << "\n";
+}
+
+int main()
+{
+    PF_Params pf_params;
+    pf_params.num_of_particles = 1000000;
+    pf_params.thread_mode = PF_THREAD_MODE::SINGLE_THREADED; // Per particle cost, not scaling
+
+    // Lambdas hide the stock functions from FunctionModel so it takes the per particle std::function path
+    ParticleFilter function_pf{pf_params,
+                               [](const double obs, const double est, const double std) { return likelihoodFunction(obs, est, std); },
+                               [](State& state, const State& waypoint) { moveEstimatedState(state, waypoint); }};
+    ParticleFilter<InlineRangeModel> inline_pf{pf_params};
+    ParticleFilter<DefaultModel> default_pf{pf_params};
+
+    double checksum = 0.0;
+    std::cout << pf_params.num_of_particles << " particles, single threaded\n";
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << std::setw(22) << "model" << std::setw(20) << "updateWeights (ms)" << std::setw(20) << "propogateState (ms)" << "\n";
+    runBenchmark("std::function", function_pf, checksum);
+    runBenchmark("compile time model", inline_pf, checksum);
+    runBenchmark("DefaultModel (SIMD)", default_pf, checksum);
+    std::cout << "(checksum " << checksum << ")\n";
+
+    return 0;
+}
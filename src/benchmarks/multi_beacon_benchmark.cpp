@@ -0,0 +1,113 @@
+// Custom Non‑Commercial License
+
+// Copyright (c) 2025 Mgoodell97
+
+// Permission is hereby granted, free of charge, to any individual or
+// non‑commercial entity obtaining a copy of this software and associated
+// documentation files (the "Software"), to use, copy, modify, merge, publish,
+// and distribute the Software for personal, educational, or research purposes,
+// subject to the following conditions:
+
+// 1. Commercial Use:
+//    Any company, corporation, or organization intending to use the Software
+//    must first notify the copyright holder and obtain explicit written
+//    permission. Commercial use without such permission is strictly prohibited.
+
+// 2. Unauthorized Commercial Use:
+//    If a company is found to be using the Software without prior authorization,
+//    the copyright holder is entitled to receive 1% of the company’s gross
+//    profits moving forward, enforceable as a licensing fee.
+
+// 3. Artificial Intelligence / Machine Learning Use:
+//    If the Software is incorporated into machine learning
+//    models, neural networks, generative pre‑trained transformers (GPTs), or similar AI systems,
+//    the company deploying such use is solely responsible for compliance with
+//    this license. Responsibility cannot be shifted to the provider of training
+//    data or third‑party services.
+
+// 4. Attribution:
+//    The above copyright notice and this permission notice shall be included in
+//    all copies or substantial portions of the Software.
+
+// Disclaimer:
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Cost of folding B beacon readings into the weights at a million particles: one joint updateWeights call over all
+// B readings against B single reading calls, each of which renormalizes and walks the particle arrays again.
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <span>
+#include <vector>
+
+#include "particle_filter.hpp"
+
+double timeUpdates(PF_Params pf_params, const std::vector<BeaconReading>& readings, const bool joint)
+{
+    constexpr int64_t STEPS = 20;
+    ParticleFilter pf{pf_params, &likelihoodFunction, &moveEstimatedState};
+
+    // One untimed step so page faults and cold caches land outside the timing
+    pf.updateWeights(readings);
+    pf.resample();
+
+    const auto start = std::chrono::steady_clock::now();
+    for (int64_t step = 0; step < STEPS; ++step)
+    {
+        if (joint)
+        {
+            pf.updateWeights(readings);
+        }
+        else
+        {
+            for (const BeaconReading& reading : readings)
+            {
+                pf.updateWeights(std::span<const BeaconReading>(&reading, 1));
+            }
+        }
+        // Start each step from flat weights so neither path drifts into underflow
+        pf.resample();
+    }
+    const auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::micro>(stop - start).count() / STEPS;
+}
+
+int main()
+{
+    const State robot{30.0, 40.0};
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << std::setw(10) << "beacons" << std::setw(8) << "log" << std::setw(16) << "joint (us)" << std::setw(20) << "one by one (us)" << std::setw(10) << "speedup" << "\n";
+
+    for (const bool log_domain : {false, true})
+    {
+        for (const int64_t num_beacons : {1, 2, 4, 8})
+        {
+            PF_Params pf_params;
+            pf_params.num_of_particles = 1000000;
+            pf_params.thread_mode = PF_THREAD_MODE::SINGLE_THREADED;
+            pf_params.log_domain_weights = log_domain;
+
+            std::vector<BeaconReading> readings;
+            for (int64_t beacon_index = 0; beacon_index < num_beacons; ++beacon_index)
+            {
+                const State beacon{25.0 * static_cast<double>(beacon_index % 4), 100.0 * static_cast<double>(beacon_index / 4)};
+                const State relative{robot.x - beacon.x, robot.y - beacon.y};
+                readings.push_back(BeaconReading{beacon, sensorFunction(relative), 20.0});
+            }
+
+            const double joint_us = timeUpdates(pf_params, readings, true);
+            const double one_by_one_us = timeUpdates(pf_params, readings, false);
+            std::cout << std::setw(10) << num_beacons << std::setw(8) << (log_domain ? "yes" : "no") << std::setw(16) << joint_us
+                      << std::setw(20) << one_by_one_us << std::setw(10) << one_by_one_us / joint_us << "\n";
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,146 @@
+// Custom Non‑Commercial License
+
+// Copyright (c) 2025 Mgoodell97
+
+// Permission is hereby granted, free of charge, to any individual or
+// non‑commercial entity obtaining a copy of this software and associated
+// documentation files (the "Software"), to use, copy, modify, merge, publish,
+// and distribute the Software for personal, educational, or research purposes,
+// subject to the following conditions:
+
+// 1. Commercial Use:
+//    Any company, corporation, or organization intending to use the Software
+//    must first notify the copyright holder and obtain explicit written
+//    permission. Commercial use without such permission is strictly prohibited.
+
+// 2. Unauthorized Commercial Use:
+//    If a company is found to be using the Software without prior authorization,
+//    the copyright holder is entitled to receive 1% of the company’s gross
+//    profits moving forward, enforceable as a licensing fee.
+
+// 3. Artificial Intelligence / Machine Learning Use:
+//    If the Software is incorporated into machine learning
+//    models, neural networks, generative pre‑trained transformers (GPTs), or similar AI systems,
+//    the company deploying such use is solely responsible for compliance with
+//    this license. Responsibility cannot be shifted to the provider of training
+//    data or third‑party services.
+
+// 4. Attribution:
+//    The above copyright notice and this permission notice shall be included in
+//    all copies or substantial portions of the Software.
+
+// Disclaimer:
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Nanoseconds per standard normal for libstdc++'s std::normal_distribution against the counter based
+// Philox + Box-Muller sampler mutateParticles uses, at each SIMD level this CPU supports.
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "philox.hpp"
+#include "simd_kernels.hpp"
+
+constexpr int64_t NUM_PAIRS = 4000000;
+constexpr int64_t BLOCK_SIZE = 256; // Same block size as ParticleFilter::mutateChunk
+
+template<typename F>
+void report(const std::string& name, F&& fill, std::vector<double>& xs, std::vector<double>& ys)
+{
+    constexpr int64_t REPEATS = 5;
+    const auto start = std::chrono::steady_clock::now();
+    for (int64_t repeat = 0; repeat < REPEATS; ++repeat)
+    {
+        fill(static_cast<uint64_t>(repeat));
+    }
+    const auto stop = std::chrono::steady_clock::now();
+    const double ns_per_normal = std::chrono::duration<double, std::nano>(stop - start).count() / static_cast<double>(REPEATS * 2 * NUM_PAIRS);
+
+    std::cout << std::setw(34) << name << std::setw(12) << ns_per_normal << "   (checksum " << xs[NUM_PAIRS / 2] + ys[NUM_PAIRS / 3] << ")\n";
+}
+
+int main()
+{
+    std::vector<double> xs(NUM_PAIRS, 0.0);
+    std::vector<double> ys(NUM_PAIRS, 0.0);
+    const CounterRng rng(42);
+
+    std::cout << 2 * NUM_PAIRS << " normals\n";
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << std::setw(34) << "sampler" << std::setw(12) << "ns/normal" << "\n";
+
+    report("mt19937_64 + normal_distribution", [&](const uint64_t step)
+    {
+        std::mt19937_64 eng(step);
+        std::normal_distribution<double> dist(0.0, 1.0);
+        for (int64_t i = 0; i < NUM_PAIRS; ++i)
+        {
+            xs[i] += dist(eng);
+            ys[i] += dist(eng);
+        }
+    }, xs, ys);
+
+    report("Philox + scalar Box-Muller", [&](const uint64_t step)
+    {
+        for (int64_t i = 0; i < NUM_PAIRS; ++i)
+        {
+            const auto [noise_x, noise_y] = rng.normal2(RNG_STREAM_MUTATE, step, i);
+            xs[i] += noise_x;
+            ys[i] += noise_y;
+        }
+    }, xs, ys);
+
+    report("Philox uniforms only", [&](const uint64_t step)
+    {
+        double u_radius[BLOCK_SIZE];
+        double u_angle[BLOCK_SIZE];
+        for (int64_t block_start = 0; block_start < NUM_PAIRS; block_start += BLOCK_SIZE)
+        {
+            rng.uniformBlock(RNG_STREAM_MUTATE, step, block_start, BLOCK_SIZE, u_radius, u_angle);
+            for (int64_t j = 0; j < BLOCK_SIZE; ++j)
+            {
+                xs[block_start + j] += u_radius[j];
+                ys[block_start + j] += u_angle[j];
+            }
+        }
+    }, xs, ys);
+
+    for (const SIMD_LEVEL level : {SIMD_SCALAR, SIMD_SSE2, SIMD_AVX2, SIMD_AVX512})
+    {
+        if (level > detectSimdLevel())
+        {
+            break;
+        }
+        const SimdKernels& kernels = getSimdKernels(level);
+
+        report(std::string("Philox + batched Box-Muller ") + kernels.name, [&](const uint64_t step)
+        {
+            double u_radius[BLOCK_SIZE];
+            double u_angle[BLOCK_SIZE];
+            double noise_x[BLOCK_SIZE];
+            double noise_y[BLOCK_SIZE];
+            for (int64_t block_start = 0; block_start < NUM_PAIRS; block_start += BLOCK_SIZE)
+            {
+                rng.uniformBlock(RNG_STREAM_MUTATE, step, block_start, BLOCK_SIZE, u_radius, u_angle);
+                kernels.box_muller(u_radius, u_angle, noise_x, noise_y, BLOCK_SIZE);
+                for (int64_t j = 0; j < BLOCK_SIZE; ++j)
+                {
+                    xs[block_start + j] += noise_x[j];
+                    ys[block_start + j] += noise_y[j];
+                }
+            }
+        }, xs, ys);
+    }
+
+    return 0;
+}
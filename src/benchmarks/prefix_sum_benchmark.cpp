@@ -0,0 +1,171 @@
+// Custom Non‑Commercial License
+
+// Copyright (c) 2025 Mgoodell97
+
+// Permission is hereby granted, free of charge, to any individual or
+// non‑commercial entity obtaining a copy of this software and associated
+// documentation files (the "Software"), to use, copy, modify, merge, publish,
+// and distribute the Software for personal, educational, or research purposes,
+// subject to the following conditions:
+
+// 1. Commercial Use:
+//    Any company, corporation, or organization intending to use the Software
+//    must first notify the copyright holder and obtain explicit written
+//    permission. Commercial use without such permission is strictly prohibited.
+
+// 2. Unauthorized Commercial Use:
+//    If a company is found to be using the Software without prior authorization,
+//    the copyright holder is entitled to receive 1% of the company’s gross
+//    profits moving forward, enforceable as a licensing fee.
+
+// 3. Artificial Intelligence / Machine Learning Use:
+//    If the Software is incorporated into machine learning
+//    models, neural networks, generative pre‑trained transformers (GPTs), or similar AI systems,
+//    the company deploying such use is solely responsible for compliance with
+//    this license. Responsibility cannot be shifted to the provider of training
+//    data or third‑party services.
+
+// 4. Attribution:
+//    The above copyright notice and this permission notice shall be included in
+//    all copies or substantial portions of the Software.
+
+// Disclaimer:
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// The old three phase parallel prefix sum (local scans, serial carry scan, add-back pass over everything) against
+// ThreadPool::parallel_scan with decoupled look-back and the SIMD prefix_sum kernel, and a plain serial scan for
+// reference. Both parallel versions use the same fixed blocks and block offsets, only the SIMD kernel rounds
+// differently inside a vector.
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <functional>
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+
+#include "simd_kernels.hpp"
+#include "thread_pool.hpp"
+
+constexpr int64_t BLOCK_SIZE = 2048;
+
+// What ParticleFilter::cumulativeSum did before, three phases with a barrier between each
+void threePhasePrefixSum(ThreadPool& pool, const std::vector<double>& input, std::vector<double>& result, std::vector<double>& block_offsets)
+{
+    const int64_t n = static_cast<int64_t>(input.size());
+    const int64_t num_blocks = (n + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    const int64_t grain = (pool.getGrainSize(n, 0) + BLOCK_SIZE - 1) / BLOCK_SIZE * BLOCK_SIZE;
+
+    pool.parallel_for(0, n, grain, [&](const int64_t start_index, const int64_t end_index)
+    {
+        for (int64_t block_start = start_index; block_start < end_index; block_start += BLOCK_SIZE)
+        {
+            const int64_t block_end = std::min(block_start + BLOCK_SIZE, end_index);
+            double block_sum = 0.0;
+            for (int64_t i = block_start; i < block_end; ++i)
+            {
+                block_sum += input[i];
+                result[i] = block_sum;
+            }
+        }
+    });
+
+    block_offsets.resize(num_blocks);
+    double block_offset = 0.0;
+    for (int64_t block = 0; block < num_blocks; ++block)
+    {
+        block_offsets[block] = block_offset;
+        block_offset += result[std::min((block + 1) * BLOCK_SIZE, n) - 1];
+    }
+
+    pool.parallel_for(BLOCK_SIZE, n, grain, [&](const int64_t start_index, const int64_t end_index)
+    {
+        for (int64_t i = start_index; i < end_index; ++i)
+        {
+            result[i] += block_offsets[i / BLOCK_SIZE];
+        }
+    });
+}
+
+void singlePassPrefixSum(ThreadPool& pool, const SimdKernels& kernels, const std::vector<double>& input, std::vector<double>& result,
+                         ScanBlockStates<double>& states)
+{
+    auto scanBlock = [&](const int64_t start_index, const int64_t end_index)
+    {
+        return kernels.prefix_sum(input.data() + start_index, result.data() + start_index, end_index - start_index);
+    };
+    auto addOffset = [&](const int64_t start_index, const int64_t end_index, const double block_offset)
+    {
+        for (int64_t i = start_index; i < end_index; ++i)
+        {
+            result[i] += block_offset;
+        }
+    };
+    pool.parallel_scan(static_cast<int64_t>(input.size()), BLOCK_SIZE, states, scanBlock, addOffset, std::plus<double>());
+}
+
+template<typename F>
+double timeNsPerElement(const int64_t n, F&& scan)
+{
+    // Enough repeats to run for a while at every size, after one untimed warm up
+    const int64_t repeats = std::max<int64_t>(3, 200000000 / n);
+    scan();
+    const auto start = std::chrono::steady_clock::now();
+    for (int64_t i = 0; i < repeats; ++i)
+    {
+        scan();
+    }
+    const auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(stop - start).count() / static_cast<double>(repeats * n);
+}
+
+int main()
+{
+    const int64_t num_threads = static_cast<int64_t>(std::thread::hardware_concurrency());
+    ThreadPool pool{num_threads};
+    const SimdKernels& kernels = getSimdKernels();
+    ScanBlockStates<double> states;
+    std::vector<double> block_offsets;
+
+    std::cout << num_threads << " threads, " << kernels.name << " kernels, ns per element\n";
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << std::setw(12) << "elements" << std::setw(14) << "serial" << std::setw(14) << "three phase"
+              << std::setw(14) << "single pass" << std::setw(10) << "same" << "\n";
+    for (const int64_t n : {10000LL, 100000LL, 1000000LL, 10000000LL, 100000000LL})
+    {
+        std::vector<double> input(n);
+        for (int64_t i = 0; i < n; ++i)
+        {
+            input[i] = 1.0 / static_cast<double>(i % 1000 + 1);
+        }
+        std::vector<double> result(n);
+        std::vector<double> reference(n);
+
+        const double serial_ns = timeNsPerElement(n, [&]()
+        {
+            double total = 0.0;
+            for (int64_t i = 0; i < n; ++i)
+            {
+                total += input[i];
+                result[i] = total;
+            }
+        });
+        const double three_phase_ns = timeNsPerElement(n, [&]() { threePhasePrefixSum(pool, input, reference, block_offsets); });
+        const double single_pass_ns = timeNsPerElement(n, [&]() { singlePassPrefixSum(pool, kernels, input, result, states); });
+
+        // Equal when the kernel scans lanes serially (scalar), otherwise only the rounding inside a vector differs
+        const bool same = std::memcmp(result.data(), reference.data(), n * sizeof(double)) == 0;
+        std::cout << std::setw(12) << n << std::setw(14) << serial_ns << std::setw(14) << three_phase_ns
+                  << std::setw(14) << single_pass_ns << std::setw(10) << (same ? "yes" : "rounding") << "\n";
+    }
+
+    return 0;
+}
@@ -0,0 +1,134 @@
+// Custom Non‑Commercial License
+
+// Copyright (c) 2025 Mgoodell97
+
+// Permission is hereby granted, free of charge, to any individual or
+// non‑commercial entity obtaining a copy of this software and associated
+// documentation files (the "Software"), to use, copy, modify, merge, publish,
+// and distribute the Software for personal, educational, or research purposes,
+// subject to the following conditions:
+
+// 1. Commercial Use:
+//    Any company, corporation, or organization intending to use the Software
+//    must first notify the copyright holder and obtain explicit written
+//    permission. Commercial use without such permission is strictly prohibited.
+
+// 2. Unauthorized Commercial Use:
+//    If a company is found to be using the Software without prior authorization,
+//    the copyright holder is entitled to receive 1% of the company’s gross
+//    profits moving forward, enforceable as a licensing fee.
+
+// 3. Artificial Intelligence / Machine Learning Use:
+//    If the Software is incorporated into machine learning
+//    models, neural networks, generative pre‑trained transformers (GPTs), or similar AI systems,
+//    the company deploying such use is solely responsible for compliance with
+//    this license. Responsibility cannot be shifted to the provider of training
+//    data or third‑party services.
+
+// 4. Attribution:
+//    The above copyright notice and this permission notice shall be included in
+//    all copies or substantial portions of the Software.
+
+// Disclaimer:
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Time and particle diversity of every PF_RESAMPLING_SCHEME on the same weighted cloud. Diversity is the fraction
+// of particles that survive resampling, and "mean error" is how far the resampled cloud's mean lands from the
+// weighted estimate (the variance the scheme adds).
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <tuple>
+
+#include "particle_filter.hpp"
+
+struct SchemeResult
+{
+    double resample_ms{0.0};
+    double surviving_fraction{0.0};
+    double mean_error{0.0};
+};
+
+SchemeResult runBenchmark(PF_Params pf_params, const PF_RESAMPLING_SCHEME scheme, const bool streaming_resample)
+{
+    constexpr int64_t REPEATS = 10;
+    const State robot{30.0, 40.0};
+    pf_params.resampling_scheme = scheme;
+    pf_params.streaming_resample = streaming_resample;
+    ParticleFilter pf{pf_params, &likelihoodFunction, &moveEstimatedState};
+
+    SchemeResult result;
+    std::vector<double> xs(pf_params.num_of_particles);
+    for (int64_t repeat = 0; repeat < REPEATS; ++repeat)
+    {
+        // Same starting cloud and weights every repeat, only the resampling draws change
+        pf.initialize();
+        pf.updateWeights(sensorFunction(robot), 5.0);
+        const State weighted_estimate = pf.getXHat();
+
+        const auto start = std::chrono::steady_clock::now();
+        pf.resample();
+        const auto stop = std::chrono::steady_clock::now();
+        result.resample_ms += std::chrono::duration<double, std::milli>(stop - start).count();
+
+        // Every starting particle has a distinct x, so distinct x values are distinct ancestors
+        std::copy(pf.getParticles().xs(), pf.getParticles().xs() + pf_params.num_of_particles, xs.begin());
+        std::sort(xs.begin(), xs.end());
+        const int64_t num_unique = std::unique(xs.begin(), xs.end()) - xs.begin();
+        result.surviving_fraction += static_cast<double>(num_unique) / static_cast<double>(pf_params.num_of_particles);
+
+        const State resampled_estimate = pf.getXHat();
+        result.mean_error += std::hypot(resampled_estimate.x - weighted_estimate.x, resampled_estimate.y - weighted_estimate.y);
+    }
+
+    result.resample_ms /= REPEATS;
+    result.surviving_fraction /= REPEATS;
+    result.mean_error /= REPEATS;
+    return result;
+}
+
+int main()
+{
+    PF_Params pf_params;
+    pf_params.num_of_particles = 1000000;
+
+    // Streaming systematic and stratified pick the same particles without the prefix sum buffer
+    const std::vector<std::tuple<std::string, PF_RESAMPLING_SCHEME, bool>> schemes{
+        {"systematic", PF_RESAMPLING_SCHEME::SYSTEMATIC, false},
+        {"systematic streaming", PF_RESAMPLING_SCHEME::SYSTEMATIC, true},
+        {"stratified", PF_RESAMPLING_SCHEME::STRATIFIED, false},
+        {"stratified streaming", PF_RESAMPLING_SCHEME::STRATIFIED, true},
+        {"residual", PF_RESAMPLING_SCHEME::RESIDUAL, false},
+        {"multinomial (alias)", PF_RESAMPLING_SCHEME::MULTINOMIAL, false},
+        {"metropolis", PF_RESAMPLING_SCHEME::METROPOLIS, false},
+        {"rejection", PF_RESAMPLING_SCHEME::REJECTION, false}
+    };
+
+    std::cout << pf_params.num_of_particles << " particles, metropolis_iterations " << pf_params.metropolis_iterations << "\n";
+    std::cout << std::fixed << std::setprecision(4);
+    for (const PF_THREAD_MODE thread_mode : {PF_THREAD_MODE::SINGLE_THREADED, PF_THREAD_MODE::MULTI_THREADED})
+    {
+        pf_params.thread_mode = thread_mode;
+        std::cout << (thread_mode == PF_THREAD_MODE::SINGLE_THREADED ? "single threaded\n" : "multithreaded\n");
+        std::cout << std::setw(22) << "scheme" << std::setw(16) << "resample (ms)" << std::setw(16) << "surviving" << std::setw(16) << "mean error" << "\n";
+        for (const auto& [name, scheme, streaming_resample] : schemes)
+        {
+            const SchemeResult result = runBenchmark(pf_params, scheme, streaming_resample);
+            std::cout << std::setw(22) << name << std::setw(16) << result.resample_ms << std::setw(16) << result.surviving_fraction
+                      << std::setw(16) << result.mean_error << "\n";
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,124 @@
+// Custom Non‑Commercial License
+
+// Copyright (c) 2025 Mgoodell97
+
+// Permission is hereby granted, free of charge, to any individual or
+// non‑commercial entity obtaining a copy of this software and associated
+// documentation files (the "Software"), to use, copy, modify, merge, publish,
+// and distribute the Software for personal, educational, or research purposes,
+// subject to the following conditions:
+
+// 1. Commercial Use:
+//    Any company, corporation, or organization intending to use the Software
+//    must first notify the copyright holder and obtain explicit written
+//    permission. Commercial use without such permission is strictly prohibited.
+
+// 2. Unauthorized Commercial Use:
+//    If a company is found to be using the Software without prior authorization,
+//    the copyright holder is entitled to receive 1% of the company’s gross
+//    profits moving forward, enforceable as a licensing fee.
+
+// 3. Artificial Intelligence / Machine Learning Use:
+//    If the Software is incorporated into machine learning
+//    models, neural networks, generative pre‑trained transformers (GPTs), or similar AI systems,
+//    the company deploying such use is solely responsible for compliance with
+//    this license. Responsibility cannot be shifted to the provider of training
+//    data or third‑party services.
+
+// 4. Attribution:
+//    The above copyright notice and this permission notice shall be included in
+//    all copies or substantial portions of the Software.
+
+// Disclaimer:
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Times the sensor and likelihood kernels at each SIMD level this CPU supports against the per particle
+// std::function path the filter uses for custom likelihoods.
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <functional>
+#include <vector>
+#include <random>
+
+#include "particle_storage.hpp"
+#include "simd_kernels.hpp"
+#include "state_functions.hpp"
+
+template<typename F>
+double timeMs(F&& f, const int64_t repeats)
+{
+    const auto start = std::chrono::steady_clock::now();
+    for (int64_t i = 0; i < repeats; ++i)
+    {
+        f();
+    }
+    const auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(stop - start).count() / static_cast<double>(repeats);
+}
+
+int main()
+{
+    constexpr int64_t NUM_PARTICLES = 1000000;
+    constexpr int64_t REPEATS = 20;
+    const double observation = 50.0;
+    const double sensor_std = 2.5;
+
+    std::mt19937_64 eng(42);
+    std::uniform_real_distribution<double> dist(X_MIN, X_MAX);
+    ParticleStorage particles(NUM_PARTICLES);
+    for (int64_t i = 0; i < NUM_PARTICLES; ++i)
+    {
+        particles.set(i, State{dist(eng), dist(eng)});
+    }
+    std::vector<double> observations(NUM_PARTICLES);
+    std::vector<double> weights(NUM_PARTICLES);
+    double checksum = 0.0;
+
+    std::cout << NUM_PARTICLES << " particles, detected " << getSimdKernels().name << "\n";
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << std::setw(12) << "level" << std::setw(14) << "sensor (ms)" << std::setw(18) << "likelihood (ms)" << "\n";
+
+    // What updateWeights does for a likelihood it can't see into
+    const std::function<double(const double, const double, const double)> likelihood = likelihoodFunction;
+    const double function_ms = timeMs([&]()
+    {
+        for (int64_t i = 0; i < NUM_PARTICLES; ++i)
+        {
+            weights[i] = likelihood(observation, observations[i], sensor_std);
+            checksum += weights[i];
+        }
+    }, REPEATS);
+    std::cout << std::setw(12) << "std::function" << std::setw(14) << "-" << std::setw(18) << function_ms << "\n";
+
+    for (const SIMD_LEVEL level : {SIMD_SCALAR, SIMD_SSE2, SIMD_AVX2, SIMD_AVX512})
+    {
+        if (level > detectSimdLevel())
+        {
+            break;
+        }
+        const SimdKernels& kernels = getSimdKernels(level);
+
+        const double sensor_ms = timeMs([&]()
+        {
+            kernels.range_sensor(particles.xs(), particles.ys(), observations.data(), NUM_PARTICLES);
+            checksum += observations[NUM_PARTICLES / 2];
+        }, REPEATS);
+        const double likelihood_ms = timeMs([&]()
+        {
+            checksum += kernels.gaussian_likelihood(observations.data(), weights.data(), NUM_PARTICLES, observation, sensor_std);
+        }, REPEATS);
+
+        std::cout << std::setw(12) << kernels.name << std::setw(14) << sensor_ms << std::setw(18) << likelihood_ms << "\n";
+    }
+    std::cout << "(checksum " << checksum << ")\n";
+
+    return 0;
+}
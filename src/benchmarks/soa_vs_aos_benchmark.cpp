@@ -0,0 +1,180 @@
+// Custom Non‑Commercial License
+
+// Copyright (c) 2025 Mgoodell97
+
+// Permission is hereby granted, free of charge, to any individual or
+// non‑commercial entity obtaining a copy of this software and associated
+// documentation files (the "Software"), to use, copy, modify, merge, publish,
+// and distribute the Software for personal, educational, or research purposes,
+// subject to the following conditions:
+
+// 1. Commercial Use:
+//    Any company, corporation, or organization intending to use the Software
+//    must first notify the copyright holder and obtain explicit written
+//    permission. Commercial use without such permission is strictly prohibited.
+
+// 2. Unauthorized Commercial Use:
+//    If a company is found to be using the Software without prior authorization,
+//    the copyright holder is entitled to receive 1% of the company’s gross
+//    profits moving forward, enforceable as a licensing fee.
+
+// 3. Artificial Intelligence / Machine Learning Use:
+//    If the Software is incorporated into machine learning
+//    models, neural networks, generative pre‑trained transformers (GPTs), or similar AI systems,
+//    the company deploying such use is solely responsible for compliance with
+//    this license. Responsibility cannot be shifted to the provider of training
+//    data or third‑party services.
+
+// 4. Attribution:
+//    The above copyright notice and this permission notice shall be included in
+//    all copies or substantial portions of the Software.
+
+// Disclaimer:
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Compares the old array of structs particle layout against the structure of arrays ParticleStorage
+// on the per particle kernels the filter runs every step (sensor, motion model, mutation, estimate).
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <vector>
+#include <random>
+
+#include "particle_storage.hpp"
+#include "state_functions.hpp"
+
+template<typename F>
+double timeMs(F&& f, const int64_t repeats)
+{
+    const auto start = std::chrono::steady_clock::now();
+    for (int64_t i = 0; i < repeats; ++i)
+    {
+        f();
+    }
+    const auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(stop - start).count() / static_cast<double>(repeats);
+}
+
+void runBenchmark(const int64_t num_particles)
+{
+    constexpr int64_t REPEATS = 10;
+    const State waypoint{50.0, 50.0};
+
+    std::mt19937_64 eng(42);
+    std::uniform_real_distribution<double> dist(X_MIN, X_MAX);
+
+    std::vector<State> aos(num_particles);
+    ParticleStorage soa(num_particles);
+    for (int64_t i = 0; i < num_particles; ++i)
+    {
+        aos[i] = State{dist(eng), dist(eng)};
+        soa.set(i, aos[i]);
+    }
+    std::vector<double> observations(num_particles);
+    std::vector<double> weights(num_particles, 1.0 / static_cast<double>(num_particles));
+
+    // Noise is pregenerated so we time the memory layout and not the random number generator
+    std::vector<double> noise(num_particles);
+    std::normal_distribution<double> noise_dist(0.0, 0.1);
+    for (double& value : noise)
+    {
+        value = noise_dist(eng);
+    }
+
+    const double aos_sensor = timeMs([&]()
+    {
+        for (int64_t i = 0; i < num_particles; ++i)
+        {
+            observations[i] = sensorFunction(aos[i]);
+        }
+    }, REPEATS);
+    const double soa_sensor = timeMs([&]()
+    {
+        sensorFunctionBatch(soa.xs(), soa.ys(), observations.data(), num_particles);
+    }, REPEATS);
+
+    const double aos_motion = timeMs([&]()
+    {
+        for (int64_t i = 0; i < num_particles; ++i)
+        {
+            moveEstimatedState(aos[i], waypoint);
+        }
+    }, REPEATS);
+    const double soa_motion = timeMs([&]()
+    {
+        moveEstimatedStateBatch(soa.xs(), soa.ys(), num_particles, waypoint);
+    }, REPEATS);
+
+    const double aos_mutate = timeMs([&]()
+    {
+        for (int64_t i = 0; i < num_particles; ++i)
+        {
+            aos[i].x += noise[i];
+            aos[i].y += noise[i];
+        }
+    }, REPEATS);
+    const double soa_mutate = timeMs([&]()
+    {
+        double* xs = soa.xs();
+        double* ys = soa.ys();
+        for (int64_t i = 0; i < num_particles; ++i)
+        {
+            xs[i] += noise[i];
+            ys[i] += noise[i];
+        }
+    }, REPEATS);
+
+    // Every repeat adds into the checksum so the optimizer can't drop any of the loops
+    double checksum = 0.0;
+    const double aos_estimate = timeMs([&]()
+    {
+        State estimate{0.0, 0.0};
+        for (int64_t i = 0; i < num_particles; ++i)
+        {
+            estimate.x += aos[i].x * weights[i];
+            estimate.y += aos[i].y * weights[i];
+        }
+        checksum += estimate.x + estimate.y;
+    }, REPEATS);
+    const double soa_estimate = timeMs([&]()
+    {
+        State estimate{0.0, 0.0};
+        const double* xs = soa.xs();
+        const double* ys = soa.ys();
+        for (int64_t i = 0; i < num_particles; ++i)
+        {
+            estimate.x += xs[i] * weights[i];
+            estimate.y += ys[i] * weights[i];
+        }
+        checksum += estimate.x + estimate.y;
+    }, REPEATS);
+
+    std::cout << num_particles << " particles\n";
+    std::cout << "    kernel      AoS (ms)    SoA (ms)    speedup\n";
+    auto printRow = [](const char* name, const double aos_ms, const double soa_ms)
+    {
+        std::cout << "    " << std::left << std::setw(10) << name << std::right
+                  << std::setw(10) << aos_ms << "  " << std::setw(10) << soa_ms << "  " << std::setw(8) << aos_ms / soa_ms << "x\n";
+    };
+    printRow("sensor", aos_sensor, soa_sensor);
+    printRow("motion", aos_motion, soa_motion);
+    printRow("mutate", aos_mutate, soa_mutate);
+    printRow("estimate", aos_estimate, soa_estimate);
+    std::cout << "    (checksum " << checksum + observations[num_particles / 2] << ")\n";
+}
+
+int main()
+{
+    std::cout << std::fixed << std::setprecision(3);
+    for (const int64_t num_particles : {1000000, 10000000})
+    {
+        runBenchmark(num_particles);
+    }
+}
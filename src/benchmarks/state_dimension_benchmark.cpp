@@ -0,0 +1,133 @@
+// Custom Non‑Commercial License
+
+// Copyright (c) 2025 Mgoodell97
+
+// Permission is hereby granted, free of charge, to any individual or
+// non‑commercial entity obtaining a copy of this software and associated
+// documentation files (the "Software"), to use, copy, modify, merge, publish,
+// and distribute the Software for personal, educational, or research purposes,
+// subject to the following conditions:
+
+// 1. Commercial Use:
+//    Any company, corporation, or organization intending to use the Software
+//    must first notify the copyright holder and obtain explicit written
+//    permission. Commercial use without such permission is strictly prohibited.
+
+// 2. Unauthorized Commercial Use:
+//    If a company is found to be using the Software without prior authorization,
+//    the copyright holder is entitled to receive 1% of the company’s gross
+//    profits moving forward, enforceable as a licensing fee.
+
+// 3. Artificial Intelligence / Machine Learning Use:
+//    If the Software is incorporated into machine learning
+//    models, neural networks, generative pre‑trained transformers (GPTs), or similar AI systems,
+//    the company deploying such use is solely responsible for compliance with
+//    this license. Responsibility cannot be shifted to the provider of training
+//    data or third‑party services.
+
+// 4. Attribution:
+//    The above copyright notice and this permission notice shall be included in
+//    all copies or substantial portions of the Software.
+
+// Disclaimer:
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Time per stage for states of 2 to 8 components at a million particles, single threaded. The model is a range sensor
+// on the first two components and a fixed displacement for the motion, so the extra components only cost storage,
+// initialization, noise, gather and the estimate, which is where the per component loops are.
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <vector>
+
+#include "particle_filter_impl.hpp"
+
+template<int64_t D>
+struct RangeModelN
+{
+    using StateType = StateN<D>;
+
+    double sensor(const StateType& state) const { return std::sqrt(state[0] * state[0] + state[1] * state[1]); }
+
+    double likelihood(const double sensor_observation, const double estimate_observation, const double sensor_std) const
+    {
+        return likelihoodFunction(sensor_observation, estimate_observation, sensor_std);
+    }
+
+    void propagate(StateType& state, const StateType& waypoint) const
+    {
+        for (int64_t d = 0; d < D; ++d)
+        {
+            state[d] += waypoint[d];
+        }
+    }
+};
+
+template<typename F>
+double timeUs(F&& fn)
+{
+    constexpr int64_t REPEATS = 10;
+    fn(); // Warm up
+    const auto start = std::chrono::steady_clock::now();
+    for (int64_t repeat = 0; repeat < REPEATS; ++repeat)
+    {
+        fn();
+    }
+    const auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::micro>(stop - start).count() / REPEATS;
+}
+
+template<ParticleModel Model>
+void runBenchmark(const char* name, Model model)
+{
+    constexpr int64_t D = ModelState<Model>::DIM;
+    PF_Params pf_params;
+    pf_params.num_of_particles = 1000000;
+    pf_params.thread_mode = PF_THREAD_MODE::SINGLE_THREADED;
+    pf_params.starting_state_lower_bound.assign(D, 0.0);
+    pf_params.starting_state_upper_bound.assign(D, 100.0);
+    pf_params.particle_propogation_std.assign(D, 0.5);
+
+    ParticleFilter<Model> pf{pf_params, model};
+    ModelState<Model> waypoint;
+    for (int64_t d = 0; d < D; ++d)
+    {
+        waypoint[d] = 0.1;
+    }
+    const double observation = 50.0;
+
+    const double initialize_us = timeUs([&]() { pf.initialize(); });
+    const double weights_us = timeUs([&]() { pf.updateWeights(observation, 20.0); });
+    const double estimate_us = timeUs([&]() { static_cast<void>(pf.getXHat()); });
+    const double resample_us = timeUs([&]() { pf.updateWeights(observation, 20.0); pf.resample(); }) - weights_us;
+    const double mutate_us = timeUs([&]() { pf.mutateParticles(pf_params.particle_propogation_std); });
+    const double propagate_us = timeUs([&]() { pf.propogateState(waypoint); });
+    const double total_us = weights_us + estimate_us + resample_us + mutate_us + propagate_us;
+
+    std::cout << std::setw(18) << name << std::setw(6) << D << std::setw(14) << initialize_us << std::setw(12) << weights_us
+              << std::setw(12) << estimate_us << std::setw(12) << resample_us << std::setw(12) << mutate_us << std::setw(12) << propagate_us
+              << std::setw(12) << total_us << std::setw(16) << total_us * 1000.0 / (static_cast<double>(pf_params.num_of_particles) * D) << "\n";
+}
+
+int main()
+{
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << std::setw(18) << "model" << std::setw(6) << "D" << std::setw(14) << "init (us)" << std::setw(12) << "weights" << std::setw(12) << "estimate"
+              << std::setw(12) << "resample" << std::setw(12) << "mutate" << std::setw(12) << "propagate" << std::setw(12) << "step" << std::setw(16) << "ns/component" << "\n";
+
+    runBenchmark("DefaultModel", DefaultModel{});
+    runBenchmark("RangeModelN<2>", RangeModelN<2>{});
+    runBenchmark("RangeModelN<3>", RangeModelN<3>{});
+    runBenchmark("RangeModelN<4>", RangeModelN<4>{});
+    runBenchmark("RangeModelN<6>", RangeModelN<6>{});
+    runBenchmark("RangeModelN<8>", RangeModelN<8>{});
+
+    return 0;
+}
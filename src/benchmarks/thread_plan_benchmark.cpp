@@ -0,0 +1,115 @@
+// Custom Non‑Commercial License
+
+// Copyright (c) 2025 Mgoodell97
+
+// Permission is hereby granted, free of charge, to any individual or
+// non‑commercial entity obtaining a copy of this software and associated
+// documentation files (the "Software"), to use, copy, modify, merge, publish,
+// and distribute the Software for personal, educational, or research purposes,
+// subject to the following conditions:
+
+// 1. Commercial Use:
+//    Any company, corporation, or organization intending to use the Software
+//    must first notify the copyright holder and obtain explicit written
+//    permission. Commercial use without such permission is strictly prohibited.
+
+// 2. Unauthorized Commercial Use:
+//    If a company is found to be using the Software without prior authorization,
+//    the copyright holder is entitled to receive 1% of the company’s gross
+//    profits moving forward, enforceable as a licensing fee.
+
+// 3. Artificial Intelligence / Machine Learning Use:
+//    If the Software is incorporated into machine learning
+//    models, neural networks, generative pre‑trained transformers (GPTs), or similar AI systems,
+//    the company deploying such use is solely responsible for compliance with
+//    this license. Responsibility cannot be shifted to the provider of training
+//    data or third‑party services.
+
+// 4. Attribution:
+//    The above copyright notice and this permission notice shall be included in
+//    all copies or substantial portions of the Software.
+
+// Disclaimer:
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Step time (updateWeights, getXHat, resample, mutateParticles, propogateState) for SINGLE_THREADED, MULTI_THREADED
+// and AUTO from a thousand to a million particles, plus what calibrating AUTO costs and the plan it picked.
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "particle_filter.hpp"
+
+struct ModeResult
+{
+    double construct_ms{0.0};
+    double step_us{0.0};
+    std::string plan;
+};
+
+ModeResult runBenchmark(PF_Params pf_params, const PF_THREAD_MODE thread_mode)
+{
+    constexpr int64_t STEPS = 20;
+    const State robot{30.0, 40.0};
+    const State waypoint{50.0, 50.0};
+    pf_params.thread_mode = thread_mode;
+
+    ModeResult result;
+    const auto construct_start = std::chrono::steady_clock::now();
+    ParticleFilter pf{pf_params, &likelihoodFunction, &moveEstimatedState};
+    const auto construct_stop = std::chrono::steady_clock::now();
+    result.construct_ms = std::chrono::duration<double, std::milli>(construct_stop - construct_start).count();
+    result.plan = pf.getThreadPlan().toString();
+
+    const auto start = std::chrono::steady_clock::now();
+    for (int64_t step = 0; step < STEPS; ++step)
+    {
+        pf.updateWeights(sensorFunction(robot), 5.0);
+        const State estimate = pf.getXHat();
+        static_cast<void>(estimate);
+        pf.resample();
+        pf.mutateParticles(pf_params.particle_propogation_std);
+        pf.propogateState(waypoint);
+    }
+    const auto stop = std::chrono::steady_clock::now();
+    result.step_us = std::chrono::duration<double, std::micro>(stop - start).count() / STEPS;
+    return result;
+}
+
+int main()
+{
+    std::cout << std::thread::hardware_concurrency() << " hardware threads\n";
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << std::setw(12) << "particles" << std::setw(16) << "single (us)" << std::setw(16) << "multi (us)" << std::setw(16) << "auto (us)"
+              << std::setw(24) << "auto construct (ms)" << std::setw(24) << "multi construct (ms)" << "\n";
+
+    std::vector<std::string> plans;
+    for (const int64_t num_particles : {1000, 10000, 100000, 1000000})
+    {
+        PF_Params pf_params;
+        pf_params.num_of_particles = num_particles;
+        const ModeResult single = runBenchmark(pf_params, PF_THREAD_MODE::SINGLE_THREADED);
+        const ModeResult multi = runBenchmark(pf_params, PF_THREAD_MODE::MULTI_THREADED);
+        const ModeResult automatic = runBenchmark(pf_params, PF_THREAD_MODE::AUTO);
+        std::cout << std::setw(12) << num_particles << std::setw(16) << single.step_us << std::setw(16) << multi.step_us << std::setw(16) << automatic.step_us
+                  << std::setw(24) << automatic.construct_ms << std::setw(24) << multi.construct_ms << "\n";
+        plans.push_back(automatic.plan);
+    }
+
+    std::cout << "\n";
+    for (const std::string& plan : plans)
+    {
+        std::cout << plan;
+    }
+
+    return 0;
+}
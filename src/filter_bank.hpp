@@ -0,0 +1,181 @@
+// Custom Non‑Commercial License
+
+// Copyright (c) 2025 Mgoodell97
+
+// Permission is hereby granted, free of charge, to any individual or
+// non‑commercial entity obtaining a copy of this software and associated
+// documentation files (the "Software"), to use, copy, modify, merge, publish,
+// and distribute the Software for personal, educational, or research purposes,
+// subject to the following conditions:
+
+// 1. Commercial Use:
+//    Any company, corporation, or organization intending to use the Software
+//    must first notify the copyright holder and obtain explicit written
+//    permission. Commercial use without such permission is strictly prohibited.
+
+// 2. Unauthorized Commercial Use:
+//    If a company is found to be using the Software without prior authorization,
+//    the copyright holder is entitled to receive 1% of the company’s gross
+//    profits moving forward, enforceable as a licensing fee.
+
+// 3. Artificial Intelligence / Machine Learning Use:
+//    If the Software is incorporated into machine learning
+//    models, neural networks, generative pre‑trained transformers (GPTs), or similar AI systems,
+//    the company deploying such use is solely responsible for compliance with
+//    this license. Responsibility cannot be shifted to the provider of training
+//    data or third‑party services.
+
+// 4. Attribution:
+//    The above copyright notice and this permission notice shall be included in
+//    all copies or substantial portions of the Software.
+
+// Disclaimer:
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "particle_filter.hpp"
+
+// K independent filters (one per tracked robot, say) stepped together on one shared pool, instead of K filters that
+// each start hardware_concurrency() threads of their own. Every batched call is one parallel_for over the filters,
+// and each filter's own chunks go to the same pool, so a few big filters still split across the cores while many
+// small ones keep them busy with whole filters. Workers run queued chunks while they wait, so the nesting can't deadlock.
+//
+// Storage: the ParticleFilter objects sit in one vector, but each filter still owns its particle, weight and scratch
+// arrays (separate cache line aligned AlignedArrays), the bank doesn't pool them into one arena. A filter step streams
+// through its own arrays from start to end, so they gain nothing from sitting next to another filter's, and owning
+// them keeps adaptive_particle_count able to grow a filter in place within its own capacity. Separate aligned
+// allocations also mean two workers stepping neighbouring filters never write to the same cache line.
+//
+// Filter k uses pf_params.random_seed + k, so the filters draw independent streams and a bank gives the same
+// particles run to run, whatever the pool size. With pf_params.thread_mode SINGLE_THREADED there is no pool and the
+// filters are stepped one after the other.
+template<ParticleModel Model = FunctionModel>
+class FilterBank
+{
+public:
+    using StateType = ModelState<Model>; // See ParticleFilter
+
+    // The shared pool is pf_params.thread_pool, or one made from its thread settings (see makeThreadPool).
+    // AUTO calibrates every filter, give it a thread_plan_file so the first one calibrates and the rest load its plan.
+    FilterBank(const PF_Params& pf_params, const int64_t num_filters, Model model)
+    {
+        if (pf_params.thread_mode != PF_THREAD_MODE::SINGLE_THREADED)
+        {
+            m_pool = makeThreadPool(pf_params);
+        }
+
+        // Reserved up front, the filter objects (not their particle arrays, see above) sit next to each other and never move
+        m_filters.reserve(num_filters);
+        for (int64_t k = 0; k < num_filters; ++k)
+        {
+            PF_Params filter_params = pf_params;
+            filter_params.random_seed = pf_params.random_seed + static_cast<uint64_t>(k);
+            filter_params.thread_pool = m_pool;
+            m_filters.emplace_back(filter_params, model);
+        }
+    }
+
+    FilterBank(const PF_Params& pf_params, const int64_t num_filters,
+               std::function<double(const double, const double, const double)> likelihood_function,
+               std::function<void(State&, const State&)> propagate_state_function) requires std::same_as<Model, FunctionModel>:
+        FilterBank(pf_params, num_filters, FunctionModel(likelihood_function, propagate_state_function)) {}
+
+    void initialize()
+    {
+        forEachFilter([this](const int64_t k) { m_filters[k].initialize(); });
+    }
+
+    // observations[k] is filter k's reading, all filters share the sensor noise
+    void updateWeights(const std::vector<double>& observations, const double sensor_std)
+    {
+        forEachFilter([this, &observations, sensor_std](const int64_t k) { m_filters[k].updateWeights(observations[k], sensor_std); });
+    }
+
+    // Each filter checks its own effective sample size, see ParticleFilter::resample
+    void resample()
+    {
+        forEachFilter([this](const int64_t k) { m_filters[k].resample(); });
+    }
+
+    void mutateParticles(const std::vector<double>& std_dev)
+    {
+        forEachFilter([this, &std_dev](const int64_t k) { m_filters[k].mutateParticles(std_dev); });
+    }
+
+    // waypoints[k] is filter k's control input
+    void propogateState(const std::vector<StateType>& waypoints)
+    {
+        forEachFilter([this, &waypoints](const int64_t k) { m_filters[k].propogateState(waypoints[k]); });
+    }
+
+    void resampleMutatePropagate(const std::vector<double>& std_dev, const std::vector<StateType>& waypoints)
+    {
+        forEachFilter([this, &std_dev, &waypoints](const int64_t k) { m_filters[k].resampleMutatePropagate(std_dev, waypoints[k]); });
+    }
+
+    // One estimate per filter, in filter order
+    std::vector<StateType> getXHats() const
+    {
+        std::vector<StateType> estimates(m_filters.size());
+        forEachFilter([this, &estimates](const int64_t k) { estimates[k] = m_filters[k].getXHat(); });
+        return estimates;
+    }
+
+    int64_t size() const
+    {
+        return static_cast<int64_t>(m_filters.size());
+    }
+
+    ParticleFilter<Model>& operator[](const int64_t k)
+    {
+        return m_filters[k];
+    }
+
+    const ParticleFilter<Model>& operator[](const int64_t k) const
+    {
+        return m_filters[k];
+    }
+
+    // Null when single threaded
+    const std::shared_ptr<ThreadPool>& getPool() const
+    {
+        return m_pool;
+    }
+
+private:
+    // One filter per chunk, handed out dynamically, so a filter that takes longer doesn't hold up the others
+    template<typename F>
+    void forEachFilter(F&& fn) const
+    {
+        if (!m_pool)
+        {
+            for (int64_t k = 0; k < size(); ++k)
+            {
+                fn(k);
+            }
+            return;
+        }
+        m_pool->parallel_for(0, size(), 1, [&fn](const int64_t first_filter, const int64_t last_filter)
+        {
+            for (int64_t k = first_filter; k < last_filter; ++k)
+            {
+                fn(k);
+            }
+        });
+    }
+
+    std::shared_ptr<ThreadPool> m_pool; // Shared with every filter in m_filters
+    std::vector<ParticleFilter<Model>> m_filters;
+};
@@ -65,6 +65,7 @@ int main()
     // Particle params
     PF_Params pf_params;
     pf_params.thread_mode = PF_THREAD_MODE::MULTI_THREADED;
+    pf_params.resample_ess_threshold = 0.5; // Skip resampling while at least half the particles still carry weight
     std::vector<double> particle_propogation_std{5,5};
     ParticleFilter pf{pf_params, &likelihoodFunction, &moveEstimatedState};
 
@@ -128,10 +129,12 @@ int main()
 
             double l2_error = calculateError(estimated_state, robot_state);
             std::cout << "    Error: " << l2_error << "\n";
+            std::cout << "    ESS: " << pf.getEffectiveSampleSize() << "\n";
             
-            pf.resample();                                // 2. Resample particles based on weights
-            pf.mutateParticles(particle_propogation_std); // 3. Add some noise to particles
-            pf.propogateState(waypoint);                  // 4. Move particles based on control input
+            // 2. Resample particles based on weights (if the ESS is low)
+            // 3. Add some noise to particles
+            // 4. Move particles based on control input
+            pf.resampleMutatePropagate(particle_propogation_std, waypoint);
         }
 
         // PF operations done 
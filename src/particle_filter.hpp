@@ -40,18 +40,40 @@
 
 #pragma once
 
+#include <array>
 #include <filesystem>
+#include <span>
 
 // Internal includes
 #include "thread_pool.hpp"
 #include "state_functions.hpp"
+#include "particle_storage.hpp"
+#include "simd_kernels.hpp"
+#include "particle_models.hpp"
+#include "philox.hpp"
+#include "thread_plan.hpp"
 
 enum PF_THREAD_MODE
 {
     MULTI_THREADED,
-    SINGLE_THREADED
+    SINGLE_THREADED,
+    AUTO // Every stage on its own picks serial or parallel and a grain, by timing both at construction (see PF_ThreadPlan)
 };
 
+// How resample() picks the next generation. Systematic, stratified and residual search a prefix sum of the weights,
+// multinomial draws from an alias table, Metropolis and rejection only compare weights so they need no global scan.
+enum PF_RESAMPLING_SCHEME
+{
+    SYSTEMATIC,  // One random offset, evenly spaced spokes. Lowest variance, the default
+    STRATIFIED,  // One random offset per spoke, inside its own 1/N stratum
+    RESIDUAL,    // floor(N * w) copies of every particle, then systematic on what's left over
+    MULTINOMIAL, // N independent draws, O(1) each from a Walker/Vose alias table (the table is built serially)
+    METROPOLIS,  // metropolis_iterations accept/reject steps per particle. Biased unless that's large compared to max/mean weight
+    REJECTION    // Exact, but costs about max/mean weight draws per particle so avoid it with very peaked weights
+};
+
+// The per component settings (bounds, propagation std and KLD bin sizes) take one entry per component of the model's state,
+// the defaults suit the stock 2D model. The filter checks them once and copies them into fixed size arrays.
 struct PF_Params
 {
     int64_t num_of_particles{1000000};
@@ -59,73 +81,221 @@ struct PF_Params
     std::vector<double> starting_state_upper_bound{X_MAX,Y_MAX};
     std::vector<double> particle_propogation_std{5,5};
     PF_THREAD_MODE thread_mode{PF_THREAD_MODE::MULTI_THREADED};
+    int64_t parallel_grain_size{0}; // Particles per parallel_for chunk, 0 lets the thread pool pick (a few chunks per pool thread)
+
+    // Where MULTI_THREADED runs, see makeThreadPool. An existing thread_pool is used as is and can be shared with other
+    // filters or the rest of the application. Otherwise the filter starts num_threads workers (0 is one per hardware
+    // thread, or one per CPU in worker_cpus) and pins them to worker_cpus, or to every available CPU with pin_threads.
+    std::shared_ptr<ThreadPool> thread_pool{};
+    int64_t num_threads{0};
+    std::vector<int> worker_cpus{}; // Keeps the filter off the cores the rest of the application reserves for itself
+    bool pin_threads{false}; // Pin each pool worker to its own core (Linux), so the pages it first touched stay on its NUMA node
+    std::filesystem::path thread_plan_file{}; // AUTO only. Reuse the plan saved here if it was calibrated for the same setup (see PF_ThreadPlan::sameSetupAs), otherwise calibrate and save it here
+    SIMD_LEVEL simd_level{SIMD_LEVEL::SIMD_AUTO}; // Instruction set for the sensor and likelihood kernels
+    uint64_t random_seed{1234}; // Same seed, same particles every run, whatever the thread count
+    PF_RESAMPLING_SCHEME resampling_scheme{PF_RESAMPLING_SCHEME::SYSTEMATIC};
+    int64_t metropolis_iterations{32}; // Chain length per particle for PF_RESAMPLING_SCHEME::METROPOLIS
+    double resample_ess_threshold{1.0}; // Only resample when ESS < threshold * num_of_particles, 1.0 resamples every step
+    bool log_domain_weights{false}; // Keep log likelihoods and shift by their max before exponentiating, for sensors so sharp the likelihoods underflow
+    bool streaming_resample{false}; // SYSTEMATIC and STRATIFIED walk the weights block by block from per block totals instead of building an N sized prefix sum. Same particles, one pass and 8 bytes per particle less
+
+    // KLD-sampling (Fox 2003), resample() picks the next particle count between kld_min_particles and num_of_particles
+    bool adaptive_particle_count{false};
+    int64_t kld_min_particles{1000};
+    std::vector<double> kld_bin_size{1.0, 1.0}; // Grid over the starting bounds that occupied bins are counted on. Only the first kld_bin_size.size() components are binned, so a big state can bin on its position alone
+    double kld_epsilon{0.05}; // Bound on the KL divergence between the sampled and the binned posterior
+    double kld_z_quantile{2.326}; // Upper 1 - delta quantile of the standard normal, 2.326 is delta = 0.01
 };
 
+// pf_params.thread_pool when it's set, otherwise a new pool sized and pinned from num_threads, worker_cpus and pin_threads
+std::shared_ptr<ThreadPool> makeThreadPool(const PF_Params& pf_params);
+
+// Partial sums of the weight pass, enough for both the normalization and the effective sample size
+struct WeightSums
+{
+    double sum{0.0};
+    double sum_of_squares{0.0};
+};
+
+// Model supplies the sensor, likelihood and motion model (see particle_models.hpp). They are resolved at compile time
+// so they inline into the per particle loops. The std::function constructor builds a FunctionModel for convenience.
+//
+// The state is the model's ModelState, StateN<D> with D from 2 to MAX_STATE_DIM, stored one array per component.
+//
+// The member definitions live in particle_filter_impl.hpp. ParticleFilter<FunctionModel> and ParticleFilter<DefaultModel>
+// are compiled once in particle_filter.cpp, include particle_filter_impl.hpp to use your own model.
+template<ParticleModel Model = FunctionModel>
 class ParticleFilter 
 {
 public:
+    using StateType = ModelState<Model>;
+    static constexpr int64_t DIM = StateType::DIM;
+    using Storage = ParticleStorageN<DIM>;
+    using Reading = BeaconReadingN<DIM>;
+    static_assert(DIM >= 2 && DIM <= MAX_STATE_DIM, "The filter takes states with 2 to MAX_STATE_DIM components");
+
+    // Throws std::invalid_argument when a per component setting in pf_params doesn't have DIM entries
+    ParticleFilter(const PF_Params& pf_params, Model model);
+
+    explicit ParticleFilter(const PF_Params& pf_params) requires std::default_initializable<Model>:
+        ParticleFilter(pf_params, Model{}) {}
+
     ParticleFilter(const PF_Params& pf_params,
                    std::function<double(const double, const double, const double)> likelihood_function,
-                   std::function<void(State&, const State&)> propagate_state_function);
+                   std::function<void(State&, const State&)> propagate_state_function) requires std::same_as<Model, FunctionModel>:
+        ParticleFilter(pf_params, FunctionModel(likelihood_function, propagate_state_function)) {}
+
     void initialize();
 
     // 1. Update weights based on sensor reading
     void updateWeights(const double observation, const double sensor_std);
 
+    // 1. With several sensors (beacons) at once. The joint likelihood of all readings is taken in one pass over the
+    //    particles and normalized once, the same as calling updateWeights per reading up to rounding.
+    //    The observation overload above is a single reading with the beacon at the origin.
+    void updateWeights(std::span<const Reading> readings);
+
     // 1.5 Best time to get estimate before moving particles
-    State getXHat() const;
+    StateType getXHat() const;
+
+    // (sum w)^2 / sum w^2 from the last weight update, N when the weights are uniform
+    double getEffectiveSampleSize() const;
 
-    // 2. Resample particles based on weights (keep the best and discard the rest)
+    // 2. Resample particles based on weights (keep the best and discard the rest).
+    //    Does nothing while the effective sample size is above pf_params.resample_ess_threshold * N, the weights then
+    //    carry over and the next updateWeights multiplies into them.
     void resample();
 
-    // 3. Mutate particles to add randomness to duplucates after resampling
+    // 3. Mutate particles to add randomness to duplucates after resampling. std_dev has one entry per state component.
     void mutateParticles(const std::vector<double>& std_dev);
 
     // 4. Move particles based on control input
-    void propogateState(const State& waypoint);
+    void propogateState(const StateType& waypoint);
+
+    // 2-4 in one pass: gather each ancestor, add its noise and move it while writing the new buffer.
+    // Same result as calling resample, mutateParticles and propogateState in turn.
+    void resampleMutatePropagate(const std::vector<double>& std_dev, const StateType& waypoint);
+
+    // Current (resampled or weighted) particle states, mostly for tests and tools
+    const Storage& getParticles() const;
+
+    // pf_params.num_of_particles unless adaptive_particle_count has shrunk it
+    int64_t getNumParticles() const;
+
+    // The pool the filter runs on, null when single threaded
+    const std::shared_ptr<ThreadPool>& getPool() const;
+
+    // Which stages run on the pool, calibrated when pf_params.thread_mode is AUTO. toString() it for the logs.
+    const PF_ThreadPlan& getThreadPlan() const;
+
+    // True after initialize and resample, every particle then has weight 1/N and the weight array isn't read
+    bool hasUniformWeights() const;
 
     // For visualizations
     void saveParticleStatesToFile(const std::filesystem::path& filepath) const;
 
 private:
-    State getXHatSingleThreaded() const;
-    State getXHatMultiThreaded() const;
+    // Kernels over [start_index, end_index), shared by the single and multithreaded paths
+    StateType getXHatChunk(const int64_t start_index, const int64_t end_index) const;
+    void mutateChunk(Storage& particles, const int64_t start_index, const int64_t end_index, const std::array<double, DIM>& std_dev, const uint64_t rng_step);
+    void propogateChunk(Storage& particles, const int64_t start_index, const int64_t end_index, const StateType& waypoint);
+    void mutatePropagateChunk(Storage& particles, const int64_t start_index, const int64_t end_index,
+                              const std::array<double, DIM>& std_dev, const uint64_t rng_step, const StateType& waypoint, const bool gather);
+    WeightSums updateWeightsChunk(const int64_t start_index, const int64_t end_index, std::span<const Reading> readings);
+    double updateLogWeightsChunk(const int64_t start_index, const int64_t end_index, std::span<const Reading> readings);
+    static constexpr int64_t WEIGHT_BLOCK_SIZE = 256; // Particles whose likelihoods are worked out together while in L1
+    double blockLikelihoods(std::span<const Reading> readings, const int64_t block_start, const int64_t block_size, double* likelihoods) const;
+    void blockLogLikelihoods(std::span<const Reading> readings, const int64_t block_start, const int64_t block_size, double* log_likelihoods) const;
+    // Components of the particles in [block_start, block_start + block_size) in the beacon's frame, in the scratch
+    // arrays when the beacon isn't at the origin
+    std::array<const double*, DIM> blockInBeaconFrame(const Reading& reading, const int64_t block_start, const int64_t block_size,
+                                                      double (&scratch)[DIM][WEIGHT_BLOCK_SIZE]) const;
+    WeightSums exponentiateLogWeightsChunk(const int64_t start_index, const int64_t end_index, const double max_log_weight);
+    static double sumOfSquares(const double* values, const int64_t count);
+    void gatherChunk(const int64_t start_index, const int64_t end_index);
+    template<typename SpokeF>
+    void searchSpokesChunk(const AlignedArray<double>& cumulative_weights, const int64_t start_index, const int64_t end_index, SpokeF&& spoke);
+
+    // Runs fn over [begin, end) on the pool with the stage's grain, or as one chunk when the plan has the stage serial
+    template<typename F>
+    void forEachChunk(const PF_STAGE stage, const int64_t begin, const int64_t end, F&& fn);
+
+    // Every sum in the filter goes through this. The leaves and the pairwise tree over them are fixed by the range,
+    // so results are bit identical whatever the thread mode, core count or grain.
+    static constexpr int64_t REDUCE_LEAF_SIZE = 2048; // Also the block size of cumulativeSum
+    template<typename T, typename MapF, typename CombineF>
+    T reduceChunks(const PF_STAGE stage, const int64_t begin, const int64_t end, const T& identity, MapF&& map, CombineF&& combine) const;
 
-    void mutateParticlesSingleThreded(const std::vector<double>& std_dev);
-    void mutateParticlesMultiThreaded(const std::vector<double>& std_dev);
+    // AUTO only, fills m_thread_plan from pf_params.thread_plan_file or by timing every stage serially and in parallel
+    void planThreads();
+    void calibrateThreadPlan();
 
-    void propogateStateSingleThreaded(const State& waypoint);
-    void propogateStateMultiThreaded(const State& waypoint);
+    void setWeightSums(const WeightSums& weight_sums);
 
-    void updateWeightsSingleThreaded(const double observation, const double sensor_std);
-    void updateWeightsMultiThreaded(const double observation, const double sensor_std);
+    // Shared by resample and resampleMutatePropagate
+    bool shouldResample() const;
+    int64_t selectResampleAncestors(const uint64_t rng_step);
+    void finishResample(const int64_t num_new_particles);
 
-    void resampleSingleThreaded();
-    void resampleMultiThreaded();
-    void workEfficientParallelPrefixSum(const std::vector<double>& input_output, std::vector<double>& result);
+    // Each fills m_mutation_indicies with the ancestors of num_new_particles new particles
+    void selectAncestors(const uint64_t rng_step, const int64_t num_new_particles);
+    void resampleSystematic(const uint64_t rng_step, const bool stratified, const int64_t num_new_particles);
+    double sumWeightBlocks();
+    template<typename SpokeF>
+    void walkWeightBlocks(const int64_t num_new_particles, SpokeF&& spoke);
+    bool needsCumulativeWeights() const;
+    void resampleResidual(const uint64_t rng_step, const int64_t num_new_particles);
+    void resampleMultinomial(const uint64_t rng_step, const int64_t num_new_particles);
+    void resampleMetropolis(const uint64_t rng_step, const int64_t num_new_particles);
+    void resampleRejection(const uint64_t rng_step, const int64_t num_new_particles);
 
-    void normalizeWeights();
-    void normalizeWeightsParallel();
+    // KLD-sampling
+    int64_t countOccupiedBins(const int64_t num_ancestors);
+    int64_t kldParticleCount(const int64_t num_occupied_bins) const;
+    void setNumParticles(const int64_t num_particles);
+    int64_t uniformToIndex(const double uniform) const;
+
+    void cumulativeSum(const AlignedArray<double>& input_vec, AlignedArray<double>& result);
+    void parallelPrefixSum(const AlignedArray<double>& input_vec, AlignedArray<double>& result);
 
     void initializeVariables();
+    void firstTouchBuffers();
+
+    // One entry of a per component setting for each state component
+    static std::array<double, DIM> toComponents(const std::vector<double>& values, const char* name);
 
     PF_Params m_pf_params;
-    int64_t m_num_particles; // This is in PF params but's it used enough it's worth having a direct copy
-    std::vector<State> m_particles;
-    std::vector<double> m_particle_weights;
-    std::function<double(const double, const double, const double)> m_likelihood_function;
-    std::function<void(State&, const State&)> m_propagate_state_function;
-    std::default_random_engine m_rand_eng;
-    std::vector<double> m_default_weights; // For fast reallocation of default weights after each resampleSingleThreaded
+    int64_t m_num_particles; // Current count, pf_params.num_of_particles unless KLD-sampling has shrunk it
+    std::array<double, DIM> m_lower_bound; // pf_params.starting_state_lower_bound and upper_bound
+    std::array<double, DIM> m_upper_bound;
+    Storage m_particles; // Structure of arrays, see particle_storage.hpp
+    AlignedArray<double> m_particle_weights; // Unnormalized, divide by m_weight_sum. Stale while m_uniform_weights is set
+    AlignedArray<double> m_log_weights; // pf_params.log_domain_weights only, shifted so the largest is 0
+    double m_weight_sum{1.0};
+    bool m_uniform_weights{true}; // All weights equal, set instead of rewriting m_particle_weights after resampling
+    double m_effective_sample_size{0.0}; // Only valid while m_uniform_weights is false
+    Model m_model;
+    const SimdKernels* m_simd_kernels; // Picked once from pf_params.simd_level and the CPU, handed to the model's batch hooks
+    CounterRng m_rng; // Keyed by pf_params.random_seed, see philox.hpp
+    uint64_t m_rng_step{0}; // Bumped by every stage call that draws random numbers
 
     // Variables used often so it's worth not initializing them each time
-    State m_pf_estimate;
-    std::vector<double> m_particle_obersvations;
-    std::vector<double> m_cumulative_weights_vector;
-    std::vector<State> m_new_particles; // Tmp storage for resampling
-    std::vector<int64_t> m_mutation_indicies;
+    StateType m_pf_estimate;
+    AlignedArray<double> m_cumulative_weights_vector; // Also the residual copy counts and the alias probabilities. Empty unless needsCumulativeWeights()
+    std::vector<double> m_block_weight_prefixes; // pf_params.streaming_resample only, running weight total before each REDUCE_LEAF_SIZE block
+    AlignedArray<double> m_residual_cumulative_weights; // PF_RESAMPLING_SCHEME::RESIDUAL only
+    AlignedArray<int64_t> m_alias_indicies; // PF_RESAMPLING_SCHEME::MULTINOMIAL only
+    std::vector<uint8_t> m_kld_bins; // Occupancy grid for adaptive_particle_count, all zero between resamples
+    std::vector<int64_t> m_kld_num_bins; // Along each binned component, the first one varies fastest in m_kld_bins
+    static constexpr int64_t MAX_KLD_BINS = int64_t{1} << 26; // One byte per bin, 64 MB
+    Storage m_new_particles; // Resample gathers into this and swaps it with m_particles, the two ping-pong
+    AlignedArray<int64_t> m_mutation_indicies;
+    ScanBlockStates<double> m_scan_states; // Look-back flags and totals for the parallel prefix sum
 
     // Multithreading variables
     std::shared_ptr<ThreadPool> m_pool; // For parallel processing
-    std::vector<std::vector<int64_t>> m_mutation_indicies_chunks;
+    PF_ThreadPlan m_thread_plan; // Every stage serial without a pool
 };
+
+extern template class ParticleFilter<FunctionModel>;
+extern template class ParticleFilter<DefaultModel>;
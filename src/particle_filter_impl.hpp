@@ -0,0 +1,1598 @@
+// Custom Non‑Commercial License
+
+// Copyright (c) 2025 Mgoodell97
+
+// Permission is hereby granted, free of charge, to any individual or
+// non‑commercial entity obtaining a copy of this software and associated
+// documentation files (the "Software"), to use, copy, modify, merge, publish,
+// and distribute the Software for personal, educational, or research purposes,
+// subject to the following conditions:
+
+// 1. Commercial Use:
+//    Any company, corporation, or organization intending to use the Software
+//    must first notify the copyright holder and obtain explicit written
+//    permission. Commercial use without such permission is strictly prohibited.
+
+// 2. Unauthorized Commercial Use:
+//    If a company is found to be using the Software without prior authorization,
+//    the copyright holder is entitled to receive 1% of the company’s gross
+//    profits moving forward, enforceable as a licensing fee.
+
+// 3. Artificial Intelligence / Machine Learning Use:
+//    If the Software is incorporated into machine learning
+//    models, neural networks, generative pre‑trained transformers (GPTs), or similar AI systems,
+//    the company deploying such use is solely responsible for compliance with
+//    this license. Responsibility cannot be shifted to the provider of training
+//    data or third‑party services.
+
+// 4. Attribution:
+//    The above copyright notice and this permission notice shall be included in
+//    all copies or substantial portions of the Software.
+
+// Disclaimer:
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Member definitions of ParticleFilter<Model>, include this instead of particle_filter.hpp to build a filter
+// with your own model. See particle_filter.cpp for the models that are compiled once.
+
+#pragma once
+
+#include <iostream>
+#include <algorithm>
+#include <vector>
+#include <random>
+#include <iomanip>
+#include <numbers>
+#include <fstream>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <functional>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <typeinfo>
+
+#ifdef TRACY_ENABLE
+    #include "tracy/Tracy.hpp"
+#endif
+
+
+#include "helper_functions.hpp"
+#include "particle_filter.hpp"
+
+template<ParticleModel Model>
+ParticleFilter<Model>::ParticleFilter(const PF_Params& pf_params, Model model):
+    m_pf_params(pf_params), 
+    m_num_particles(pf_params.num_of_particles),
+    m_lower_bound(toComponents(pf_params.starting_state_lower_bound, "starting_state_lower_bound")),
+    m_upper_bound(toComponents(pf_params.starting_state_upper_bound, "starting_state_upper_bound")),
+    m_model(std::move(model)),
+    m_simd_kernels(&getSimdKernels(m_pf_params.simd_level)),
+    m_rng(pf_params.random_seed)
+{
+    // The rest of the per component settings are only checked here, so a bad one fails now rather than mid run
+    toComponents(m_pf_params.particle_propogation_std, "particle_propogation_std");
+    if (m_pf_params.adaptive_particle_count)
+    {
+        if (m_pf_params.kld_bin_size.empty() || static_cast<int64_t>(m_pf_params.kld_bin_size.size()) > DIM)
+        {
+            throw std::invalid_argument("kld_bin_size needs between 1 and " + std::to_string(DIM) + " entries");
+        }
+
+        // The grid is sized in doubles first, so a huge or broken setting is an error rather than an overflowing cast
+        double num_bins = 1.0;
+        m_kld_num_bins.resize(m_pf_params.kld_bin_size.size());
+        for (size_t d = 0; d < m_kld_num_bins.size(); ++d)
+        {
+            const double bin_size = m_pf_params.kld_bin_size[d];
+            if (!(bin_size > 0.0) || !std::isfinite(bin_size))
+            {
+                throw std::invalid_argument("kld_bin_size entries must be positive and finite, entry " + std::to_string(d) + " is " + std::to_string(bin_size));
+            }
+            const double num_component_bins = std::ceil((m_upper_bound[d] - m_lower_bound[d]) / bin_size);
+            num_bins *= num_component_bins >= 1.0 ? num_component_bins : 1.0;
+            if (!(num_bins <= static_cast<double>(MAX_KLD_BINS)))
+            {
+                throw std::invalid_argument("kld_bin_size makes a grid of more than " + std::to_string(MAX_KLD_BINS) + " bins, use bigger bins or bin fewer components");
+            }
+            m_kld_num_bins[d] = num_component_bins >= 1.0 ? static_cast<int64_t>(num_component_bins) : 1;
+        }
+    }
+
+    switch(m_pf_params.thread_mode)
+    {
+        case PF_THREAD_MODE::MULTI_THREADED:
+        case PF_THREAD_MODE::AUTO:
+            // Pinned workers stay next to the pages they first touched in initializeVariables
+            m_pool = makeThreadPool(m_pf_params);
+            break;
+        case PF_THREAD_MODE::SINGLE_THREADED:
+            break;
+    }
+
+    // Every stage on the pool with the configured grain, until AUTO has timed them
+    m_thread_plan.num_particles = m_pf_params.num_of_particles;
+    m_thread_plan.num_threads = m_pool ? m_pool->getNumberOfThreads() : 1;
+    m_thread_plan.resampling_scheme = static_cast<int64_t>(m_pf_params.resampling_scheme);
+    m_thread_plan.streaming_resample = m_pf_params.streaming_resample;
+    m_thread_plan.log_domain_weights = m_pf_params.log_domain_weights;
+    m_thread_plan.adaptive_particle_count = m_pf_params.adaptive_particle_count;
+    m_thread_plan.metropolis_iterations = m_pf_params.metropolis_iterations;
+    m_thread_plan.pool_mode = m_pool ? static_cast<int64_t>(m_pool->getMode()) : 0;
+    m_thread_plan.parallel_grain_size = m_pf_params.parallel_grain_size;
+    m_thread_plan.simd_level = static_cast<int64_t>(m_simd_kernels->level);
+    m_thread_plan.state_dim = DIM;
+    m_thread_plan.model = typeid(Model).name();
+    m_thread_plan.host = currentHostName();
+    for (PF_StagePlan& stage_plan : m_thread_plan.stages)
+    {
+        stage_plan = PF_StagePlan{m_pool != nullptr, m_pf_params.parallel_grain_size};
+    }
+
+    initializeVariables();
+
+    this->initialize();
+
+    if (m_pf_params.thread_mode == PF_THREAD_MODE::AUTO)
+    {
+        planThreads();
+    }
+}
+
+template<ParticleModel Model>
+void ParticleFilter<Model>::planThreads()
+{
+    const std::filesystem::path& plan_file = m_pf_params.thread_plan_file;
+    PF_ThreadPlan cached_plan;
+    if (!plan_file.empty() && cached_plan.loadFromFile(plan_file) && cached_plan.sameSetupAs(m_thread_plan))
+    {
+        m_thread_plan = cached_plan;
+        return;
+    }
+
+    calibrateThreadPlan();
+    if (!plan_file.empty())
+    {
+        m_thread_plan.saveToFile(plan_file);
+    }
+}
+
+template<ParticleModel Model>
+void ParticleFilter<Model>::calibrateThreadPlan()
+{
+    #ifdef TRACY_ENABLE
+        ZoneScopedN("calibrateThreadPlan");
+    #endif
+
+    // Each stage is timed on the filter's own buffers serially and at a few grains (the pool's default of a few chunks
+    // per thread, one chunk per thread and many small ones), and the fastest is kept. Going parallel has to win by
+    // PARALLEL_MARGIN, so timing noise doesn't hand a stage to the pool for nothing. Stages go in step order with the
+    // earlier choices in place, so the resample timing already includes the chosen scan.
+    constexpr int64_t REPEATS = 3;
+    constexpr double PARALLEL_MARGIN = 0.95;
+    const int64_t num_threads = m_pool->getNumberOfThreads();
+    std::vector<PF_StagePlan> candidates{PF_StagePlan{false, 0}, PF_StagePlan{true, 0}};
+    for (const int64_t chunks_per_thread : {int64_t{1}, int64_t{16}})
+    {
+        const int64_t num_chunks = num_threads * chunks_per_thread;
+        candidates.push_back(PF_StagePlan{true, std::max<int64_t>((m_num_particles + num_chunks - 1) / num_chunks, 1)});
+    }
+
+    auto calibrate = [this, &candidates, PARALLEL_MARGIN](const PF_STAGE stage, const auto& run_stage)
+    {
+        // The scan's blocks are fixed by REDUCE_LEAF_SIZE, it only chooses serial or parallel
+        const int64_t num_candidates = stage == PF_STAGE::STAGE_SCAN ? 2 : static_cast<int64_t>(candidates.size());
+        PF_StagePlan best_plan{false, 0, std::numeric_limits<double>::infinity()};
+        for (int64_t candidate = 0; candidate < num_candidates; ++candidate)
+        {
+            m_thread_plan[stage] = candidates[candidate];
+            run_stage(); // Warm up the caches and the pool
+            double best_us = std::numeric_limits<double>::infinity();
+            for (int64_t repeat = 0; repeat < REPEATS; ++repeat)
+            {
+                const auto start = std::chrono::steady_clock::now();
+                run_stage();
+                const auto stop = std::chrono::steady_clock::now();
+                best_us = std::min(best_us, std::chrono::duration<double, std::micro>(stop - start).count());
+            }
+            const double margin = candidates[candidate].parallel && !best_plan.parallel ? PARALLEL_MARGIN : 1.0;
+            if (best_us < best_plan.time_us * margin)
+            {
+                best_plan = candidates[candidate];
+                best_plan.time_us = best_us;
+            }
+        }
+        m_thread_plan[stage] = best_plan;
+    };
+
+    // A broad likelihood so the weights are neither uniform nor all underflowed, like a filter that hasn't converged
+    StateType centre;
+    for (int64_t d = 0; d < DIM; ++d)
+    {
+        centre[d] = (m_lower_bound[d] + m_upper_bound[d]) / 2.0;
+    }
+    const double observation = m_model.sensor(centre);
+    const double sensor_std = (m_upper_bound[0] - m_lower_bound[0]) / 4.0;
+
+    calibrate(PF_STAGE::STAGE_INITIALIZE, [this]() { initialize(); });
+    calibrate(PF_STAGE::STAGE_WEIGHTS, [this, observation, sensor_std]()
+    {
+        // Every run starts from the uniform weights a step sees after resampling, so the stage is timed on the path
+        // steps take and the weights left for the scan and resample timings are one broad update, not many multiplied
+        m_uniform_weights = true;
+        m_weight_sum = static_cast<double>(m_num_particles);
+        updateWeights(observation, sensor_std);
+    });
+    calibrate(PF_STAGE::STAGE_ESTIMATE, [this]() { m_pf_estimate = getXHat(); });
+    if (needsCumulativeWeights())
+    {
+        calibrate(PF_STAGE::STAGE_SCAN, [this]() { cumulativeSum(m_particle_weights, m_cumulative_weights_vector); });
+    }
+    else if (m_pf_params.streaming_resample)
+    {
+        calibrate(PF_STAGE::STAGE_SCAN, [this]() { sumWeightBlocks(); });
+    }
+    calibrate(PF_STAGE::STAGE_RESAMPLE, [this]()
+    {
+        // Ancestors and the gather, but the new buffer isn't swapped in so every repeat starts from the same weights
+        selectAncestors(0, m_num_particles);
+        forEachChunk(PF_STAGE::STAGE_RESAMPLE, 0, m_num_particles, [this](const int64_t start_index, const int64_t end_index)
+        {
+            gatherChunk(start_index, end_index);
+        });
+    });
+    calibrate(PF_STAGE::STAGE_MUTATE, [this]() { mutateParticles(m_pf_params.particle_propogation_std); });
+    calibrate(PF_STAGE::STAGE_PROPAGATE, [this, &centre]() { propogateState(centre); });
+
+    // Back to the particles the constructor drew, as if calibration never ran
+    m_rng_step = 0;
+    initialize();
+}
+
+template<ParticleModel Model>
+void ParticleFilter<Model>::initializeVariables()
+{
+    m_particles.resize(m_num_particles);
+    m_particle_weights.resize(m_num_particles);
+    if (needsCumulativeWeights())
+    {
+        m_cumulative_weights_vector.resize(m_num_particles);
+    }
+    if (m_pf_params.streaming_resample)
+    {
+        m_block_weight_prefixes.resize((m_num_particles + REDUCE_LEAF_SIZE - 1) / REDUCE_LEAF_SIZE + 1, 0.0);
+    }
+    if (m_pf_params.log_domain_weights)
+    {
+        m_log_weights.resize(m_num_particles);
+    }
+    if (m_pf_params.resampling_scheme == PF_RESAMPLING_SCHEME::RESIDUAL)
+    {
+        m_residual_cumulative_weights.resize(m_num_particles);
+    }
+    if (m_pf_params.resampling_scheme == PF_RESAMPLING_SCHEME::MULTINOMIAL)
+    {
+        m_alias_indicies.resize(m_num_particles);
+    }
+    m_new_particles.resize(m_num_particles);
+    m_mutation_indicies.resize(m_num_particles);
+    m_scan_states.reserve((m_num_particles + REDUCE_LEAF_SIZE - 1) / REDUCE_LEAF_SIZE);
+    firstTouchBuffers();
+
+    if (m_pf_params.adaptive_particle_count)
+    {
+        // m_kld_num_bins was checked and sized in the constructor
+        int64_t num_bins = 1;
+        for (const int64_t num_component_bins : m_kld_num_bins)
+        {
+            num_bins *= num_component_bins;
+        }
+        m_kld_bins.resize(num_bins, 0);
+    }
+}
+
+template<ParticleModel Model>
+void ParticleFilter<Model>::firstTouchBuffers()
+{
+    // None of the per particle arrays are written when they're allocated, so the OS only backs a page with memory
+    // when it's first written. Writing them from the pool puts each page on the NUMA node of a worker that processes
+    // that range, instead of every page on the constructing thread's node. initialize() does the same for m_particles.
+    forEachChunk(PF_STAGE::STAGE_INITIALIZE, 0, m_num_particles, [this](const int64_t start_index, const int64_t end_index)
+    {
+        auto touch = [start_index, end_index](auto& buffer)
+        {
+            if (buffer.size() >= end_index)
+            {
+                std::fill(buffer.begin() + start_index, buffer.begin() + end_index, 0);
+            }
+        };
+        touch(m_particle_weights);
+        touch(m_cumulative_weights_vector);
+        touch(m_log_weights);
+        touch(m_residual_cumulative_weights);
+        touch(m_alias_indicies);
+        touch(m_mutation_indicies);
+        for (int64_t d = 0; d < DIM; ++d)
+        {
+            std::fill(m_new_particles.component(d) + start_index, m_new_particles.component(d) + end_index, 0.0);
+        }
+    });
+}
+
+template<ParticleModel Model>
+std::array<double, ParticleFilter<Model>::DIM> ParticleFilter<Model>::toComponents(const std::vector<double>& values, const char* name)
+{
+    if (static_cast<int64_t>(values.size()) != DIM)
+    {
+        throw std::invalid_argument(std::string(name) + " has " + std::to_string(values.size()) + " entries, the state has " + std::to_string(DIM) + " components");
+    }
+    std::array<double, DIM> components;
+    std::copy(values.begin(), values.end(), components.begin());
+    return components;
+}
+
+template<ParticleModel Model>
+void ParticleFilter<Model>::initialize() 
+{
+    // Starting over replays the same random numbers, so a re-initialized filter follows the same trajectory
+    m_rng_step = 0;
+
+    // And with the full particle count, KLD-sampling shrinks it again once the filter converges
+    setNumParticles(m_pf_params.num_of_particles);
+
+    // Counter based, so the particles are the same whichever worker draws them. Uniform over the starting bounds,
+    // a pair of components per draw.
+    forEachChunk(PF_STAGE::STAGE_INITIALIZE, 0, m_num_particles, [this](const int64_t start_index, const int64_t end_index)
+    {
+        for (int64_t i = start_index; i < end_index; i++)
+        {
+            for (int64_t d = 0; d < DIM; d += 2)
+            {
+                const auto [u_a, u_b] = m_rng.uniform2(RNG_STREAM_INITIALIZE, m_rng_step, i + static_cast<uint64_t>(d / 2) * RNG_COMPONENT_PAIR_STRIDE);
+                m_particles.component(d)[i] = m_lower_bound[d] + u_a * (m_upper_bound[d] - m_lower_bound[d]);
+                if (d + 1 < DIM)
+                {
+                    m_particles.component(d + 1)[i] = m_lower_bound[d + 1] + u_b * (m_upper_bound[d + 1] - m_lower_bound[d + 1]);
+                }
+            }
+        }
+    });
+    m_uniform_weights = true;
+    m_weight_sum = static_cast<double>(m_num_particles);
+}
+
+template<ParticleModel Model>
+typename ParticleFilter<Model>::StateType ParticleFilter<Model>::getXHat() const
+{
+    #ifdef TRACY_ENABLE
+        ZoneScopedN("getXHat");
+    #endif
+
+    auto combineXHats = [](StateType lhs, const StateType& rhs)
+    {
+        for (int64_t d = 0; d < DIM; ++d)
+        {
+            lhs[d] += rhs[d];
+        }
+        return lhs;
+    };
+    StateType pf_estimate = reduceChunks(PF_STAGE::STAGE_ESTIMATE, 0, m_num_particles, StateType{}, [this](const int64_t start_index, const int64_t end_index)
+    {
+        return getXHatChunk(start_index, end_index);
+    }, combineXHats);
+
+    // Weights are left unnormalized by updateWeights, normalize the estimate instead
+    for (int64_t d = 0; d < DIM; ++d)
+    {
+        pf_estimate[d] /= m_weight_sum;
+    }
+
+    return pf_estimate;
+}
+
+template<ParticleModel Model>
+double ParticleFilter<Model>::getEffectiveSampleSize() const
+{
+    return m_uniform_weights ? static_cast<double>(m_num_particles) : m_effective_sample_size;
+}
+
+template<ParticleModel Model>
+void ParticleFilter<Model>::mutateParticles(const std::vector<double>& std_dev)
+{
+    #ifdef TRACY_ENABLE
+        ZoneScopedN("mutateParticles");
+    #endif
+
+    const std::array<double, DIM> component_std_dev = toComponents(std_dev, "std_dev");
+    const uint64_t rng_step = m_rng_step++;
+    forEachChunk(PF_STAGE::STAGE_MUTATE, 0, m_num_particles, [this, &component_std_dev, rng_step](const int64_t start_index, const int64_t end_index)
+    {
+        mutateChunk(m_particles, start_index, end_index, component_std_dev, rng_step);
+    });
+}
+
+template<ParticleModel Model>
+void ParticleFilter<Model>::propogateState(const StateType& waypoint)
+{
+    #ifdef TRACY_ENABLE
+        ZoneScopedN("propogateState");
+    #endif
+
+    forEachChunk(PF_STAGE::STAGE_PROPAGATE, 0, m_num_particles, [this, &waypoint](const int64_t start_index, const int64_t end_index)
+    {
+        propogateChunk(m_particles, start_index, end_index, waypoint);
+    });
+}
+
+template<ParticleModel Model>
+void ParticleFilter<Model>::updateWeights(const double observation, const double sensor_std)
+{
+    Reading reading; // Beacon at the origin
+    reading.observation = observation;
+    reading.sensor_std = sensor_std;
+    updateWeights(std::span<const Reading>(&reading, 1));
+}
+
+template<ParticleModel Model>
+void ParticleFilter<Model>::updateWeights(const std::span<const Reading> readings)
+{
+    #ifdef TRACY_ENABLE
+        ZoneScopedN("updateWeights");
+    #endif
+
+    // Nothing was observed, the weights stay as they are
+    if (readings.empty())
+    {
+        return;
+    }
+
+    auto combineWeightSums = [](const WeightSums& lhs, const WeightSums& rhs)
+    {
+        return WeightSums{lhs.sum + rhs.sum, lhs.sum_of_squares + rhs.sum_of_squares};
+    };
+
+    // Sensor, likelihood and weight sums in one pass. Normalization is deferred to the consumers
+    // (getXHat, resample, saving) since they only need the sum.
+    if (!m_pf_params.log_domain_weights)
+    {
+        setWeightSums(reduceChunks(PF_STAGE::STAGE_WEIGHTS, 0, m_num_particles, WeightSums{}, [this, readings](const int64_t start_index, const int64_t end_index)
+        {
+            return updateWeightsChunk(start_index, end_index, readings);
+        }, combineWeightSums));
+        return;
+    }
+
+    // Log domain, one pass for the log weights and their max then one to exponentiate with the max shifted out
+    auto combineMax = [](const double lhs, const double rhs)
+    {
+        return std::max(lhs, rhs);
+    };
+    const double max_log_weight = reduceChunks(PF_STAGE::STAGE_WEIGHTS, 0, m_num_particles, -std::numeric_limits<double>::infinity(),
+                                               [this, readings](const int64_t start_index, const int64_t end_index)
+    {
+        return updateLogWeightsChunk(start_index, end_index, readings);
+    }, combineMax);
+    if (!std::isfinite(max_log_weight))
+    {
+        setWeightSums(WeightSums{});
+        return;
+    }
+
+    setWeightSums(reduceChunks(PF_STAGE::STAGE_WEIGHTS, 0, m_num_particles, WeightSums{}, [this, max_log_weight](const int64_t start_index, const int64_t end_index)
+    {
+        return exponentiateLogWeightsChunk(start_index, end_index, max_log_weight);
+    }, combineWeightSums));
+}
+
+template<ParticleModel Model>
+void ParticleFilter<Model>::resample()
+{
+    #ifdef TRACY_ENABLE
+        ZoneScopedN("resample");
+    #endif
+
+    // The step is used up even when resampling is skipped so the random numbers that follow don't depend on it
+    const uint64_t rng_step = m_rng_step++;
+    if (!shouldResample())
+    {
+        return;
+    }
+
+    // Mutate particles with the selected ancestors
+    const int64_t num_new_particles = selectResampleAncestors(rng_step);
+    forEachChunk(PF_STAGE::STAGE_RESAMPLE, 0, num_new_particles, [this](const int64_t start_index, const int64_t end_index)
+    {
+        gatherChunk(start_index, end_index);
+    });
+
+    finishResample(num_new_particles);
+}
+
+template<ParticleModel Model>
+void ParticleFilter<Model>::resampleMutatePropagate(const std::vector<double>& std_dev, const StateType& waypoint)
+{
+    #ifdef TRACY_ENABLE
+        ZoneScopedN("resampleMutatePropagate");
+    #endif
+
+    const std::array<double, DIM> component_std_dev = toComponents(std_dev, "std_dev");
+
+    // Same random numbers as resample, mutateParticles, propogateState one after the other
+    const uint64_t resample_rng_step = m_rng_step++;
+    const uint64_t mutate_rng_step = m_rng_step++;
+
+    if (!shouldResample())
+    {
+        forEachChunk(PF_STAGE::STAGE_MUTATE, 0, m_num_particles, [this, &component_std_dev, &waypoint, mutate_rng_step](const int64_t start_index, const int64_t end_index)
+        {
+            mutatePropagateChunk(m_particles, start_index, end_index, component_std_dev, mutate_rng_step, waypoint, false);
+        });
+        return;
+    }
+
+    // Gather, noise and motion a block at a time while the block is in L1, straight into the new buffer
+    const int64_t num_new_particles = selectResampleAncestors(resample_rng_step);
+    forEachChunk(PF_STAGE::STAGE_MUTATE, 0, num_new_particles, [this, &component_std_dev, &waypoint, mutate_rng_step](const int64_t start_index, const int64_t end_index)
+    {
+        mutatePropagateChunk(m_new_particles, start_index, end_index, component_std_dev, mutate_rng_step, waypoint, true);
+    });
+
+    finishResample(num_new_particles);
+}
+
+template<ParticleModel Model>
+const typename ParticleFilter<Model>::Storage& ParticleFilter<Model>::getParticles() const
+{
+    return m_particles;
+}
+
+template<ParticleModel Model>
+const std::shared_ptr<ThreadPool>& ParticleFilter<Model>::getPool() const
+{
+    return m_pool;
+}
+
+template<ParticleModel Model>
+const PF_ThreadPlan& ParticleFilter<Model>::getThreadPlan() const
+{
+    return m_thread_plan;
+}
+
+template<ParticleModel Model>
+int64_t ParticleFilter<Model>::getNumParticles() const
+{
+    return m_num_particles;
+}
+
+template<ParticleModel Model>
+bool ParticleFilter<Model>::hasUniformWeights() const
+{
+    return m_uniform_weights;
+}
+
+template<ParticleModel Model>
+void ParticleFilter<Model>::saveParticleStatesToFile(const std::filesystem::path& filepath) const
+{
+    std::filesystem::create_directories(filepath.parent_path());
+
+    std::ofstream file(filepath);
+    if (!file.is_open())
+    {
+        std::cerr << "Error opening file: " << filepath << std::endl;
+        return;
+    }
+
+    file << std::fixed << std::setprecision(6);
+    // The position keeps its x,y columns, any further components follow as s2, s3, ...
+    file << "i,x,y";
+    for (int64_t d = 2; d < DIM; ++d)
+    {
+        file << ",s" << d;
+    }
+    file << ",w" << "\n";
+
+    const double uniform_weight = 1.0 / static_cast<double>(m_num_particles);
+    for (int64_t i = 0; i < m_particles.size(); ++i)
+    {
+        if (i % 100 == 0) // Save every 100th particle to reduce file size
+        {
+            file << i;
+            for (int64_t d = 0; d < DIM; ++d)
+            {
+                file << "," << m_particles.component(d)[i];
+            }
+            file << "," << (m_uniform_weights ? uniform_weight : m_particle_weights[i] / m_weight_sum) << "\n";
+        }
+    }
+
+    file.close();
+}
+
+// --------------- Private functions ---------------
+
+// The chunk kernels below work on [start_index, end_index) of the SoA arrays. The single threaded
+// paths run them over every particle, the multithreaded paths hand them to parallel_for.
+
+template<ParticleModel Model>
+typename ParticleFilter<Model>::StateType ParticleFilter<Model>::getXHatChunk(const int64_t start_index, const int64_t end_index) const
+{
+    std::array<const double*, DIM> components;
+    for (int64_t d = 0; d < DIM; ++d)
+    {
+        components[d] = m_particles.component(d);
+    }
+    const double* weights = m_particle_weights.data();
+
+    std::array<double, DIM> local_sums{};
+    if (m_uniform_weights)
+    {
+        // Every weight is the same, the estimate is the plain mean (m_weight_sum is N here)
+        for (int64_t i = start_index; i < end_index; ++i)
+        {
+            for (int64_t d = 0; d < DIM; ++d)
+            {
+                local_sums[d] += components[d][i];
+            }
+        }
+    }
+    else
+    {
+        for (int64_t i = start_index; i < end_index; ++i)
+        {
+            for (int64_t d = 0; d < DIM; ++d)
+            {
+                local_sums[d] += components[d][i] * weights[i];
+            }
+        }
+    }
+
+    StateType local_estimate;
+    for (int64_t d = 0; d < DIM; ++d)
+    {
+        local_estimate[d] = local_sums[d];
+    }
+    return local_estimate;
+}
+
+template<ParticleModel Model>
+void ParticleFilter<Model>::mutateChunk(Storage& particles, const int64_t start_index, const int64_t end_index, const std::array<double, DIM>& std_dev, const uint64_t rng_step)
+{
+    // Each particle's noise comes from its own counter, nothing depends on how the particles were split into chunks.
+    // Uniforms are drawn for a block at a time and turned into normals by the SIMD Box-Muller kernel, a pair of
+    // components per draw.
+    constexpr int64_t NOISE_BLOCK_SIZE = 256;
+    double u_radius[NOISE_BLOCK_SIZE];
+    double u_angle[NOISE_BLOCK_SIZE];
+    double noise_a[NOISE_BLOCK_SIZE];
+    double noise_b[NOISE_BLOCK_SIZE];
+
+    for (int64_t block_start = start_index; block_start < end_index; block_start += NOISE_BLOCK_SIZE)
+    {
+        const int64_t block_size = std::min(NOISE_BLOCK_SIZE, end_index - block_start);
+        for (int64_t d = 0; d < DIM; d += 2)
+        {
+            m_rng.uniformBlock(RNG_STREAM_MUTATE, rng_step, block_start + static_cast<uint64_t>(d / 2) * RNG_COMPONENT_PAIR_STRIDE, block_size, u_radius, u_angle);
+            m_simd_kernels->box_muller(u_radius, u_angle, noise_a, noise_b, block_size);
+
+            double* values_a = particles.component(d) + block_start;
+            const double std_dev_a = std_dev[d];
+            if (d + 1 < DIM)
+            {
+                double* values_b = particles.component(d + 1) + block_start;
+                const double std_dev_b = std_dev[d + 1];
+                for (int64_t j = 0; j < block_size; ++j)
+                {
+                    values_a[j] += noise_a[j] * std_dev_a;
+                    values_b[j] += noise_b[j] * std_dev_b;
+                }
+            }
+            else
+            {
+                for (int64_t j = 0; j < block_size; ++j)
+                {
+                    values_a[j] += noise_a[j] * std_dev_a;
+                }
+            }
+        }
+    }
+}
+
+template<ParticleModel Model>
+void ParticleFilter<Model>::propogateChunk(Storage& particles, const int64_t start_index, const int64_t end_index, const StateType& waypoint)
+{
+    if constexpr (BatchMotionModel<Model>)
+    {
+        m_model.propagateBatch(particles.xs() + start_index, particles.ys() + start_index, end_index - start_index, waypoint);
+    }
+    else
+    {
+        for (int64_t i = start_index; i < end_index; ++i)
+        {
+            StateType particle = particles.get(i);
+            m_model.propagate(particle, waypoint);
+            particles.set(i, particle);
+        }
+    }
+}
+
+template<ParticleModel Model>
+void ParticleFilter<Model>::mutatePropagateChunk(Storage& particles, const int64_t start_index, const int64_t end_index,
+                                                 const std::array<double, DIM>& std_dev, const uint64_t rng_step, const StateType& waypoint, const bool gather)
+{
+    // Every stage runs on the same small block before moving on, so each particle is loaded and stored once
+    constexpr int64_t FUSED_BLOCK_SIZE = 256;
+    for (int64_t block_start = start_index; block_start < end_index; block_start += FUSED_BLOCK_SIZE)
+    {
+        const int64_t block_end = std::min(block_start + FUSED_BLOCK_SIZE, end_index);
+        if (gather)
+        {
+            gatherChunk(block_start, block_end);
+        }
+        mutateChunk(particles, block_start, block_end, std_dev, rng_step);
+        propogateChunk(particles, block_start, block_end, waypoint);
+    }
+}
+
+template<ParticleModel Model>
+std::array<const double*, ParticleFilter<Model>::DIM> ParticleFilter<Model>::blockInBeaconFrame(const Reading& reading, const int64_t block_start, const int64_t block_size,
+                                                                                               double (&scratch)[DIM][WEIGHT_BLOCK_SIZE]) const
+{
+    // Only the components the beacon is off the origin in are copied, so a reading at the origin is exactly the
+    // old single observation update
+    std::array<const double*, DIM> components;
+    for (int64_t d = 0; d < DIM; ++d)
+    {
+        components[d] = m_particles.component(d) + block_start;
+        if (reading.beacon[d] != 0.0)
+        {
+            for (int64_t j = 0; j < block_size; ++j)
+            {
+                scratch[d][j] = components[d][j] - reading.beacon[d];
+            }
+            components[d] = scratch[d];
+        }
+    }
+    return components;
+}
+
+template<ParticleModel Model>
+double ParticleFilter<Model>::blockLikelihoods(const std::span<const Reading> readings, const int64_t block_start, const int64_t block_size,
+                                               double* likelihoods) const
+{
+    // Readings are independent so the joint likelihood is their product, built up reading by reading while the block
+    // is in L1. Returns the sum of the block's likelihoods.
+    double beacon_frame[DIM][WEIGHT_BLOCK_SIZE];
+    double reading_likelihoods[WEIGHT_BLOCK_SIZE];
+
+    double block_sum = 0.0;
+    for (size_t r = 0; r < readings.size(); ++r)
+    {
+        const Reading& reading = readings[r];
+        const std::array<const double*, DIM> components = blockInBeaconFrame(reading, block_start, block_size, beacon_frame);
+
+        double* target = r == 0 ? likelihoods : reading_likelihoods;
+        if constexpr (BatchWeightModel<Model>)
+        {
+            block_sum = m_model.updateWeightsBatch(*m_simd_kernels, components[0], components[1], target, block_size, reading.observation, reading.sensor_std);
+        }
+        else
+        {
+            block_sum = 0.0;
+            for (int64_t j = 0; j < block_size; ++j)
+            {
+                StateType particle;
+                for (int64_t d = 0; d < DIM; ++d)
+                {
+                    particle[d] = components[d][j];
+                }
+                target[j] = m_model.likelihood(reading.observation, m_model.sensor(particle), reading.sensor_std);
+                block_sum += target[j];
+            }
+        }
+
+        if (r > 0)
+        {
+            block_sum = 0.0;
+            for (int64_t j = 0; j < block_size; ++j)
+            {
+                likelihoods[j] *= reading_likelihoods[j];
+                block_sum += likelihoods[j];
+            }
+        }
+    }
+    return block_sum;
+}
+
+template<ParticleModel Model>
+void ParticleFilter<Model>::blockLogLikelihoods(const std::span<const Reading> readings, const int64_t block_start, const int64_t block_size,
+                                                double* log_likelihoods) const
+{
+    // Same as blockLikelihoods with the product turned into a sum of logs
+    double beacon_frame[DIM][WEIGHT_BLOCK_SIZE];
+    double reading_log_likelihoods[WEIGHT_BLOCK_SIZE];
+
+    for (size_t r = 0; r < readings.size(); ++r)
+    {
+        const Reading& reading = readings[r];
+        const std::array<const double*, DIM> components = blockInBeaconFrame(reading, block_start, block_size, beacon_frame);
+
+        double* target = r == 0 ? log_likelihoods : reading_log_likelihoods;
+        if constexpr (BatchLogWeightModel<Model>)
+        {
+            m_model.updateLogWeightsBatch(*m_simd_kernels, components[0], components[1], target, block_size, reading.observation, reading.sensor_std);
+        }
+        else
+        {
+            for (int64_t j = 0; j < block_size; ++j)
+            {
+                StateType particle;
+                for (int64_t d = 0; d < DIM; ++d)
+                {
+                    particle[d] = components[d][j];
+                }
+                const double estimate_observation = m_model.sensor(particle);
+                if constexpr (LogLikelihoodModel<Model>)
+                {
+                    target[j] = m_model.logLikelihood(reading.observation, estimate_observation, reading.sensor_std);
+                }
+                else
+                {
+                    target[j] = std::log(m_model.likelihood(reading.observation, estimate_observation, reading.sensor_std));
+                }
+            }
+        }
+
+        if (r > 0)
+        {
+            for (int64_t j = 0; j < block_size; ++j)
+            {
+                log_likelihoods[j] += reading_log_likelihoods[j];
+            }
+        }
+    }
+}
+
+template<ParticleModel Model>
+WeightSums ParticleFilter<Model>::updateWeightsChunk(const int64_t start_index, const int64_t end_index, const std::span<const Reading> readings)
+{
+    // Works through the chunk a block at a time so the sums of squares are taken while the weights are still in L1.
+    // Uniform weights are simply overwritten. Weights carried over from a skipped resample are multiplied by the
+    // new likelihoods instead (and normalized by the old sum on the way so they don't underflow).
+    double likelihoods[WEIGHT_BLOCK_SIZE];
+
+    double* weights = m_particle_weights.data();
+    const bool carry_weights = !m_uniform_weights && m_weight_sum > 0.0;
+    const double carried_weight_scale = carry_weights ? 1.0 / m_weight_sum : 1.0;
+
+    WeightSums local_sums;
+    for (int64_t block_start = start_index; block_start < end_index; block_start += WEIGHT_BLOCK_SIZE)
+    {
+        const int64_t block_size = std::min(WEIGHT_BLOCK_SIZE, end_index - block_start);
+        double* block_likelihoods = carry_weights ? likelihoods : weights + block_start;
+
+        double block_sum = blockLikelihoods(readings, block_start, block_size, block_likelihoods);
+
+        if (carry_weights)
+        {
+            block_sum = 0.0;
+            for (int64_t j = 0; j < block_size; ++j)
+            {
+                weights[block_start + j] *= likelihoods[j] * carried_weight_scale;
+                block_sum += weights[block_start + j];
+            }
+        }
+
+        local_sums.sum += block_sum;
+        local_sums.sum_of_squares += sumOfSquares(weights + block_start, block_size);
+    }
+    return local_sums;
+}
+
+template<ParticleModel Model>
+double ParticleFilter<Model>::updateLogWeightsChunk(const int64_t start_index, const int64_t end_index, const std::span<const Reading> readings)
+{
+    // First pass of the log domain update, log likelihoods (added to the carried log weights) and their max
+    double log_likelihoods[WEIGHT_BLOCK_SIZE];
+
+    double* log_weights = m_log_weights.data();
+    const bool carry_weights = !m_uniform_weights;
+
+    double local_max = -std::numeric_limits<double>::infinity();
+    for (int64_t block_start = start_index; block_start < end_index; block_start += WEIGHT_BLOCK_SIZE)
+    {
+        const int64_t block_size = std::min(WEIGHT_BLOCK_SIZE, end_index - block_start);
+        blockLogLikelihoods(readings, block_start, block_size, log_likelihoods);
+
+        for (int64_t j = 0; j < block_size; ++j)
+        {
+            const double log_weight = carry_weights ? log_weights[block_start + j] + log_likelihoods[j] : log_likelihoods[j];
+            log_weights[block_start + j] = log_weight;
+            local_max = std::max(local_max, log_weight);
+        }
+    }
+    return local_max;
+}
+
+template<ParticleModel Model>
+WeightSums ParticleFilter<Model>::exponentiateLogWeightsChunk(const int64_t start_index, const int64_t end_index, const double max_log_weight)
+{
+    // Second pass, shift so the best particle has weight 1 and exponentiate with the SIMD exp. The shifted log weights
+    // are kept so weights carried over a skipped resample stay near 0 in the log domain.
+    double* log_weights = m_log_weights.data();
+    double* weights = m_particle_weights.data();
+
+    WeightSums local_sums;
+    for (int64_t block_start = start_index; block_start < end_index; block_start += WEIGHT_BLOCK_SIZE)
+    {
+        const int64_t block_size = std::min(WEIGHT_BLOCK_SIZE, end_index - block_start);
+        for (int64_t j = 0; j < block_size; ++j)
+        {
+            log_weights[block_start + j] -= max_log_weight;
+        }
+        m_simd_kernels->exp(log_weights + block_start, weights + block_start, block_size);
+
+        double block_sum = 0.0;
+        for (int64_t j = 0; j < block_size; ++j)
+        {
+            block_sum += weights[block_start + j];
+        }
+        local_sums.sum += block_sum;
+        local_sums.sum_of_squares += sumOfSquares(weights + block_start, block_size);
+    }
+    return local_sums;
+}
+
+template<ParticleModel Model>
+double ParticleFilter<Model>::sumOfSquares(const double* values, const int64_t count)
+{
+    // Four running sums so the adds don't wait on each other (the compiler can't reorder them itself)
+    double sums_of_squares[4] = {0.0, 0.0, 0.0, 0.0};
+    int64_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        sums_of_squares[0] += values[i] * values[i];
+        sums_of_squares[1] += values[i + 1] * values[i + 1];
+        sums_of_squares[2] += values[i + 2] * values[i + 2];
+        sums_of_squares[3] += values[i + 3] * values[i + 3];
+    }
+    for (; i < count; ++i)
+    {
+        sums_of_squares[0] += values[i] * values[i];
+    }
+    return (sums_of_squares[0] + sums_of_squares[1]) + (sums_of_squares[2] + sums_of_squares[3]);
+}
+
+template<ParticleModel Model>
+void ParticleFilter<Model>::gatherChunk(const int64_t start_index, const int64_t end_index)
+{
+    std::array<const double*, DIM> old_components;
+    std::array<double*, DIM> new_components;
+    for (int64_t d = 0; d < DIM; ++d)
+    {
+        old_components[d] = m_particles.component(d);
+        new_components[d] = m_new_particles.component(d);
+    }
+    for (int64_t index = start_index; index < end_index; ++index)
+    {
+        const int64_t ancestor = m_mutation_indicies[index];
+        for (int64_t d = 0; d < DIM; ++d)
+        {
+            new_components[d][index] = old_components[d][ancestor];
+        }
+    }
+}
+
+template<ParticleModel Model>
+void ParticleFilter<Model>::setWeightSums(const WeightSums& weight_sums)
+{
+    // Every weight underflowed (or the model gave back nonsense), there is nothing to weight by so start over from
+    // equal weights rather than dividing by zero everywhere
+    if (!(weight_sums.sum > 0.0) || !std::isfinite(weight_sums.sum))
+    {
+        m_uniform_weights = true;
+        m_weight_sum = static_cast<double>(m_num_particles);
+        return;
+    }
+
+    m_weight_sum = weight_sums.sum;
+    // Can't be more than N, but rounding can push nearly equal weights just past it
+    const double effective_sample_size = weight_sums.sum_of_squares > 0.0 ? weight_sums.sum * weight_sums.sum / weight_sums.sum_of_squares : 0.0;
+    m_effective_sample_size = std::min(effective_sample_size, static_cast<double>(m_num_particles));
+    m_uniform_weights = false;
+}
+
+template<ParticleModel Model>
+bool ParticleFilter<Model>::shouldResample() const
+{
+    // Equal weights carry nothing to resample on (systematic would pick every particle exactly once anyway), and
+    // weights that are still healthy are left to carry over to the next update
+    const double effective_sample_size_threshold = m_pf_params.resample_ess_threshold * static_cast<double>(m_num_particles);
+    return !m_uniform_weights && m_effective_sample_size <= effective_sample_size_threshold;
+}
+
+template<ParticleModel Model>
+int64_t ParticleFilter<Model>::selectResampleAncestors(const uint64_t rng_step)
+{
+    selectAncestors(rng_step, m_num_particles);
+
+    // KLD-sampling: size the next generation from how many grid bins this one's picks landed in, then pick again
+    // for that count. Same step, so a count that doesn't change picks the same ancestors.
+    int64_t num_new_particles = m_num_particles;
+    if (m_pf_params.adaptive_particle_count)
+    {
+        num_new_particles = kldParticleCount(countOccupiedBins(m_num_particles));
+        if (num_new_particles != m_num_particles)
+        {
+            selectAncestors(rng_step, num_new_particles);
+        }
+    }
+
+    m_new_particles.resize(num_new_particles);
+    return num_new_particles;
+}
+
+template<ParticleModel Model>
+void ParticleFilter<Model>::finishResample(const int64_t num_new_particles)
+{
+    // Ping-pong the buffers instead of copying the gathered particles back, and mark the weights
+    // uniform instead of rewriting them
+    m_particles.swap(m_new_particles);
+    setNumParticles(num_new_particles);
+    m_uniform_weights = true;
+    m_weight_sum = static_cast<double>(m_num_particles);
+}
+
+template<ParticleModel Model>
+void ParticleFilter<Model>::selectAncestors(const uint64_t rng_step, const int64_t num_new_particles)
+{
+    switch(m_pf_params.resampling_scheme)
+    {
+        case PF_RESAMPLING_SCHEME::SYSTEMATIC:
+            resampleSystematic(rng_step, false, num_new_particles);
+            break;
+        case PF_RESAMPLING_SCHEME::STRATIFIED:
+            resampleSystematic(rng_step, true, num_new_particles);
+            break;
+        case PF_RESAMPLING_SCHEME::RESIDUAL:
+            resampleResidual(rng_step, num_new_particles);
+            break;
+        case PF_RESAMPLING_SCHEME::MULTINOMIAL:
+            resampleMultinomial(rng_step, num_new_particles);
+            break;
+        case PF_RESAMPLING_SCHEME::METROPOLIS:
+            resampleMetropolis(rng_step, num_new_particles);
+            break;
+        case PF_RESAMPLING_SCHEME::REJECTION:
+            resampleRejection(rng_step, num_new_particles);
+            break;
+    }
+}
+
+template<ParticleModel Model>
+int64_t ParticleFilter<Model>::countOccupiedBins(const int64_t num_ancestors)
+{
+    // Bins cover the starting bounds of the binned components, anything outside is counted in the nearest edge bin
+    const int64_t num_binned_components = static_cast<int64_t>(m_kld_num_bins.size());
+
+    forEachChunk(PF_STAGE::STAGE_RESAMPLE, 0, num_ancestors, [&](const int64_t start_index, const int64_t end_index)
+    {
+        for (int64_t i = start_index; i < end_index; ++i)
+        {
+            const int64_t ancestor = m_mutation_indicies[i];
+            int64_t bin_index = 0;
+            int64_t bin_stride = 1;
+            for (int64_t d = 0; d < num_binned_components; ++d)
+            {
+                // Clamped while still a double, a NaN or far off particle (a custom model can make either) lands in
+                // an edge bin instead of overflowing the cast. NaN fails offset >= 0 and goes to bin 0.
+                const double offset = (m_particles.component(d)[ancestor] - m_lower_bound[d]) / m_pf_params.kld_bin_size[d];
+                const double bin = offset >= 0.0 ? std::min(std::floor(offset), static_cast<double>(m_kld_num_bins[d] - 1)) : 0.0;
+                bin_index += static_cast<int64_t>(bin) * bin_stride;
+                bin_stride *= m_kld_num_bins[d];
+            }
+
+            // Converged clouds hit the same few bins from every thread, only write the first time so the
+            // cache lines aren't bounced between cores
+            std::atomic_ref<uint8_t> bin{m_kld_bins[bin_index]};
+            if (bin.load(std::memory_order_relaxed) == 0)
+            {
+                bin.store(1, std::memory_order_relaxed);
+            }
+        }
+    });
+
+    // Count and clear for next time in the same pass
+    int64_t num_occupied_bins = 0;
+    for (uint8_t& bin : m_kld_bins)
+    {
+        num_occupied_bins += bin;
+        bin = 0;
+    }
+    return num_occupied_bins;
+}
+
+template<ParticleModel Model>
+int64_t ParticleFilter<Model>::kldParticleCount(const int64_t num_occupied_bins) const
+{
+    // Fox, "Adapting the Sample Size in Particle Filters Through KLD-Sampling". Enough particles that, with
+    // probability 1 - delta, the KL divergence between the sampled and true (binned) posterior is below epsilon.
+    const int64_t min_particles = std::clamp(m_pf_params.kld_min_particles, int64_t{1}, m_pf_params.num_of_particles);
+    if (num_occupied_bins <= 1)
+    {
+        return min_particles;
+    }
+
+    const double k_minus_one = static_cast<double>(num_occupied_bins - 1);
+    const double a = 2.0 / (9.0 * k_minus_one);
+    const double cube_root = 1.0 - a + std::sqrt(a) * m_pf_params.kld_z_quantile;
+    const double num_required = k_minus_one / (2.0 * m_pf_params.kld_epsilon) * cube_root * cube_root * cube_root;
+    if (num_required >= static_cast<double>(m_pf_params.num_of_particles))
+    {
+        return m_pf_params.num_of_particles;
+    }
+    return std::max(static_cast<int64_t>(std::ceil(num_required)), min_particles);
+}
+
+template<ParticleModel Model>
+void ParticleFilter<Model>::setNumParticles(const int64_t num_particles)
+{
+    // Everything was sized for pf_params.num_of_particles up front, so none of these reallocate
+    m_num_particles = num_particles;
+    m_particles.resize(num_particles);
+    m_new_particles.resize(num_particles);
+    m_particle_weights.resize(num_particles);
+    if (needsCumulativeWeights())
+    {
+        m_cumulative_weights_vector.resize(num_particles);
+    }
+    if (m_pf_params.log_domain_weights)
+    {
+        m_log_weights.resize(num_particles);
+    }
+    if (m_pf_params.resampling_scheme == PF_RESAMPLING_SCHEME::RESIDUAL)
+    {
+        m_residual_cumulative_weights.resize(num_particles);
+    }
+}
+
+template<ParticleModel Model>
+template<typename F>
+void ParticleFilter<Model>::forEachChunk(const PF_STAGE stage, const int64_t begin, const int64_t end, F&& fn)
+{
+    const PF_StagePlan& stage_plan = m_thread_plan[stage];
+    if (stage_plan.parallel)
+    {
+        m_pool->parallel_for(begin, end, stage_plan.grain_size, fn);
+    }
+    else if (begin < end)
+    {
+        fn(begin, end);
+    }
+}
+
+template<ParticleModel Model>
+template<typename T, typename MapF, typename CombineF>
+T ParticleFilter<Model>::reduceChunks(const PF_STAGE stage, const int64_t begin, const int64_t end, const T& identity, MapF&& map, CombineF&& combine) const
+{
+    // Both paths build the same pairwise tree over REDUCE_LEAF_SIZE leaves, so sums come out bit identical
+    // serial or parallel and on any number of cores
+    const PF_StagePlan& stage_plan = m_thread_plan[stage];
+    if (stage_plan.parallel)
+    {
+        return m_pool->parallel_pairwise_reduce(begin, end, REDUCE_LEAF_SIZE, stage_plan.grain_size, identity, map, combine);
+    }
+    return pairwiseReduce(begin, end, REDUCE_LEAF_SIZE, identity, map, combine);
+}
+
+template<ParticleModel Model>
+template<typename SpokeF>
+void ParticleFilter<Model>::searchSpokesChunk(const AlignedArray<double>& cumulative_weights, const int64_t start_index, const int64_t end_index, SpokeF&& spoke)
+{
+    // Spokes increase with the index, so binary search for the chunk's first one and walk from there.
+    // Rounding can put the last spokes just past the total, they go to the last particle instead of off the end.
+    const int64_t last_index = static_cast<int64_t>(cumulative_weights.size()) - 1;
+    const auto it = std::lower_bound(cumulative_weights.begin(), cumulative_weights.end(), spoke(start_index));
+    int64_t index_candidate = std::min(static_cast<int64_t>(std::distance(cumulative_weights.begin(), it)), last_index);
+
+    for (int64_t spoke_index = start_index; spoke_index < end_index; ++spoke_index)
+    {
+        const double wheel_spoke = spoke(spoke_index);
+        while (index_candidate < last_index && cumulative_weights[index_candidate] < wheel_spoke)
+        {
+            index_candidate += 1;
+        }
+        m_mutation_indicies[spoke_index] = index_candidate;
+    }
+}
+
+template<ParticleModel Model>
+int64_t ParticleFilter<Model>::uniformToIndex(const double uniform) const
+{
+    return std::min(static_cast<int64_t>(uniform * static_cast<double>(m_num_particles)), m_num_particles - 1);
+}
+
+template<ParticleModel Model>
+void ParticleFilter<Model>::resampleSystematic(const uint64_t rng_step, const bool stratified, const int64_t num_new_particles)
+{
+    double cumulative_sum = 0.0;
+    if (m_pf_params.streaming_resample)
+    {
+        cumulative_sum = sumWeightBlocks();
+    }
+    else
+    {
+        cumulativeSum(m_particle_weights, m_cumulative_weights_vector);
+        cumulative_sum = m_cumulative_weights_vector.back();
+    }
+
+    // Either search the prefix sum or walk the weights a block at a time, both give the same ancestors
+    auto selectSpokes = [this, num_new_particles](const auto& spoke)
+    {
+        if (m_pf_params.streaming_resample)
+        {
+            walkWeightBlocks(num_new_particles, spoke);
+            return;
+        }
+        forEachChunk(PF_STAGE::STAGE_RESAMPLE, 0, num_new_particles, [this, &spoke](const int64_t start_index, const int64_t end_index)
+        {
+            searchSpokesChunk(m_cumulative_weights_vector, start_index, end_index, spoke);
+        });
+    };
+
+    // Generate values from 0.0 to 1/N
+    const double wheel_spoke_step = cumulative_sum / static_cast<double>(num_new_particles);
+
+    if (stratified)
+    {
+        // Every spoke gets its own offset inside its stratum
+        selectSpokes([this, wheel_spoke_step, rng_step](const int64_t spoke_index)
+        {
+            const double offset = m_rng.uniform2(RNG_STREAM_RESAMPLE, rng_step, spoke_index).first;
+            return (static_cast<double>(spoke_index) + offset) * wheel_spoke_step;
+        });
+        return;
+    }
+
+    // Now we make the wheel. Spin to win!
+    const double wheel_spoke_start = m_rng.uniform2(RNG_STREAM_RESAMPLE, rng_step, 0).first * wheel_spoke_step;
+    selectSpokes([wheel_spoke_start, wheel_spoke_step](const int64_t spoke_index)
+    {
+        return wheel_spoke_start + wheel_spoke_step * static_cast<double>(spoke_index);
+    });
+}
+
+template<ParticleModel Model>
+double ParticleFilter<Model>::sumWeightBlocks()
+{
+    // The total of every REDUCE_LEAF_SIZE block, scanned with the same kernel as cumulativeSum so the running
+    // totals land on exactly the values the prefix sum would have at the block ends
+    const int64_t num_blocks = (m_num_particles + REDUCE_LEAF_SIZE - 1) / REDUCE_LEAF_SIZE;
+    m_block_weight_prefixes.resize(num_blocks + 1);
+
+    // A block belongs to the chunk its first particle is in, whatever the chunking
+    forEachChunk(PF_STAGE::STAGE_SCAN, 0, m_num_particles, [this](const int64_t start_index, const int64_t end_index)
+    {
+        double scanned_weights[REDUCE_LEAF_SIZE];
+        for (int64_t block = (start_index + REDUCE_LEAF_SIZE - 1) / REDUCE_LEAF_SIZE; block * REDUCE_LEAF_SIZE < end_index; ++block)
+        {
+            const int64_t block_start = block * REDUCE_LEAF_SIZE;
+            const int64_t block_size = std::min(REDUCE_LEAF_SIZE, m_num_particles - block_start);
+            m_block_weight_prefixes[block + 1] = m_simd_kernels->prefix_sum(m_particle_weights.data() + block_start, scanned_weights, block_size);
+        }
+    });
+
+    // Turn the totals into running totals in block order, like the block offsets of cumulativeSum
+    double block_offset = 0.0;
+    m_block_weight_prefixes[0] = 0.0;
+    for (int64_t block = 0; block < num_blocks; ++block)
+    {
+        block_offset += m_block_weight_prefixes[block + 1];
+        m_block_weight_prefixes[block + 1] = block_offset;
+    }
+    return block_offset;
+}
+
+template<ParticleModel Model>
+template<typename SpokeF>
+void ParticleFilter<Model>::walkWeightBlocks(const int64_t num_new_particles, SpokeF&& spoke)
+{
+    // Block b takes the spokes in (prefix[b], prefix[b + 1]], found by binary search since the spokes only increase.
+    // The first block also takes anything at or below 0 and the last anything past the total (rounding).
+    const int64_t num_blocks = static_cast<int64_t>(m_block_weight_prefixes.size()) - 1;
+    auto firstSpokeAbove = [num_new_particles, &spoke](const double value)
+    {
+        int64_t low = 0;
+        int64_t high = num_new_particles;
+        while (low < high)
+        {
+            const int64_t middle = low + (high - low) / 2;
+            if (spoke(middle) > value)
+            {
+                high = middle;
+            }
+            else
+            {
+                low = middle + 1;
+            }
+        }
+        return low;
+    };
+
+    forEachChunk(PF_STAGE::STAGE_RESAMPLE, 0, m_num_particles, [&](const int64_t start_index, const int64_t end_index)
+    {
+        double scanned_weights[REDUCE_LEAF_SIZE];
+        for (int64_t block = (start_index + REDUCE_LEAF_SIZE - 1) / REDUCE_LEAF_SIZE; block * REDUCE_LEAF_SIZE < end_index; ++block)
+        {
+            const double block_offset = m_block_weight_prefixes[block];
+            const int64_t first_spoke = block == 0 ? 0 : firstSpokeAbove(block_offset);
+            const int64_t end_spoke = block == num_blocks - 1 ? num_new_particles : firstSpokeAbove(m_block_weight_prefixes[block + 1]);
+            if (first_spoke == end_spoke)
+            {
+                continue;
+            }
+
+            // Rebuild the block's slice of the prefix sum on the stack and walk it like searchSpokesChunk does
+            const int64_t block_start = block * REDUCE_LEAF_SIZE;
+            const int64_t block_size = std::min(REDUCE_LEAF_SIZE, m_num_particles - block_start);
+            m_simd_kernels->prefix_sum(m_particle_weights.data() + block_start, scanned_weights, block_size);
+            int64_t index_candidate = 0;
+            for (int64_t spoke_index = first_spoke; spoke_index < end_spoke; ++spoke_index)
+            {
+                const double wheel_spoke = spoke(spoke_index);
+                while (index_candidate < block_size - 1 && scanned_weights[index_candidate] + block_offset < wheel_spoke)
+                {
+                    index_candidate += 1;
+                }
+                m_mutation_indicies[spoke_index] = block_start + index_candidate;
+            }
+        }
+    });
+}
+
+template<ParticleModel Model>
+bool ParticleFilter<Model>::needsCumulativeWeights() const
+{
+    // Metropolis and rejection only compare weights, and streaming systematic keeps per block totals instead
+    switch(m_pf_params.resampling_scheme)
+    {
+        case PF_RESAMPLING_SCHEME::SYSTEMATIC:
+        case PF_RESAMPLING_SCHEME::STRATIFIED:
+            return !m_pf_params.streaming_resample;
+        case PF_RESAMPLING_SCHEME::RESIDUAL:
+        case PF_RESAMPLING_SCHEME::MULTINOMIAL:
+            return true;
+        case PF_RESAMPLING_SCHEME::METROPOLIS:
+        case PF_RESAMPLING_SCHEME::REJECTION:
+            return false;
+    }
+    return true;
+}
+
+template<ParticleModel Model>
+void ParticleFilter<Model>::resampleResidual(const uint64_t rng_step, const int64_t num_new_particles)
+{
+    // Split N * w into whole copies and a leftover fraction
+    const double scale = static_cast<double>(num_new_particles) / m_weight_sum;
+    forEachChunk(PF_STAGE::STAGE_RESAMPLE, 0, m_num_particles, [this, scale](const int64_t start_index, const int64_t end_index)
+    {
+        for (int64_t i = start_index; i < end_index; ++i)
+        {
+            const double scaled_weight = m_particle_weights[i] * scale;
+            const double copies = std::floor(scaled_weight);
+            m_cumulative_weights_vector[i] = copies;
+            m_residual_cumulative_weights[i] = scaled_weight - copies;
+        }
+    });
+    cumulativeSum(m_cumulative_weights_vector, m_cumulative_weights_vector); // Whole numbers, so this sum is exact
+    cumulativeSum(m_residual_cumulative_weights, m_residual_cumulative_weights);
+
+    // New particle j is a copy of the first particle whose running copy count passes j
+    const int64_t num_copies = std::min(static_cast<int64_t>(m_cumulative_weights_vector.back()), num_new_particles);
+    forEachChunk(PF_STAGE::STAGE_RESAMPLE, 0, num_copies, [this](const int64_t start_index, const int64_t end_index)
+    {
+        searchSpokesChunk(m_cumulative_weights_vector, start_index, end_index, [](const int64_t spoke_index)
+        {
+            return static_cast<double>(spoke_index) + 0.5;
+        });
+    });
+
+    // The rest are spread systematically over the leftover fractions
+    const int64_t num_residual = num_new_particles - num_copies;
+    if (num_residual == 0)
+    {
+        return;
+    }
+    const double wheel_spoke_step = m_residual_cumulative_weights.back() / static_cast<double>(num_residual);
+    const double wheel_spoke_start = m_rng.uniform2(RNG_STREAM_RESAMPLE, rng_step, 0).first * wheel_spoke_step;
+    forEachChunk(PF_STAGE::STAGE_RESAMPLE, num_copies, num_new_particles, [this, num_copies, wheel_spoke_start, wheel_spoke_step](const int64_t start_index, const int64_t end_index)
+    {
+        searchSpokesChunk(m_residual_cumulative_weights, start_index, end_index, [num_copies, wheel_spoke_start, wheel_spoke_step](const int64_t spoke_index)
+        {
+            return wheel_spoke_start + wheel_spoke_step * static_cast<double>(spoke_index - num_copies);
+        });
+    });
+}
+
+template<ParticleModel Model>
+void ParticleFilter<Model>::resampleMultinomial(const uint64_t rng_step, const int64_t num_new_particles)
+{
+    // Vose's alias method. Building the table is a serial O(N) pass, the N draws after it are O(1) each and independent.
+    // m_mutation_indicies doubles as the work list, small entries stack up from the front and large ones from the back.
+    double* probability = m_cumulative_weights_vector.data();
+    int64_t* alias = m_alias_indicies.data();
+    int64_t* work_list = m_mutation_indicies.data();
+    int64_t num_small = 0;
+    int64_t num_large = 0;
+
+    const double scale = static_cast<double>(m_num_particles) / m_weight_sum;
+    for (int64_t i = 0; i < m_num_particles; ++i)
+    {
+        probability[i] = m_particle_weights[i] * scale;
+        alias[i] = i;
+        if (probability[i] < 1.0)
+        {
+            work_list[num_small++] = i;
+        }
+        else
+        {
+            work_list[m_num_particles - 1 - num_large++] = i;
+        }
+    }
+
+    while (num_small > 0 && num_large > 0)
+    {
+        const int64_t small = work_list[--num_small];
+        const int64_t large = work_list[m_num_particles - num_large--];
+        alias[small] = large;
+        probability[large] -= 1.0 - probability[small];
+        if (probability[large] < 1.0)
+        {
+            work_list[num_small++] = large;
+        }
+        else
+        {
+            work_list[m_num_particles - 1 - num_large++] = large;
+        }
+    }
+
+    // Whatever is left is only off from 1 by rounding
+    for (int64_t i = 0; i < num_small; ++i)
+    {
+        probability[work_list[i]] = 1.0;
+    }
+    for (int64_t i = 0; i < num_large; ++i)
+    {
+        probability[work_list[m_num_particles - 1 - i]] = 1.0;
+    }
+
+    forEachChunk(PF_STAGE::STAGE_RESAMPLE, 0, num_new_particles, [this, probability, alias, rng_step](const int64_t start_index, const int64_t end_index)
+    {
+        for (int64_t i = start_index; i < end_index; ++i)
+        {
+            const auto [u_column, u_alias] = m_rng.uniform2(RNG_STREAM_RESAMPLE, rng_step, i);
+            const int64_t column = uniformToIndex(u_column);
+            m_mutation_indicies[i] = u_alias < probability[column] ? column : alias[column];
+        }
+    });
+}
+
+template<ParticleModel Model>
+void ParticleFilter<Model>::resampleMetropolis(const uint64_t rng_step, const int64_t num_new_particles)
+{
+    // Murray, Lee and Jacob, "Parallel resampling in the particle filter". Every particle runs its own short
+    // Metropolis chain over the weights, only ratios are compared so there is no sum or scan.
+    // Draw b of new particle i uses counter index b * N + i.
+    const int64_t num_iterations = m_pf_params.metropolis_iterations;
+    forEachChunk(PF_STAGE::STAGE_RESAMPLE, 0, num_new_particles, [this, num_iterations, num_new_particles, rng_step](const int64_t start_index, const int64_t end_index)
+    {
+        const double* weights = m_particle_weights.data();
+        const uint64_t num_particles = static_cast<uint64_t>(num_new_particles);
+        for (int64_t i = start_index; i < end_index; ++i)
+        {
+            int64_t ancestor = i % m_num_particles;
+            for (int64_t b = 0; b < num_iterations; ++b)
+            {
+                const auto [u_proposal, u_accept] = m_rng.uniform2(RNG_STREAM_RESAMPLE, rng_step, static_cast<uint64_t>(b) * num_particles + i);
+                const int64_t proposal = uniformToIndex(u_proposal);
+                if (u_accept * weights[ancestor] < weights[proposal])
+                {
+                    ancestor = proposal;
+                }
+            }
+            m_mutation_indicies[i] = ancestor;
+        }
+    });
+}
+
+template<ParticleModel Model>
+void ParticleFilter<Model>::resampleRejection(const uint64_t rng_step, const int64_t num_new_particles)
+{
+    // Murray, Lee and Jacob again. Keep proposing until one is accepted with probability w / max(w), which is
+    // exact and only needs the max. Draw b of new particle i uses counter index b * N + i.
+    auto computeLocalMax = [this](const int64_t start_index, const int64_t end_index)
+    {
+        return *std::max_element(m_particle_weights.begin() + start_index, m_particle_weights.begin() + end_index);
+    };
+    auto combineMax = [](const double lhs, const double rhs)
+    {
+        return std::max(lhs, rhs);
+    };
+    const double max_weight = reduceChunks(PF_STAGE::STAGE_RESAMPLE, 0, m_num_particles, 0.0, computeLocalMax, combineMax);
+
+    forEachChunk(PF_STAGE::STAGE_RESAMPLE, 0, num_new_particles, [this, max_weight, num_new_particles, rng_step](const int64_t start_index, const int64_t end_index)
+    {
+        const double* weights = m_particle_weights.data();
+        const uint64_t num_particles = static_cast<uint64_t>(num_new_particles);
+        for (int64_t i = start_index; i < end_index; ++i)
+        {
+            int64_t ancestor = i % m_num_particles;
+            // Nothing can be accepted if every weight is zero, keep the particles as they are
+            for (uint64_t b = 0; max_weight > 0.0; ++b)
+            {
+                const auto [u_proposal, u_accept] = m_rng.uniform2(RNG_STREAM_RESAMPLE, rng_step, b * num_particles + i);
+                if (u_accept * max_weight < weights[ancestor])
+                {
+                    break;
+                }
+                ancestor = uniformToIndex(u_proposal);
+            }
+            m_mutation_indicies[i] = ancestor;
+        }
+    });
+}
+
+template<ParticleModel Model>
+void ParticleFilter<Model>::cumulativeSum(const AlignedArray<double>& input_vec, AlignedArray<double>& result)
+{
+    // Both paths scan each REDUCE_LEAF_SIZE block on its own with the SIMD kernel and add the running total of the
+    // blocks before it, so the result doesn't depend on the thread count. input_vec and result may be the same vector.
+    if (m_thread_plan[PF_STAGE::STAGE_SCAN].parallel)
+    {
+        parallelPrefixSum(input_vec, result);
+        return;
+    }
+
+    double block_offset = 0.0;
+    for (int64_t block_start = 0; block_start < m_num_particles; block_start += REDUCE_LEAF_SIZE)
+    {
+        const int64_t block_end = std::min(block_start + REDUCE_LEAF_SIZE, m_num_particles);
+        const double block_sum = m_simd_kernels->prefix_sum(input_vec.data() + block_start, result.data() + block_start, block_end - block_start);
+        if (block_start > 0)
+        {
+            for (int64_t i = block_start; i < block_end; i++)
+            {
+                result[i] += block_offset;
+            }
+        }
+        block_offset += block_sum;
+    }
+}
+
+template<ParticleModel Model>
+void ParticleFilter<Model>::parallelPrefixSum(const AlignedArray<double>& input_vec, AlignedArray<double>& result)
+{
+    #ifdef TRACY_ENABLE
+        ZoneScopedN("parallelPrefixSum");
+    #endif
+
+    // One pass with decoupled look-back, each block gets its offset while it's still in L1
+    auto scanBlock = [this, &input_vec, &result](const int64_t start_index, const int64_t end_index)
+    {
+        return m_simd_kernels->prefix_sum(input_vec.data() + start_index, result.data() + start_index, end_index - start_index);
+    };
+    auto addOffset = [&result](const int64_t start_index, const int64_t end_index, const double block_offset)
+    {
+        for (int64_t i = start_index; i < end_index; ++i)
+        {
+            result[i] += block_offset;
+        }
+    };
+    m_pool->parallel_scan(m_num_particles, REDUCE_LEAF_SIZE, m_scan_states, scanBlock, addOffset, std::plus<double>());
+}
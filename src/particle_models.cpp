@@ -0,0 +1,163 @@
+// Custom Non‑Commercial License
+
+// Copyright (c) 2025 Mgoodell97
+
+// Permission is hereby granted, free of charge, to any individual or
+// non‑commercial entity obtaining a copy of this software and associated
+// documentation files (the "Software"), to use, copy, modify, merge, publish,
+// and distribute the Software for personal, educational, or research purposes,
+// subject to the following conditions:
+
+// 1. Commercial Use:
+//    Any company, corporation, or organization intending to use the Software
+//    must first notify the copyright holder and obtain explicit written
+//    permission. Commercial use without such permission is strictly prohibited.
+
+// 2. Unauthorized Commercial Use:
+//    If a company is found to be using the Software without prior authorization,
+//    the copyright holder is entitled to receive 1% of the company’s gross
+//    profits moving forward, enforceable as a licensing fee.
+
+// 3. Artificial Intelligence / Machine Learning Use:
+//    If the Software is incorporated into machine learning
+//    models, neural networks, generative pre‑trained transformers (GPTs), or similar AI systems,
+//    the company deploying such use is solely responsible for compliance with
+//    this license. Responsibility cannot be shifted to the provider of training
+//    data or third‑party services.
+
+// 4. Attribution:
+//    The above copyright notice and this permission notice shall be included in
+//    all copies or substantial portions of the Software.
+
+// Disclaimer:
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <algorithm>
+
+#include "particle_models.hpp"
+
+// The sensor model runs over a small batch that stays in L1, then the likelihood runs over the batch
+constexpr int64_t SENSOR_BATCH_SIZE = 256;
+
+double DefaultModel::updateWeightsBatch(const SimdKernels& kernels, const double* xs, const double* ys, double* weights, const int64_t count,
+                                        const double observation, const double sensor_std) const
+{
+    double particle_observations[SENSOR_BATCH_SIZE];
+
+    double sum = 0.0;
+    for (int64_t batch_start = 0; batch_start < count; batch_start += SENSOR_BATCH_SIZE)
+    {
+        const int64_t batch_size = std::min(SENSOR_BATCH_SIZE, count - batch_start);
+        kernels.range_sensor(xs + batch_start, ys + batch_start, particle_observations, batch_size);
+        sum += kernels.gaussian_likelihood(particle_observations, weights + batch_start, batch_size, observation, sensor_std);
+    }
+    return sum;
+}
+
+void DefaultModel::updateLogWeightsBatch(const SimdKernels& kernels, const double* xs, const double* ys, double* log_weights, const int64_t count,
+                                         const double observation, const double sensor_std) const
+{
+    double particle_observations[SENSOR_BATCH_SIZE];
+
+    for (int64_t batch_start = 0; batch_start < count; batch_start += SENSOR_BATCH_SIZE)
+    {
+        const int64_t batch_size = std::min(SENSOR_BATCH_SIZE, count - batch_start);
+        kernels.range_sensor(xs + batch_start, ys + batch_start, particle_observations, batch_size);
+
+        // No exp to vectorize by hand here, the compiler does this one
+        for (int64_t j = 0; j < batch_size; ++j)
+        {
+            const double diff_over_sig = (observation - particle_observations[j]) / sensor_std;
+            log_weights[batch_start + j] = -0.5 * diff_over_sig * diff_over_sig;
+        }
+    }
+}
+
+void DefaultModel::propagateBatch(double* xs, double* ys, const int64_t count, const State& waypoint) const
+{
+    moveEstimatedStateBatch(xs, ys, count, waypoint);
+}
+
+FunctionModel::FunctionModel(std::function<double(const double, const double, const double)> likelihood_function,
+                             std::function<void(State&, const State&)> propagate_state_function):
+    m_likelihood_function(likelihood_function),
+    m_propagate_state_function(propagate_state_function)
+{
+    // The stock models have batched versions, see DefaultModel
+    const auto* likelihood = m_likelihood_function.target<double(*)(const double, const double, const double)>();
+    m_uses_default_likelihood = likelihood != nullptr && *likelihood == &likelihoodFunction;
+
+    const auto* motion_model = m_propagate_state_function.target<void(*)(State&, const State&)>();
+    m_uses_default_motion_model = motion_model != nullptr && *motion_model == &moveEstimatedState;
+}
+
+double FunctionModel::updateWeightsBatch(const SimdKernels& kernels, const double* xs, const double* ys, double* weights, const int64_t count,
+                                         const double observation, const double sensor_std) const
+{
+    if (m_uses_default_likelihood)
+    {
+        return DefaultModel{}.updateWeightsBatch(kernels, xs, ys, weights, count, observation, sensor_std);
+    }
+
+    double particle_observations[SENSOR_BATCH_SIZE];
+
+    double sum = 0.0;
+    for (int64_t batch_start = 0; batch_start < count; batch_start += SENSOR_BATCH_SIZE)
+    {
+        const int64_t batch_size = std::min(SENSOR_BATCH_SIZE, count - batch_start);
+        kernels.range_sensor(xs + batch_start, ys + batch_start, particle_observations, batch_size);
+
+        for (int64_t j = 0; j < batch_size; ++j)
+        {
+            weights[batch_start + j] = m_likelihood_function(observation, particle_observations[j], sensor_std);
+            sum += weights[batch_start + j];
+        }
+    }
+    return sum;
+}
+
+void FunctionModel::updateLogWeightsBatch(const SimdKernels& kernels, const double* xs, const double* ys, double* log_weights, const int64_t count,
+                                          const double observation, const double sensor_std) const
+{
+    if (m_uses_default_likelihood)
+    {
+        DefaultModel{}.updateLogWeightsBatch(kernels, xs, ys, log_weights, count, observation, sensor_std);
+        return;
+    }
+
+    double particle_observations[SENSOR_BATCH_SIZE];
+
+    for (int64_t batch_start = 0; batch_start < count; batch_start += SENSOR_BATCH_SIZE)
+    {
+        const int64_t batch_size = std::min(SENSOR_BATCH_SIZE, count - batch_start);
+        kernels.range_sensor(xs + batch_start, ys + batch_start, particle_observations, batch_size);
+
+        for (int64_t j = 0; j < batch_size; ++j)
+        {
+            log_weights[batch_start + j] = std::log(m_likelihood_function(observation, particle_observations[j], sensor_std));
+        }
+    }
+}
+
+void FunctionModel::propagateBatch(double* xs, double* ys, const int64_t count, const State& waypoint) const
+{
+    if (m_uses_default_motion_model)
+    {
+        moveEstimatedStateBatch(xs, ys, count, waypoint);
+        return;
+    }
+
+    for (int64_t i = 0; i < count; ++i)
+    {
+        State particle{xs[i], ys[i]};
+        m_propagate_state_function(particle, waypoint);
+        xs[i] = particle.x;
+        ys[i] = particle.y;
+    }
+}
@@ -0,0 +1,190 @@
+// Custom Non‑Commercial License
+
+// Copyright (c) 2025 Mgoodell97
+
+// Permission is hereby granted, free of charge, to any individual or
+// non‑commercial entity obtaining a copy of this software and associated
+// documentation files (the "Software"), to use, copy, modify, merge, publish,
+// and distribute the Software for personal, educational, or research purposes,
+// subject to the following conditions:
+
+// 1. Commercial Use:
+//    Any company, corporation, or organization intending to use the Software
+//    must first notify the copyright holder and obtain explicit written
+//    permission. Commercial use without such permission is strictly prohibited.
+
+// 2. Unauthorized Commercial Use:
+//    If a company is found to be using the Software without prior authorization,
+//    the copyright holder is entitled to receive 1% of the company’s gross
+//    profits moving forward, enforceable as a licensing fee.
+
+// 3. Artificial Intelligence / Machine Learning Use:
+//    If the Software is incorporated into machine learning
+//    models, neural networks, generative pre‑trained transformers (GPTs), or similar AI systems,
+//    the company deploying such use is solely responsible for compliance with
+//    this license. Responsibility cannot be shifted to the provider of training
+//    data or third‑party services.
+
+// 4. Attribution:
+//    The above copyright notice and this permission notice shall be included in
+//    all copies or substantial portions of the Software.
+
+// Disclaimer:
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cmath>
+#include <concepts>
+#include <cstdint>
+#include <functional>
+
+#include "state_functions.hpp"
+#include "simd_kernels.hpp"
+
+// One reading of a sensor sitting at beacon. The filter evaluates the model's sensor on each particle in the beacon's
+// frame (particle - beacon), so with the stock range sensor it's the distance from the particle to the beacon.
+// Components the beacon leaves at 0 (a heading or a velocity, say) are passed through as they are.
+template<int64_t D>
+struct BeaconReadingN
+{
+    StateN<D> beacon{};
+    double observation{0.0};
+    double sensor_std{1.0};
+};
+
+using BeaconReading = BeaconReadingN<2>;
+
+// The state a model works on, Model::StateType when it names one (a StateN<D>), otherwise the 2D State
+template<typename Model>
+struct ModelStateOf
+{
+    using type = State;
+};
+
+template<typename Model> requires requires { typename Model::StateType; }
+struct ModelStateOf<Model>
+{
+    using type = typename Model::StateType;
+};
+
+template<typename Model>
+using ModelState = typename ModelStateOf<Model>::type;
+
+// A model tells the particle filter how to simulate the sensor, score a reading and move a particle.
+// ParticleFilter<Model> calls these directly so a model defined in a header is inlined into the per particle loops.
+template<typename Model>
+concept ParticleModel = std::copy_constructible<Model> && requires(const Model& model, ModelState<Model>& state, const ModelState<Model>& waypoint, const double value)
+{
+    { model.sensor(waypoint) } -> std::convertible_to<double>;
+    { model.likelihood(value, value, value) } -> std::convertible_to<double>;
+    model.propagate(state, waypoint);
+};
+
+// Optional batched hooks over the structure of arrays storage, used instead of the per particle calls when present.
+// updateWeightsBatch writes the unnormalized weights and returns their sum. The hooks only see x and y, so they only
+// count for 2D models. A bigger model with the same hooks goes through sensor() and propagate() per particle instead.
+template<typename Model>
+concept TwoComponentModel = ModelState<Model>::DIM == 2;
+
+template<typename Model>
+concept BatchWeightModel = TwoComponentModel<Model> && requires(const Model& model, const SimdKernels& kernels, const double* xs, const double* ys, double* weights, 
+                                    const int64_t count, const double value)
+{
+    { model.updateWeightsBatch(kernels, xs, ys, weights, count, value, value) } -> std::convertible_to<double>;
+};
+
+// Optional log likelihood for pf_params.log_domain_weights. Without it the filter takes std::log of likelihood,
+// which is -inf wherever likelihood has already underflowed. updateLogWeightsBatch writes the log likelihoods.
+template<typename Model>
+concept LogLikelihoodModel = requires(const Model& model, const double value)
+{
+    { model.logLikelihood(value, value, value) } -> std::convertible_to<double>;
+};
+
+template<typename Model>
+concept BatchLogWeightModel = TwoComponentModel<Model> && requires(const Model& model, const SimdKernels& kernels, const double* xs, const double* ys, double* log_weights,
+                                       const int64_t count, const double value)
+{
+    model.updateLogWeightsBatch(kernels, xs, ys, log_weights, count, value, value);
+};
+
+template<typename Model>
+concept BatchMotionModel = TwoComponentModel<Model> && requires(const Model& model, double* xs, double* ys, const int64_t count, const State& waypoint)
+{
+    model.propagateBatch(xs, ys, count, waypoint);
+};
+
+// The stock range sensor, Gaussian likelihood and waypoint motion model from state_functions,
+// with batched versions that run on the SIMD kernels
+struct DefaultModel
+{
+    double sensor(const State& state) const { return sensorFunction(state); }
+
+    double likelihood(const double sensor_observation, const double estimate_observation, const double sensor_std) const
+    {
+        return likelihoodFunction(sensor_observation, estimate_observation, sensor_std);
+    }
+
+    double logLikelihood(const double sensor_observation, const double estimate_observation, const double sensor_std) const
+    {
+        return logLikelihoodFunction(sensor_observation, estimate_observation, sensor_std);
+    }
+
+    void propagate(State& state, const State& waypoint) const { moveEstimatedState(state, waypoint); }
+
+    double updateWeightsBatch(const SimdKernels& kernels, const double* xs, const double* ys, double* weights, const int64_t count,
+                              const double observation, const double sensor_std) const;
+    void updateLogWeightsBatch(const SimdKernels& kernels, const double* xs, const double* ys, double* log_weights, const int64_t count,
+                               const double observation, const double sensor_std) const;
+
+    void propagateBatch(double* xs, double* ys, const int64_t count, const State& waypoint) const;
+};
+
+// Type erased adapter so the filter can still be built from std::functions, at the cost of an indirect call per particle.
+// The sensor is the stock range sensor. Passing the stock likelihoodFunction or moveEstimatedState is detected
+// and gets the same batched paths as DefaultModel.
+class FunctionModel
+{
+public:
+    FunctionModel(std::function<double(const double, const double, const double)> likelihood_function,
+                  std::function<void(State&, const State&)> propagate_state_function);
+
+    double sensor(const State& state) const { return sensorFunction(state); }
+
+    double likelihood(const double sensor_observation, const double estimate_observation, const double sensor_std) const
+    {
+        return m_likelihood_function(sensor_observation, estimate_observation, sensor_std);
+    }
+
+    // Exact for the stock likelihoodFunction, otherwise the log of the std::function's result
+    double logLikelihood(const double sensor_observation, const double estimate_observation, const double sensor_std) const
+    {
+        if (m_uses_default_likelihood)
+        {
+            return logLikelihoodFunction(sensor_observation, estimate_observation, sensor_std);
+        }
+        return std::log(m_likelihood_function(sensor_observation, estimate_observation, sensor_std));
+    }
+
+    void propagate(State& state, const State& waypoint) const { m_propagate_state_function(state, waypoint); }
+
+    double updateWeightsBatch(const SimdKernels& kernels, const double* xs, const double* ys, double* weights, const int64_t count,
+                              const double observation, const double sensor_std) const;
+    void updateLogWeightsBatch(const SimdKernels& kernels, const double* xs, const double* ys, double* log_weights, const int64_t count,
+                               const double observation, const double sensor_std) const;
+
+    void propagateBatch(double* xs, double* ys, const int64_t count, const State& waypoint) const;
+
+private:
+    std::function<double(const double, const double, const double)> m_likelihood_function;
+    std::function<void(State&, const State&)> m_propagate_state_function;
+    bool m_uses_default_likelihood{false};
+    bool m_uses_default_motion_model{false};
+};
@@ -0,0 +1,226 @@
+// Custom Non‑Commercial License
+
+// Copyright (c) 2025 Mgoodell97
+
+// Permission is hereby granted, free of charge, to any individual or
+// non‑commercial entity obtaining a copy of this software and associated
+// documentation files (the "Software"), to use, copy, modify, merge, publish,
+// and distribute the Software for personal, educational, or research purposes,
+// subject to the following conditions:
+
+// 1. Commercial Use:
+//    Any company, corporation, or organization intending to use the Software
+//    must first notify the copyright holder and obtain explicit written
+//    permission. Commercial use without such permission is strictly prohibited.
+
+// 2. Unauthorized Commercial Use:
+//    If a company is found to be using the Software without prior authorization,
+//    the copyright holder is entitled to receive 1% of the company’s gross
+//    profits moving forward, enforceable as a licensing fee.
+
+// 3. Artificial Intelligence / Machine Learning Use:
+//    If the Software is incorporated into machine learning
+//    models, neural networks, generative pre‑trained transformers (GPTs), or similar AI systems,
+//    the company deploying such use is solely responsible for compliance with
+//    this license. Responsibility cannot be shifted to the provider of training
+//    data or third‑party services.
+
+// 4. Attribution:
+//    The above copyright notice and this permission notice shall be included in
+//    all copies or substantial portions of the Software.
+
+// Disclaimer:
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "state_functions.hpp"
+
+// Cache line (and AVX-512 register) aligned array of trivial values.
+// Unlike std::vector it never value initializes, and shrinking then growing again within the
+// capacity never reallocates.
+template<typename T>
+class AlignedArray
+{
+    static_assert(std::is_trivially_copyable_v<T>, "AlignedArray only holds trivial types");
+
+public:
+    static constexpr size_t ALIGNMENT = 64;
+
+    AlignedArray() = default;
+
+    explicit AlignedArray(const int64_t size)
+    {
+        resize(size);
+    }
+
+    ~AlignedArray()
+    {
+        release();
+    }
+
+    AlignedArray(const AlignedArray& other)
+    {
+        *this = other;
+    }
+
+    AlignedArray& operator=(const AlignedArray& other)
+    {
+        if (this != &other)
+        {
+            resize(other.m_size);
+            if (m_size > 0)
+            {
+                std::memcpy(m_data, other.m_data, m_size * sizeof(T));
+            }
+        }
+        return *this;
+    }
+
+    AlignedArray(AlignedArray&& other) noexcept
+    {
+        swap(other);
+    }
+
+    AlignedArray& operator=(AlignedArray&& other) noexcept
+    {
+        swap(other);
+        return *this;
+    }
+
+    void swap(AlignedArray& other) noexcept
+    {
+        std::swap(m_data, other.m_data);
+        std::swap(m_size, other.m_size);
+        std::swap(m_capacity, other.m_capacity);
+    }
+
+    // Contents are kept up to min(old size, new size), anything past that is uninitialized
+    void resize(const int64_t size)
+    {
+        if (size > m_capacity)
+        {
+            T* data = static_cast<T*>(::operator new(size * sizeof(T), std::align_val_t{ALIGNMENT}));
+            if (m_size > 0)
+            {
+                std::memcpy(data, m_data, m_size * sizeof(T));
+            }
+            release();
+            m_data = data;
+            m_capacity = size;
+        }
+        m_size = size;
+    }
+
+    int64_t size() const { return m_size; }
+    int64_t capacity() const { return m_capacity; }
+
+    T* data() { return m_data; }
+    const T* data() const { return m_data; }
+
+    T& operator[](const int64_t i) { return m_data[i]; }
+    const T& operator[](const int64_t i) const { return m_data[i]; }
+
+    T& back() { return m_data[m_size - 1]; }
+    const T& back() const { return m_data[m_size - 1]; }
+
+    T* begin() { return m_data; }
+    T* end() { return m_data + m_size; }
+    const T* begin() const { return m_data; }
+    const T* end() const { return m_data + m_size; }
+
+private:
+    void release()
+    {
+        if (m_data != nullptr)
+        {
+            ::operator delete(m_data, std::align_val_t{ALIGNMENT});
+        }
+        m_data = nullptr;
+        m_capacity = 0;
+        m_size = 0;
+    }
+
+    T* m_data{nullptr};
+    int64_t m_size{0};
+    int64_t m_capacity{0};
+};
+
+// Structure of arrays particle container, every state component lives in its own aligned array so the
+// per particle kernels stream through memory and the compiler can vectorize them.
+template<int64_t D>
+class ParticleStorageN
+{
+public:
+    static constexpr int64_t DIM = D;
+
+    ParticleStorageN() = default;
+
+    explicit ParticleStorageN(const int64_t size)
+    {
+        resize(size);
+    }
+
+    void resize(const int64_t size)
+    {
+        for (AlignedArray<double>& values : m_components)
+        {
+            values.resize(size);
+        }
+    }
+
+    int64_t size() const { return m_components[0].size(); }
+
+    double* component(const int64_t d) { return m_components[d].data(); }
+    const double* component(const int64_t d) const { return m_components[d].data(); }
+
+    // The first two components, the position for the stock sensor and the batched model hooks
+    double* xs() { return component(0); }
+    double* ys() { return component(1); }
+    const double* xs() const { return component(0); }
+    const double* ys() const { return component(1); }
+
+    StateN<D> get(const int64_t i) const
+    {
+        StateN<D> state;
+        for (int64_t d = 0; d < D; ++d)
+        {
+            state[d] = m_components[d][i];
+        }
+        return state;
+    }
+
+    void set(const int64_t i, const StateN<D>& state)
+    {
+        for (int64_t d = 0; d < D; ++d)
+        {
+            m_components[d][i] = state[d];
+        }
+    }
+
+    void swap(ParticleStorageN& other) noexcept
+    {
+        for (int64_t d = 0; d < D; ++d)
+        {
+            m_components[d].swap(other.m_components[d]);
+        }
+    }
+
+private:
+    std::array<AlignedArray<double>, D> m_components;
+};
+
+using ParticleStorage = ParticleStorageN<2>;
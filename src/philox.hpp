@@ -0,0 +1,161 @@
+// Custom Non‑Commercial License
+
+// Copyright (c) 2025 Mgoodell97
+
+// Permission is hereby granted, free of charge, to any individual or
+// non‑commercial entity obtaining a copy of this software and associated
+// documentation files (the "Software"), to use, copy, modify, merge, publish,
+// and distribute the Software for personal, educational, or research purposes,
+// subject to the following conditions:
+
+// 1. Commercial Use:
+//    Any company, corporation, or organization intending to use the Software
+//    must first notify the copyright holder and obtain explicit written
+//    permission. Commercial use without such permission is strictly prohibited.
+
+// 2. Unauthorized Commercial Use:
+//    If a company is found to be using the Software without prior authorization,
+//    the copyright holder is entitled to receive 1% of the company’s gross
+//    profits moving forward, enforceable as a licensing fee.
+
+// 3. Artificial Intelligence / Machine Learning Use:
+//    If the Software is incorporated into machine learning
+//    models, neural networks, generative pre‑trained transformers (GPTs), or similar AI systems,
+//    the company deploying such use is solely responsible for compliance with
+//    this license. Responsibility cannot be shifted to the provider of training
+//    data or third‑party services.
+
+// 4. Attribution:
+//    The above copyright notice and this permission notice shall be included in
+//    all copies or substantial portions of the Software.
+
+// Disclaimer:
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <numbers>
+#include <utility>
+
+// Philox4x32-10 counter based random number generator (Salmon et al., "Parallel Random Numbers: As Easy as 1, 2, 3").
+// Every output is a pure function of a 128 bit counter and a 64 bit key, so there is no state to seed or share
+// and any thread can jump straight to the draw it needs.
+class Philox4x32
+{
+public:
+    using Counter = std::array<uint32_t, 4>;
+    using Key = std::array<uint32_t, 2>;
+
+    static constexpr Counter generate(Counter counter, Key key)
+    {
+        for (int round = 0; round < ROUNDS; ++round)
+        {
+            if (round > 0)
+            {
+                key[0] += KEY_BUMP_0;
+                key[1] += KEY_BUMP_1;
+            }
+            const uint64_t product_0 = static_cast<uint64_t>(MULTIPLIER_0) * counter[0];
+            const uint64_t product_1 = static_cast<uint64_t>(MULTIPLIER_1) * counter[2];
+            counter = {
+                static_cast<uint32_t>(product_1 >> 32) ^ counter[1] ^ key[0],
+                static_cast<uint32_t>(product_1),
+                static_cast<uint32_t>(product_0 >> 32) ^ counter[3] ^ key[1],
+                static_cast<uint32_t>(product_0)
+            };
+        }
+        return counter;
+    }
+
+private:
+    static constexpr int ROUNDS = 10;
+    static constexpr uint32_t MULTIPLIER_0 = 0xD2511F53;
+    static constexpr uint32_t MULTIPLIER_1 = 0xCD9E8D57;
+    static constexpr uint32_t KEY_BUMP_0 = 0x9E3779B9;
+    static constexpr uint32_t KEY_BUMP_1 = 0xBB67AE85;
+};
+
+// Which part of the filter a draw is for, so stages never reuse each other's numbers
+enum RNG_STREAM : uint32_t
+{
+    RNG_STREAM_INITIALIZE,
+    RNG_STREAM_MUTATE,
+    RNG_STREAM_RESAMPLE
+};
+
+// Index offset between the pairs of draws for a state with more than two components, pair p of particle i is drawn at
+// index i + p * RNG_COMPONENT_PAIR_STRIDE. Far past any particle count, and pair 0 is the particle's own index.
+constexpr uint64_t RNG_COMPONENT_PAIR_STRIDE = uint64_t{1} << 48;
+
+// The filter's random numbers, keyed by (seed, stream, step, particle index). A particle's draws don't depend on
+// which thread or chunk handles it, so runs are reproducible for any thread count.
+class CounterRng
+{
+public:
+    explicit CounterRng(const uint64_t seed):
+        m_key{static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32)} {}
+
+    // 128 random bits, steps up to 2^56 are unique
+    Philox4x32::Counter draw(const RNG_STREAM stream, const uint64_t step, const uint64_t index) const
+    {
+        const Philox4x32::Counter counter{
+            static_cast<uint32_t>(index),
+            static_cast<uint32_t>(index >> 32),
+            static_cast<uint32_t>(step),
+            (static_cast<uint32_t>(step >> 32) & 0x00FFFFFF) | (static_cast<uint32_t>(stream) << 24)
+        };
+        return Philox4x32::generate(counter, m_key);
+    }
+
+    // Two uniforms in [0, 1)
+    std::pair<double, double> uniform2(const RNG_STREAM stream, const uint64_t step, const uint64_t index) const
+    {
+        const Philox4x32::Counter bits = draw(stream, step, index);
+        return {toUniform(bits[0], bits[1]), toUniform(bits[2], bits[3])};
+    }
+
+    // uniform2 for the particles [first_index, first_index + count), into two arrays
+    void uniformBlock(const RNG_STREAM stream, const uint64_t step, const uint64_t first_index, const int64_t count,
+                      double* uniforms_a, double* uniforms_b) const
+    {
+        for (int64_t i = 0; i < count; ++i)
+        {
+            const Philox4x32::Counter bits = draw(stream, step, first_index + static_cast<uint64_t>(i));
+            uniforms_a[i] = toUniform(bits[0], bits[1]);
+            uniforms_b[i] = toUniform(bits[2], bits[3]);
+        }
+    }
+
+    // Two independent standard normals (Box-Muller). This is the scalar reference, the filter feeds uniformBlock
+    // into the batched SimdKernels::box_muller instead.
+    std::pair<double, double> normal2(const RNG_STREAM stream, const uint64_t step, const uint64_t index) const
+    {
+        const Philox4x32::Counter bits = draw(stream, step, index);
+        const double radius = std::sqrt(-2.0 * std::log(1.0 - toUniform(bits[0], bits[1]))); // 1 - u is in (0, 1]
+        const double angle = 2.0 * std::numbers::pi * toUniform(bits[2], bits[3]);
+        return {radius * std::cos(angle), radius * std::sin(angle)};
+    }
+
+private:
+    // Top 53 bits of the 64 bit word scaled into [0, 1). There's no SSE2/AVX2 instruction for uint64 to double,
+    // so the two halves go through the exponent bits (2^52 + n is exact for n < 2^52), which lets uniformBlock vectorize.
+    static double toUniform(const uint32_t low, const uint32_t high)
+    {
+        constexpr uint64_t TWO_POW_52_BITS = 0x4330000000000000;
+        const double high_part = std::bit_cast<double>(TWO_POW_52_BITS | high) - 0x1.0p52;
+        const double low_part = std::bit_cast<double>(TWO_POW_52_BITS | (low >> 11)) - 0x1.0p52;
+        return (high_part * 0x1.0p21 + low_part) * 0x1.0p-53;
+    }
+
+    Philox4x32::Key m_key;
+};
@@ -0,0 +1,147 @@
+// Custom Non‑Commercial License
+
+// Copyright (c) 2025 Mgoodell97
+
+// Permission is hereby granted, free of charge, to any individual or
+// non‑commercial entity obtaining a copy of this software and associated
+// documentation files (the "Software"), to use, copy, modify, merge, publish,
+// and distribute the Software for personal, educational, or research purposes,
+// subject to the following conditions:
+
+// 1. Commercial Use:
+//    Any company, corporation, or organization intending to use the Software
+//    must first notify the copyright holder and obtain explicit written
+//    permission. Commercial use without such permission is strictly prohibited.
+
+// 2. Unauthorized Commercial Use:
+//    If a company is found to be using the Software without prior authorization,
+//    the copyright holder is entitled to receive 1% of the company’s gross
+//    profits moving forward, enforceable as a licensing fee.
+
+// 3. Artificial Intelligence / Machine Learning Use:
+//    If the Software is incorporated into machine learning
+//    models, neural networks, generative pre‑trained transformers (GPTs), or similar AI systems,
+//    the company deploying such use is solely responsible for compliance with
+//    this license. Responsibility cannot be shifted to the provider of training
+//    data or third‑party services.
+
+// 4. Attribution:
+//    The above copyright notice and this permission notice shall be included in
+//    all copies or substantial portions of the Software.
+
+// Disclaimer:
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cmath>
+#include <numbers>
+
+#include "simd_kernels.hpp"
+#include "state_functions.hpp"
+
+#if defined(__x86_64__) || defined(_M_X64)
+    #include "simd_kernels_impl.hpp"
+    #define PF_HAS_X86_SIMD_KERNELS
+#endif
+
+namespace
+{
+
+// The reference path, exactly what the particle filter does one particle at a time
+void scalarRangeSensor(const double* xs, const double* ys, double* observations, const int64_t count)
+{
+    sensorFunctionBatch(xs, ys, observations, count);
+}
+
+double scalarGaussianLikelihood(const double* estimate_observations, double* weights, const int64_t count,
+                                const double observation, const double sensor_std)
+{
+    double sum = 0.0;
+    for (int64_t i = 0; i < count; ++i)
+    {
+        weights[i] = likelihoodFunction(observation, estimate_observations[i], sensor_std);
+        sum += weights[i];
+    }
+    return sum;
+}
+
+void scalarExp(const double* in, double* out, const int64_t count)
+{
+    for (int64_t i = 0; i < count; ++i)
+    {
+        out[i] = std::exp(in[i]);
+    }
+}
+
+void scalarBoxMuller(const double* u_radius, const double* u_angle, double* normals_cos, double* normals_sin, const int64_t count)
+{
+    for (int64_t i = 0; i < count; ++i)
+    {
+        const double radius = std::sqrt(-2.0 * std::log(1.0 - u_radius[i]));
+        const double angle = 2.0 * std::numbers::pi * u_angle[i];
+        normals_cos[i] = radius * std::cos(angle);
+        normals_sin[i] = radius * std::sin(angle);
+    }
+}
+
+double scalarPrefixSum(const double* in, double* out, const int64_t count)
+{
+    double total = 0.0;
+    for (int64_t i = 0; i < count; ++i)
+    {
+        total += in[i];
+        out[i] = total;
+    }
+    return total;
+}
+
+const SimdKernels SCALAR_SIMD_KERNELS{SIMD_SCALAR, "scalar", &scalarRangeSensor, &scalarGaussianLikelihood, &scalarExp, &scalarBoxMuller,
+                                      &scalarPrefixSum};
+
+} // namespace
+
+SIMD_LEVEL detectSimdLevel()
+{
+#if defined(PF_HAS_X86_SIMD_KERNELS) && (defined(__GNUC__) || defined(__clang__))
+    // __builtin_cpu_supports also checks the OS saves the wider registers
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+    {
+        return SIMD_AVX512;
+    }
+    if (__builtin_cpu_supports("avx2"))
+    {
+        return SIMD_AVX2;
+    }
+    return SIMD_SSE2;
+#elif defined(PF_HAS_X86_SIMD_KERNELS)
+    return SIMD_SSE2; // Always there on x86-64
+#else
+    return SIMD_SCALAR;
+#endif
+}
+
+const SimdKernels& getSimdKernels(const SIMD_LEVEL level)
+{
+    static const SIMD_LEVEL detected_level = detectSimdLevel();
+    const SIMD_LEVEL resolved_level = (level == SIMD_AUTO || level > detected_level) ? detected_level : level;
+
+    switch (resolved_level)
+    {
+#ifdef PF_HAS_X86_SIMD_KERNELS
+        case SIMD_AVX512:
+            return AVX512_SIMD_KERNELS;
+        case SIMD_AVX2:
+            return AVX2_SIMD_KERNELS;
+        case SIMD_SSE2:
+            return SSE2_SIMD_KERNELS;
+#endif
+        default:
+            return SCALAR_SIMD_KERNELS;
+    }
+}
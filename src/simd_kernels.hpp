@@ -0,0 +1,94 @@
+// Custom Non‑Commercial License
+
+// Copyright (c) 2025 Mgoodell97
+
+// Permission is hereby granted, free of charge, to any individual or
+// non‑commercial entity obtaining a copy of this software and associated
+// documentation files (the "Software"), to use, copy, modify, merge, publish,
+// and distribute the Software for personal, educational, or research purposes,
+// subject to the following conditions:
+
+// 1. Commercial Use:
+//    Any company, corporation, or organization intending to use the Software
+//    must first notify the copyright holder and obtain explicit written
+//    permission. Commercial use without such permission is strictly prohibited.
+
+// 2. Unauthorized Commercial Use:
+//    If a company is found to be using the Software without prior authorization,
+//    the copyright holder is entitled to receive 1% of the company’s gross
+//    profits moving forward, enforceable as a licensing fee.
+
+// 3. Artificial Intelligence / Machine Learning Use:
+//    If the Software is incorporated into machine learning
+//    models, neural networks, generative pre‑trained transformers (GPTs), or similar AI systems,
+//    the company deploying such use is solely responsible for compliance with
+//    this license. Responsibility cannot be shifted to the provider of training
+//    data or third‑party services.
+
+// 4. Attribution:
+//    The above copyright notice and this permission notice shall be included in
+//    all copies or substantial portions of the Software.
+
+// Disclaimer:
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstdint>
+
+// Batched versions of the stock range sensor (sensorFunction) and Gaussian likelihood (likelihoodFunction)
+// written with SIMD intrinsics. Each instruction set gets its own translation unit built with its own -m flags
+// (simd_kernels_sse2.cpp, simd_kernels_avx2.cpp, simd_kernels_avx512.cpp) and the widest one the CPU supports
+// is picked at runtime, so one binary runs well on both old and new machines.
+//
+// All vector levels round each element exactly the same way (no FMA, same operation order, same polynomials), so
+// per-element outputs are bit identical across them. Sums and scans are not: the sum gaussian_likelihood returns
+// and prefix_sum add in lanes, so their rounding depends on the vector width. The scalar level is the reference and
+// calls the functions in state_functions and the standard library.
+
+enum SIMD_LEVEL
+{
+    SIMD_SCALAR,
+    SIMD_SSE2,
+    SIMD_AVX2,
+    SIMD_AVX512,
+    SIMD_AUTO // Widest level the CPU supports
+};
+
+struct SimdKernels
+{
+    SIMD_LEVEL level;
+    const char* name;
+
+    // observations[i] = sensorFunction({xs[i], ys[i]})
+    void (*range_sensor)(const double* xs, const double* ys, double* observations, const int64_t count);
+
+    // weights[i] = likelihoodFunction(observation, estimate_observations[i], sensor_std), returns the sum of the weights
+    double (*gaussian_likelihood)(const double* estimate_observations, double* weights, const int64_t count,
+                                  const double observation, const double sensor_std);
+
+    // out[i] = exp(in[i]), exposed on its own so the error of the vector exp can be tested.
+    // The vector levels flush results below the smallest normal double (in < -708.39) to 0.
+    void (*exp)(const double* in, double* out, const int64_t count);
+
+    // Box-Muller: normals_cos[i] = sqrt(-2 log(1 - u_radius[i])) cos(2 pi u_angle[i]) and normals_sin[i] the same with sin.
+    // Uniforms are in [0, 1), the two outputs are independent standard normals.
+    void (*box_muller)(const double* u_radius, const double* u_angle, double* normals_cos, double* normals_sin, const int64_t count);
+
+    // out[i] = in[0] + ... + in[i], returns the total. in and out may be the same array.
+    // Each vector is scanned in registers and the running total carried across, so the rounding
+    // depends on the vector width (like the sum gaussian_likelihood returns) but not on anything else.
+    double (*prefix_sum)(const double* in, double* out, const int64_t count);
+};
+
+// Widest level this CPU (and OS) supports
+SIMD_LEVEL detectSimdLevel();
+
+// Kernels for a level, a level above detectSimdLevel() falls back to the detected one
+const SimdKernels& getSimdKernels(const SIMD_LEVEL level = SIMD_AUTO);
@@ -0,0 +1,113 @@
+// Custom Non‑Commercial License
+
+// Copyright (c) 2025 Mgoodell97
+
+// Permission is hereby granted, free of charge, to any individual or
+// non‑commercial entity obtaining a copy of this software and associated
+// documentation files (the "Software"), to use, copy, modify, merge, publish,
+// and distribute the Software for personal, educational, or research purposes,
+// subject to the following conditions:
+
+// 1. Commercial Use:
+//    Any company, corporation, or organization intending to use the Software
+//    must first notify the copyright holder and obtain explicit written
+//    permission. Commercial use without such permission is strictly prohibited.
+
+// 2. Unauthorized Commercial Use:
+//    If a company is found to be using the Software without prior authorization,
+//    the copyright holder is entitled to receive 1% of the company’s gross
+//    profits moving forward, enforceable as a licensing fee.
+
+// 3. Artificial Intelligence / Machine Learning Use:
+//    If the Software is incorporated into machine learning
+//    models, neural networks, generative pre‑trained transformers (GPTs), or similar AI systems,
+//    the company deploying such use is solely responsible for compliance with
+//    this license. Responsibility cannot be shifted to the provider of training
+//    data or third‑party services.
+
+// 4. Attribution:
+//    The above copyright notice and this permission notice shall be included in
+//    all copies or substantial portions of the Software.
+
+// Disclaimer:
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// AVX2 kernels, built with -mavx2 (see CMakeLists.txt) and only called when the CPU supports it
+
+#if defined(__x86_64__) || defined(_M_X64)
+
+#include <immintrin.h>
+
+#include <cstdint>
+
+#include "simd_kernels_impl.hpp"
+
+namespace
+{
+
+// See Sse2Ops in simd_kernels_sse2.cpp for the interface
+struct Avx2Ops
+{
+    using Vec = __m256d;
+    static constexpr int64_t WIDTH = 4;
+
+    static Vec load(const double* ptr) { return _mm256_loadu_pd(ptr); }
+    static void store(double* ptr, const Vec value) { _mm256_storeu_pd(ptr, value); }
+    static Vec set1(const double value) { return _mm256_set1_pd(value); }
+    static Vec add(const Vec a, const Vec b) { return _mm256_add_pd(a, b); }
+    static Vec sub(const Vec a, const Vec b) { return _mm256_sub_pd(a, b); }
+    static Vec mul(const Vec a, const Vec b) { return _mm256_mul_pd(a, b); }
+    static Vec div(const Vec a, const Vec b) { return _mm256_div_pd(a, b); }
+    static Vec sqrt(const Vec a) { return _mm256_sqrt_pd(a); }
+    static Vec max(const Vec a, const Vec b) { return _mm256_max_pd(a, b); }
+    static Vec min(const Vec a, const Vec b) { return _mm256_min_pd(a, b); }
+    static Vec zeroWhereLess(const Vec value, const Vec x, const Vec limit) { return _mm256_andnot_pd(_mm256_cmp_pd(x, limit, _CMP_LT_OQ), value); }
+
+    // 64 bit integer lanes over the same bits, for exponent and sign tricks
+    using Bits = __m256i;
+    static Bits toBits(const Vec a) { return _mm256_castpd_si256(a); }
+    static Vec fromBits(const Bits a) { return _mm256_castsi256_pd(a); }
+    static Bits bitsSet1(const int64_t value) { return _mm256_set1_epi64x(value); }
+    static Bits bitsAdd(const Bits a, const Bits b) { return _mm256_add_epi64(a, b); }
+    static Bits bitsSub(const Bits a, const Bits b) { return _mm256_sub_epi64(a, b); }
+    static Bits bitsAnd(const Bits a, const Bits b) { return _mm256_and_si256(a, b); }
+    static Bits bitsAndNot(const Bits a, const Bits b) { return _mm256_andnot_si256(a, b); } // ~a & b
+    static Bits bitsOr(const Bits a, const Bits b) { return _mm256_or_si256(a, b); }
+    static Bits bitsXor(const Bits a, const Bits b) { return _mm256_xor_si256(a, b); }
+    template<int SHIFT> static Bits bitsShiftLeft(const Bits a) { return _mm256_slli_epi64(a, SHIFT); }
+    template<int SHIFT> static Bits bitsShiftRight(const Bits a) { return _mm256_srli_epi64(a, SHIFT); }
+
+    static double sum(const Vec a)
+    {
+        alignas(32) double lanes[WIDTH];
+        _mm256_store_pd(lanes, a);
+        return ((lanes[0] + lanes[1]) + lanes[2]) + lanes[3];
+    }
+
+    static Vec pow2n(const Vec shifted)
+    {
+        const __m256i n = _mm256_sub_epi64(_mm256_castpd_si256(shifted), _mm256_castpd_si256(_mm256_set1_pd(EXP_ROUNDING_MAGIC)));
+        return _mm256_castsi256_pd(_mm256_slli_epi64(_mm256_add_epi64(n, _mm256_set1_epi64x(1023)), 52));
+    }
+
+    // Hillis-Steele scan in two shift and add steps, shifting in zeros by one lane then by two
+    static Vec prefixSum(const Vec a)
+    {
+        const Vec shifted_one = _mm256_blend_pd(_mm256_permute4x64_pd(a, _MM_SHUFFLE(2, 1, 0, 0)), _mm256_setzero_pd(), 0b0001);
+        const Vec partial = _mm256_add_pd(a, shifted_one);
+        return _mm256_add_pd(partial, _mm256_permute2f128_pd(partial, partial, 0x08));
+    }
+    static Vec broadcastLast(const Vec a) { return _mm256_permute4x64_pd(a, _MM_SHUFFLE(3, 3, 3, 3)); }
+};
+
+} // namespace
+
+const SimdKernels AVX2_SIMD_KERNELS = makeSimdKernels<Avx2Ops>(SIMD_AVX2, "AVX2");
+
+#endif
@@ -0,0 +1,118 @@
+// Custom Non‑Commercial License
+
+// Copyright (c) 2025 Mgoodell97
+
+// Permission is hereby granted, free of charge, to any individual or
+// non‑commercial entity obtaining a copy of this software and associated
+// documentation files (the "Software"), to use, copy, modify, merge, publish,
+// and distribute the Software for personal, educational, or research purposes,
+// subject to the following conditions:
+
+// 1. Commercial Use:
+//    Any company, corporation, or organization intending to use the Software
+//    must first notify the copyright holder and obtain explicit written
+//    permission. Commercial use without such permission is strictly prohibited.
+
+// 2. Unauthorized Commercial Use:
+//    If a company is found to be using the Software without prior authorization,
+//    the copyright holder is entitled to receive 1% of the company’s gross
+//    profits moving forward, enforceable as a licensing fee.
+
+// 3. Artificial Intelligence / Machine Learning Use:
+//    If the Software is incorporated into machine learning
+//    models, neural networks, generative pre‑trained transformers (GPTs), or similar AI systems,
+//    the company deploying such use is solely responsible for compliance with
+//    this license. Responsibility cannot be shifted to the provider of training
+//    data or third‑party services.
+
+// 4. Attribution:
+//    The above copyright notice and this permission notice shall be included in
+//    all copies or substantial portions of the Software.
+
+// Disclaimer:
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// AVX-512 kernels, built with -mavx512f (see CMakeLists.txt) and only called when the CPU supports it
+
+#if defined(__x86_64__) || defined(_M_X64)
+
+#include <immintrin.h>
+
+#include <cstdint>
+
+#include "simd_kernels_impl.hpp"
+
+namespace
+{
+
+// See Sse2Ops in simd_kernels_sse2.cpp for the interface
+struct Avx512Ops
+{
+    using Vec = __m512d;
+    static constexpr int64_t WIDTH = 8;
+
+    static Vec load(const double* ptr) { return _mm512_loadu_pd(ptr); }
+    static void store(double* ptr, const Vec value) { _mm512_storeu_pd(ptr, value); }
+    static Vec set1(const double value) { return _mm512_set1_pd(value); }
+    static Vec add(const Vec a, const Vec b) { return _mm512_add_pd(a, b); }
+    static Vec sub(const Vec a, const Vec b) { return _mm512_sub_pd(a, b); }
+    static Vec mul(const Vec a, const Vec b) { return _mm512_mul_pd(a, b); }
+    static Vec div(const Vec a, const Vec b) { return _mm512_div_pd(a, b); }
+    static Vec sqrt(const Vec a) { return _mm512_sqrt_pd(a); }
+    static Vec max(const Vec a, const Vec b) { return _mm512_max_pd(a, b); }
+    static Vec min(const Vec a, const Vec b) { return _mm512_min_pd(a, b); }
+    static Vec zeroWhereLess(const Vec value, const Vec x, const Vec limit) { return _mm512_mask_mov_pd(value, _mm512_cmp_pd_mask(x, limit, _CMP_LT_OQ), _mm512_setzero_pd()); }
+
+    // 64 bit integer lanes over the same bits, for exponent and sign tricks
+    using Bits = __m512i;
+    static Bits toBits(const Vec a) { return _mm512_castpd_si512(a); }
+    static Vec fromBits(const Bits a) { return _mm512_castsi512_pd(a); }
+    static Bits bitsSet1(const int64_t value) { return _mm512_set1_epi64(value); }
+    static Bits bitsAdd(const Bits a, const Bits b) { return _mm512_add_epi64(a, b); }
+    static Bits bitsSub(const Bits a, const Bits b) { return _mm512_sub_epi64(a, b); }
+    static Bits bitsAnd(const Bits a, const Bits b) { return _mm512_and_si512(a, b); }
+    static Bits bitsAndNot(const Bits a, const Bits b) { return _mm512_andnot_si512(a, b); } // ~a & b
+    static Bits bitsOr(const Bits a, const Bits b) { return _mm512_or_si512(a, b); }
+    static Bits bitsXor(const Bits a, const Bits b) { return _mm512_xor_si512(a, b); }
+    template<int SHIFT> static Bits bitsShiftLeft(const Bits a) { return _mm512_slli_epi64(a, SHIFT); }
+    template<int SHIFT> static Bits bitsShiftRight(const Bits a) { return _mm512_srli_epi64(a, SHIFT); }
+
+    static double sum(const Vec a)
+    {
+        alignas(64) double lanes[WIDTH];
+        _mm512_store_pd(lanes, a);
+        double total = lanes[0];
+        for (int64_t lane = 1; lane < WIDTH; ++lane)
+        {
+            total += lanes[lane];
+        }
+        return total;
+    }
+
+    static Vec pow2n(const Vec shifted)
+    {
+        const __m512i n = _mm512_sub_epi64(_mm512_castpd_si512(shifted), _mm512_castpd_si512(_mm512_set1_pd(EXP_ROUNDING_MAGIC)));
+        return _mm512_castsi512_pd(_mm512_slli_epi64(_mm512_add_epi64(n, _mm512_set1_epi64(1023)), 52));
+    }
+
+    // Hillis-Steele scan, shift and add by one, two and four lanes (the mask zeroes the lanes shifted in)
+    static Vec prefixSum(const Vec a)
+    {
+        Vec scanned = _mm512_add_pd(a, _mm512_maskz_permutexvar_pd(0xFE, _mm512_set_epi64(6, 5, 4, 3, 2, 1, 0, 0), a));
+        scanned = _mm512_add_pd(scanned, _mm512_maskz_permutexvar_pd(0xFC, _mm512_set_epi64(5, 4, 3, 2, 1, 0, 0, 0), scanned));
+        return _mm512_add_pd(scanned, _mm512_maskz_permutexvar_pd(0xF0, _mm512_set_epi64(3, 2, 1, 0, 0, 0, 0, 0), scanned));
+    }
+    static Vec broadcastLast(const Vec a) { return _mm512_permutexvar_pd(_mm512_set1_epi64(7), a); }
+};
+
+} // namespace
+
+const SimdKernels AVX512_SIMD_KERNELS = makeSimdKernels<Avx512Ops>(SIMD_AVX512, "AVX-512");
+
+#endif
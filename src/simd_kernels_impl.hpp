@@ -0,0 +1,387 @@
+// Custom Non‑Commercial License
+
+// Copyright (c) 2025 Mgoodell97
+
+// Permission is hereby granted, free of charge, to any individual or
+// non‑commercial entity obtaining a copy of this software and associated
+// documentation files (the "Software"), to use, copy, modify, merge, publish,
+// and distribute the Software for personal, educational, or research purposes,
+// subject to the following conditions:
+
+// 1. Commercial Use:
+//    Any company, corporation, or organization intending to use the Software
+//    must first notify the copyright holder and obtain explicit written
+//    permission. Commercial use without such permission is strictly prohibited.
+
+// 2. Unauthorized Commercial Use:
+//    If a company is found to be using the Software without prior authorization,
+//    the copyright holder is entitled to receive 1% of the company’s gross
+//    profits moving forward, enforceable as a licensing fee.
+
+// 3. Artificial Intelligence / Machine Learning Use:
+//    If the Software is incorporated into machine learning
+//    models, neural networks, generative pre‑trained transformers (GPTs), or similar AI systems,
+//    the company deploying such use is solely responsible for compliance with
+//    this license. Responsibility cannot be shifted to the provider of training
+//    data or third‑party services.
+
+// 4. Attribution:
+//    The above copyright notice and this permission notice shall be included in
+//    all copies or substantial portions of the Software.
+
+// Disclaimer:
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Shared kernel templates for the per instruction set translation units. Each of them defines an Ops struct wrapping
+// the intrinsics of one instruction set (see Sse2Ops in simd_kernels_sse2.cpp) and instantiates makeSimdKernels with it.
+//
+// Everything here is in an anonymous namespace on purpose. The same template built with -mavx512f in one file and
+// with plain SSE2 in another must never be merged by the linker, or an old CPU could end up running AVX-512 code.
+
+#pragma once
+
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <numbers>
+
+#include "simd_kernels.hpp"
+
+namespace
+{
+
+// exp(x) = 2^n * exp(r) with n = round(x / ln2) and |r| <= ln2 / 2
+constexpr double EXP_LOG2E = 1.4426950408889634;
+constexpr double EXP_LN2_HI = 6.93147180369123816490e-01; // Low bits are zero so n * EXP_LN2_HI is exact
+constexpr double EXP_LN2_LO = 1.90821492927058770002e-10;
+constexpr double EXP_INPUT_MIN = -708.39; // Below this the result isn't a normal double, we flush it to 0
+constexpr double EXP_INPUT_MAX = 709.0;   // Keeps 2^n finite
+constexpr double EXP_ROUNDING_MAGIC = 6755399441055744.0; // 1.5 * 2^52, adding it rounds to an integer held in the low bits
+
+// Taylor coefficients 1/k! for k = 2..13, the truncation error at |r| = ln2 / 2 is well under an ulp
+constexpr double EXP_COEFFICIENTS[] = {
+    1.0 / 2.0,
+    1.0 / 6.0,
+    1.0 / 24.0,
+    1.0 / 120.0,
+    1.0 / 720.0,
+    1.0 / 5040.0,
+    1.0 / 40320.0,
+    1.0 / 362880.0,
+    1.0 / 3628800.0,
+    1.0 / 39916800.0,
+    1.0 / 479001600.0,
+    1.0 / 6227020800.0,
+};
+constexpr int EXP_NUM_COEFFICIENTS = sizeof(EXP_COEFFICIENTS) / sizeof(EXP_COEFFICIENTS[0]);
+
+// One lane version of the Ops interface, used for the tails so they round exactly like the vector body
+struct ScalarOps
+{
+    using Vec = double;
+    static constexpr int64_t WIDTH = 1;
+
+    static Vec load(const double* ptr) { return *ptr; }
+    static void store(double* ptr, const Vec value) { *ptr = value; }
+    static Vec set1(const double value) { return value; }
+    static Vec add(const Vec a, const Vec b) { return a + b; }
+    static Vec sub(const Vec a, const Vec b) { return a - b; }
+    static Vec mul(const Vec a, const Vec b) { return a * b; }
+    static Vec div(const Vec a, const Vec b) { return a / b; }
+    static Vec sqrt(const Vec a) { return std::sqrt(a); }
+    static Vec max(const Vec a, const Vec b) { return a > b ? a : b; }
+    static Vec min(const Vec a, const Vec b) { return a < b ? a : b; }
+    static Vec zeroWhereLess(const Vec value, const Vec x, const Vec limit) { return x < limit ? 0.0 : value; }
+    static double sum(const Vec a) { return a; }
+
+    using Bits = uint64_t;
+    static Bits toBits(const Vec a) { return std::bit_cast<uint64_t>(a); }
+    static Vec fromBits(const Bits a) { return std::bit_cast<double>(a); }
+    static Bits bitsSet1(const int64_t value) { return static_cast<uint64_t>(value); }
+    static Bits bitsAdd(const Bits a, const Bits b) { return a + b; }
+    static Bits bitsSub(const Bits a, const Bits b) { return a - b; }
+    static Bits bitsAnd(const Bits a, const Bits b) { return a & b; }
+    static Bits bitsAndNot(const Bits a, const Bits b) { return ~a & b; }
+    static Bits bitsOr(const Bits a, const Bits b) { return a | b; }
+    static Bits bitsXor(const Bits a, const Bits b) { return a ^ b; }
+    template<int SHIFT> static Bits bitsShiftLeft(const Bits a) { return a << SHIFT; }
+    template<int SHIFT> static Bits bitsShiftRight(const Bits a) { return a >> SHIFT; }
+
+    // 2^n where shifted = n + EXP_ROUNDING_MAGIC
+    static Vec pow2n(const Vec shifted)
+    {
+        const int64_t n = std::bit_cast<int64_t>(shifted) - std::bit_cast<int64_t>(EXP_ROUNDING_MAGIC);
+        return std::bit_cast<double>((n + 1023) << 52);
+    }
+
+    // Inclusive prefix sum across the lanes, and the last lane in every lane
+    static Vec prefixSum(const Vec a) { return a; }
+    static Vec broadcastLast(const Vec a) { return a; }
+};
+
+template<typename Ops>
+typename Ops::Vec expKernel(const typename Ops::Vec x)
+{
+    using Vec = typename Ops::Vec;
+
+    const Vec clamped = Ops::min(Ops::max(x, Ops::set1(EXP_INPUT_MIN)), Ops::set1(EXP_INPUT_MAX));
+
+    const Vec shifted = Ops::add(Ops::mul(clamped, Ops::set1(EXP_LOG2E)), Ops::set1(EXP_ROUNDING_MAGIC));
+    const Vec n = Ops::sub(shifted, Ops::set1(EXP_ROUNDING_MAGIC));
+    const Vec r = Ops::sub(Ops::sub(clamped, Ops::mul(n, Ops::set1(EXP_LN2_HI))), Ops::mul(n, Ops::set1(EXP_LN2_LO)));
+
+    // exp(r) = 1 + r + r^2 * (1/2 + r/6 + ...), adding the 1 last keeps the rounding error to about half an ulp
+    Vec poly = Ops::set1(EXP_COEFFICIENTS[EXP_NUM_COEFFICIENTS - 1]);
+    for (int k = EXP_NUM_COEFFICIENTS - 2; k >= 0; --k)
+    {
+        poly = Ops::add(Ops::mul(poly, r), Ops::set1(EXP_COEFFICIENTS[k]));
+    }
+    const Vec exp_r = Ops::add(Ops::set1(1.0), Ops::add(r, Ops::mul(Ops::mul(r, r), poly)));
+
+    return Ops::zeroWhereLess(Ops::mul(exp_r, Ops::pow2n(shifted)), x, Ops::set1(EXP_INPUT_MIN));
+}
+
+// log(x) for positive normal x, the fdlibm/musl algorithm: x = 2^k * m with m in [sqrt(2)/2, sqrt(2)),
+// then log(m) = 2 * atanh(f / (2 + f)) with f = m - 1
+constexpr double LOG_COEFFICIENTS[] = {
+    6.666666666666735130e-01,
+    3.999999999940941908e-01,
+    2.857142874366239149e-01,
+    2.222219843214978396e-01,
+    1.818357216161805012e-01,
+    1.531383769920937332e-01,
+    1.479819860511658591e-01,
+};
+constexpr int64_t LOG_MANTISSA_SHIFT = 0x3ff0000000000000 - 0x3fe6a09e00000000; // Moves m >= sqrt(2) into the next exponent
+constexpr int64_t DOUBLE_EXPONENT_2_52 = 0x4330000000000000; // Bits of 2^52, OR-ing a small integer in gives 2^52 + integer
+
+template<typename Ops>
+typename Ops::Vec logKernel(const typename Ops::Vec x)
+{
+    using Vec = typename Ops::Vec;
+    using Bits = typename Ops::Bits;
+
+    const Bits shifted_bits = Ops::bitsAdd(Ops::toBits(x), Ops::bitsSet1(LOG_MANTISSA_SHIFT));
+    const Vec k = Ops::sub(Ops::fromBits(Ops::bitsOr(Ops::template bitsShiftRight<52>(shifted_bits), Ops::bitsSet1(DOUBLE_EXPONENT_2_52))),
+                           Ops::set1(4503599627370496.0 + 1023.0));
+    const Vec m = Ops::fromBits(Ops::bitsAdd(Ops::bitsAnd(shifted_bits, Ops::bitsSet1(0x000fffffffffffff)), Ops::bitsSet1(0x3fe6a09e00000000)));
+
+    const Vec f = Ops::sub(m, Ops::set1(1.0));
+    const Vec half_f_squared = Ops::mul(Ops::set1(0.5), Ops::mul(f, f));
+    const Vec s = Ops::div(f, Ops::add(Ops::set1(2.0), f));
+    const Vec z = Ops::mul(s, s);
+    const Vec w = Ops::mul(z, z);
+    const Vec t1 = Ops::mul(w, Ops::add(Ops::set1(LOG_COEFFICIENTS[1]), Ops::mul(w, Ops::add(Ops::set1(LOG_COEFFICIENTS[3]), 
+                                                                                              Ops::mul(w, Ops::set1(LOG_COEFFICIENTS[5]))))));
+    const Vec t2 = Ops::mul(z, Ops::add(Ops::set1(LOG_COEFFICIENTS[0]), Ops::mul(w, Ops::add(Ops::set1(LOG_COEFFICIENTS[2]), 
+                                        Ops::mul(w, Ops::add(Ops::set1(LOG_COEFFICIENTS[4]), Ops::mul(w, Ops::set1(LOG_COEFFICIENTS[6]))))))));
+    const Vec r = Ops::add(t2, t1);
+
+    // s * (hfsq + R) + k * ln2_lo - hfsq + f + k * ln2_hi, in that order
+    Vec result = Ops::mul(s, Ops::add(half_f_squared, r));
+    result = Ops::add(result, Ops::mul(k, Ops::set1(EXP_LN2_LO)));
+    result = Ops::sub(result, half_f_squared);
+    result = Ops::add(result, f);
+    return Ops::add(result, Ops::mul(k, Ops::set1(EXP_LN2_HI)));
+}
+
+// fdlibm kernel sin and cos on [-pi/4, pi/4]
+constexpr double SIN_COEFFICIENTS[] = {
+    -1.66666666666666324348e-01,
+    8.33333333332248946124e-03,
+    -1.98412698298579493134e-04,
+    2.75573137070700676789e-06,
+    -2.50507602534068634195e-08,
+    1.58969099521155010221e-10,
+};
+constexpr double COS_COEFFICIENTS[] = {
+    4.16666666666666019037e-02,
+    -1.38888888888741095749e-03,
+    2.48015872894767294178e-05,
+    -2.75573143513906633035e-07,
+    2.08757232129817482790e-09,
+    -1.13596475577881948265e-11,
+};
+
+// sin and cos of 2 * pi * turns for turns in [0, 1). Splitting off whole quarter turns is exact here
+// (multiplying by 4 and subtracting an integer), so there is no range reduction error to worry about.
+template<typename Ops>
+void sinCosTurnsKernel(const typename Ops::Vec turns, typename Ops::Vec& sin_out, typename Ops::Vec& cos_out)
+{
+    using Vec = typename Ops::Vec;
+    using Bits = typename Ops::Bits;
+
+    const Vec quarter_turns = Ops::mul(turns, Ops::set1(4.0));
+    const Vec shifted = Ops::add(quarter_turns, Ops::set1(EXP_ROUNDING_MAGIC));
+    const Vec nearest_quarter = Ops::sub(shifted, Ops::set1(EXP_ROUNDING_MAGIC));
+    const Vec theta = Ops::mul(Ops::sub(quarter_turns, nearest_quarter), Ops::set1(std::numbers::pi / 2.0)); // [-pi/4, pi/4]
+    const Vec z = Ops::mul(theta, theta);
+
+    Vec sin_poly = Ops::set1(SIN_COEFFICIENTS[5]);
+    Vec cos_poly = Ops::set1(COS_COEFFICIENTS[5]);
+    for (int k = 4; k >= 1; --k)
+    {
+        sin_poly = Ops::add(Ops::mul(sin_poly, z), Ops::set1(SIN_COEFFICIENTS[k]));
+        cos_poly = Ops::add(Ops::mul(cos_poly, z), Ops::set1(COS_COEFFICIENTS[k]));
+    }
+    cos_poly = Ops::add(Ops::mul(cos_poly, z), Ops::set1(COS_COEFFICIENTS[0]));
+
+    // sin = theta + theta^3 * (S1 + z * ...)
+    const Vec sin_theta = Ops::add(theta, Ops::mul(Ops::mul(z, theta), Ops::add(Ops::set1(SIN_COEFFICIENTS[0]), Ops::mul(z, sin_poly))));
+    // cos = w + (((1 - w) - z/2) + z^2 * (C1 + ...)) with w = 1 - z/2
+    const Vec half_z = Ops::mul(Ops::set1(0.5), z);
+    const Vec w = Ops::sub(Ops::set1(1.0), half_z);
+    const Vec cos_theta = Ops::add(w, Ops::add(Ops::sub(Ops::sub(Ops::set1(1.0), w), half_z), Ops::mul(Ops::mul(z, z), cos_poly)));
+
+    // Rotate by the quarter turns: odd quarters swap sin and cos, then the signs follow the quadrant
+    const Bits quadrant = Ops::bitsSub(Ops::toBits(shifted), Ops::toBits(Ops::set1(EXP_ROUNDING_MAGIC)));
+    const Bits swap_mask = Ops::bitsSub(Ops::bitsSet1(0), Ops::bitsAnd(quadrant, Ops::bitsSet1(1)));
+    const Bits sin_bits = Ops::bitsOr(Ops::bitsAnd(swap_mask, Ops::toBits(cos_theta)), Ops::bitsAndNot(swap_mask, Ops::toBits(sin_theta)));
+    const Bits cos_bits = Ops::bitsOr(Ops::bitsAnd(swap_mask, Ops::toBits(sin_theta)), Ops::bitsAndNot(swap_mask, Ops::toBits(cos_theta)));
+    const Bits sin_sign = Ops::template bitsShiftLeft<62>(Ops::bitsAnd(quadrant, Ops::bitsSet1(2)));
+    const Bits cos_sign = Ops::template bitsShiftLeft<62>(Ops::bitsAnd(Ops::bitsAdd(quadrant, Ops::bitsSet1(1)), Ops::bitsSet1(2)));
+    sin_out = Ops::fromBits(Ops::bitsXor(sin_bits, sin_sign));
+    cos_out = Ops::fromBits(Ops::bitsXor(cos_bits, cos_sign));
+}
+
+// Box-Muller, radius from u_radius and angle from u_angle, both uniform in [0, 1)
+template<typename Ops>
+void boxMullerPair(const typename Ops::Vec u_radius, const typename Ops::Vec u_angle, typename Ops::Vec& normal_cos, typename Ops::Vec& normal_sin)
+{
+    using Vec = typename Ops::Vec;
+
+    const Vec radius = Ops::sqrt(Ops::mul(Ops::set1(-2.0), logKernel<Ops>(Ops::sub(Ops::set1(1.0), u_radius)))); // 1 - u is in (0, 1]
+    Vec sin_angle;
+    Vec cos_angle;
+    sinCosTurnsKernel<Ops>(u_angle, sin_angle, cos_angle);
+    normal_cos = Ops::mul(radius, cos_angle);
+    normal_sin = Ops::mul(radius, sin_angle);
+}
+
+template<typename Ops>
+void boxMullerKernel(const double* u_radius, const double* u_angle, double* normals_cos, double* normals_sin, const int64_t count)
+{
+    int64_t i = 0;
+    for (; i + Ops::WIDTH <= count; i += Ops::WIDTH)
+    {
+        typename Ops::Vec normal_cos;
+        typename Ops::Vec normal_sin;
+        boxMullerPair<Ops>(Ops::load(u_radius + i), Ops::load(u_angle + i), normal_cos, normal_sin);
+        Ops::store(normals_cos + i, normal_cos);
+        Ops::store(normals_sin + i, normal_sin);
+    }
+    for (; i < count; ++i)
+    {
+        boxMullerPair<ScalarOps>(u_radius[i], u_angle[i], normals_cos[i], normals_sin[i]);
+    }
+}
+
+template<typename Ops>
+void expBatchKernel(const double* in, double* out, const int64_t count)
+{
+    int64_t i = 0;
+    for (; i + Ops::WIDTH <= count; i += Ops::WIDTH)
+    {
+        Ops::store(out + i, expKernel<Ops>(Ops::load(in + i)));
+    }
+    for (; i < count; ++i)
+    {
+        out[i] = expKernel<ScalarOps>(in[i]);
+    }
+}
+
+template<typename Ops>
+void rangeSensorKernel(const double* xs, const double* ys, double* observations, const int64_t count)
+{
+    int64_t i = 0;
+    for (; i + Ops::WIDTH <= count; i += Ops::WIDTH)
+    {
+        const typename Ops::Vec x = Ops::load(xs + i);
+        const typename Ops::Vec y = Ops::load(ys + i);
+        Ops::store(observations + i, Ops::sqrt(Ops::add(Ops::mul(x, x), Ops::mul(y, y))));
+    }
+    for (; i < count; ++i)
+    {
+        observations[i] = std::sqrt(xs[i] * xs[i] + ys[i] * ys[i]);
+    }
+}
+
+// Same operation order as likelihoodFunction so the only difference from the scalar path is the exp
+template<typename Ops>
+typename Ops::Vec gaussianLikelihood(const typename Ops::Vec observation, const typename Ops::Vec estimate_observation,
+                                     const typename Ops::Vec sensor_std)
+{
+    const typename Ops::Vec diff_over_sig = Ops::div(Ops::sub(observation, estimate_observation), sensor_std);
+    return expKernel<Ops>(Ops::mul(Ops::set1(-0.5), Ops::mul(diff_over_sig, diff_over_sig)));
+}
+
+template<typename Ops>
+double gaussianLikelihoodKernel(const double* estimate_observations, double* weights, const int64_t count,
+                                const double observation, const double sensor_std)
+{
+    using Vec = typename Ops::Vec;
+
+    const Vec observation_vec = Ops::set1(observation);
+    const Vec sensor_std_vec = Ops::set1(sensor_std);
+    Vec weight_sum = Ops::set1(0.0);
+
+    int64_t i = 0;
+    for (; i + Ops::WIDTH <= count; i += Ops::WIDTH)
+    {
+        const Vec weight = gaussianLikelihood<Ops>(observation_vec, Ops::load(estimate_observations + i), sensor_std_vec);
+        Ops::store(weights + i, weight);
+        weight_sum = Ops::add(weight_sum, weight);
+    }
+
+    double sum = Ops::sum(weight_sum);
+    for (; i < count; ++i)
+    {
+        weights[i] = gaussianLikelihood<ScalarOps>(observation, estimate_observations[i], sensor_std);
+        sum += weights[i];
+    }
+    return sum;
+}
+
+template<typename Ops>
+double prefixSumKernel(const double* in, double* out, const int64_t count)
+{
+    using Vec = typename Ops::Vec;
+
+    // The carry is the only dependency between vectors, one add and one broadcast per WIDTH elements
+    Vec carry = Ops::set1(0.0);
+    int64_t i = 0;
+    for (; i + Ops::WIDTH <= count; i += Ops::WIDTH)
+    {
+        const Vec scanned = Ops::add(Ops::prefixSum(Ops::load(in + i)), carry);
+        Ops::store(out + i, scanned);
+        carry = Ops::broadcastLast(scanned);
+    }
+
+    double total = i > 0 ? out[i - 1] : 0.0;
+    for (; i < count; ++i)
+    {
+        total += in[i];
+        out[i] = total;
+    }
+    return total;
+}
+
+template<typename Ops>
+constexpr SimdKernels makeSimdKernels(const SIMD_LEVEL level, const char* name)
+{
+    return SimdKernels{level, name, &rangeSensorKernel<Ops>, &gaussianLikelihoodKernel<Ops>, &expBatchKernel<Ops>, &boxMullerKernel<Ops>,
+                       &prefixSumKernel<Ops>};
+}
+
+} // namespace
+
+// Defined in the per instruction set files, only present on x86-64
+extern const SimdKernels SSE2_SIMD_KERNELS;
+extern const SimdKernels AVX2_SIMD_KERNELS;
+extern const SimdKernels AVX512_SIMD_KERNELS;
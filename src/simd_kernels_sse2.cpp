@@ -0,0 +1,109 @@
+// Custom Non‑Commercial License
+
+// Copyright (c) 2025 Mgoodell97
+
+// Permission is hereby granted, free of charge, to any individual or
+// non‑commercial entity obtaining a copy of this software and associated
+// documentation files (the "Software"), to use, copy, modify, merge, publish,
+// and distribute the Software for personal, educational, or research purposes,
+// subject to the following conditions:
+
+// 1. Commercial Use:
+//    Any company, corporation, or organization intending to use the Software
+//    must first notify the copyright holder and obtain explicit written
+//    permission. Commercial use without such permission is strictly prohibited.
+
+// 2. Unauthorized Commercial Use:
+//    If a company is found to be using the Software without prior authorization,
+//    the copyright holder is entitled to receive 1% of the company’s gross
+//    profits moving forward, enforceable as a licensing fee.
+
+// 3. Artificial Intelligence / Machine Learning Use:
+//    If the Software is incorporated into machine learning
+//    models, neural networks, generative pre‑trained transformers (GPTs), or similar AI systems,
+//    the company deploying such use is solely responsible for compliance with
+//    this license. Responsibility cannot be shifted to the provider of training
+//    data or third‑party services.
+
+// 4. Attribution:
+//    The above copyright notice and this permission notice shall be included in
+//    all copies or substantial portions of the Software.
+
+// Disclaimer:
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// SSE2 kernels, SSE2 is part of x86-64 so this file needs no extra compiler flags
+
+#if defined(__x86_64__) || defined(_M_X64)
+
+#include <emmintrin.h>
+
+#include <cstdint>
+
+#include "simd_kernels_impl.hpp"
+
+namespace
+{
+
+// The Ops interface the kernel templates in simd_kernels_impl.hpp are written against
+struct Sse2Ops
+{
+    using Vec = __m128d;
+    static constexpr int64_t WIDTH = 2;
+
+    static Vec load(const double* ptr) { return _mm_loadu_pd(ptr); }
+    static void store(double* ptr, const Vec value) { _mm_storeu_pd(ptr, value); }
+    static Vec set1(const double value) { return _mm_set1_pd(value); }
+    static Vec add(const Vec a, const Vec b) { return _mm_add_pd(a, b); }
+    static Vec sub(const Vec a, const Vec b) { return _mm_sub_pd(a, b); }
+    static Vec mul(const Vec a, const Vec b) { return _mm_mul_pd(a, b); }
+    static Vec div(const Vec a, const Vec b) { return _mm_div_pd(a, b); }
+    static Vec sqrt(const Vec a) { return _mm_sqrt_pd(a); }
+    static Vec max(const Vec a, const Vec b) { return _mm_max_pd(a, b); }
+    static Vec min(const Vec a, const Vec b) { return _mm_min_pd(a, b); }
+    static Vec zeroWhereLess(const Vec value, const Vec x, const Vec limit) { return _mm_andnot_pd(_mm_cmplt_pd(x, limit), value); }
+
+    // 64 bit integer lanes over the same bits, for exponent and sign tricks
+    using Bits = __m128i;
+    static Bits toBits(const Vec a) { return _mm_castpd_si128(a); }
+    static Vec fromBits(const Bits a) { return _mm_castsi128_pd(a); }
+    static Bits bitsSet1(const int64_t value) { return _mm_set1_epi64x(value); }
+    static Bits bitsAdd(const Bits a, const Bits b) { return _mm_add_epi64(a, b); }
+    static Bits bitsSub(const Bits a, const Bits b) { return _mm_sub_epi64(a, b); }
+    static Bits bitsAnd(const Bits a, const Bits b) { return _mm_and_si128(a, b); }
+    static Bits bitsAndNot(const Bits a, const Bits b) { return _mm_andnot_si128(a, b); } // ~a & b
+    static Bits bitsOr(const Bits a, const Bits b) { return _mm_or_si128(a, b); }
+    static Bits bitsXor(const Bits a, const Bits b) { return _mm_xor_si128(a, b); }
+    template<int SHIFT> static Bits bitsShiftLeft(const Bits a) { return _mm_slli_epi64(a, SHIFT); }
+    template<int SHIFT> static Bits bitsShiftRight(const Bits a) { return _mm_srli_epi64(a, SHIFT); }
+
+    // Lanes are added in order so the result doesn't depend on the register width
+    static double sum(const Vec a)
+    {
+        alignas(16) double lanes[WIDTH];
+        _mm_store_pd(lanes, a);
+        return lanes[0] + lanes[1];
+    }
+
+    static Vec pow2n(const Vec shifted)
+    {
+        const __m128i n = _mm_sub_epi64(_mm_castpd_si128(shifted), _mm_castpd_si128(_mm_set1_pd(EXP_ROUNDING_MAGIC)));
+        return _mm_castsi128_pd(_mm_slli_epi64(_mm_add_epi64(n, _mm_set1_epi64x(1023)), 52));
+    }
+
+    // Inclusive prefix sum across the lanes ([a, a + b]), and the last lane in every lane
+    static Vec prefixSum(const Vec a) { return _mm_add_pd(a, _mm_unpacklo_pd(_mm_setzero_pd(), a)); }
+    static Vec broadcastLast(const Vec a) { return _mm_unpackhi_pd(a, a); }
+};
+
+} // namespace
+
+const SimdKernels SSE2_SIMD_KERNELS = makeSimdKernels<Sse2Ops>(SIMD_SSE2, "SSE2");
+
+#endif
@@ -60,6 +60,12 @@ double likelihoodFunction(const double sensor_observation, const double estimate
     return std::exp(-0.5 * (std::pow(diff_over_sig, 2)));
 }
 
+double logLikelihoodFunction(const double sensor_observation, const double estimate_observation, const double sensor_std) 
+{
+    const double diff_over_sig = (sensor_observation - estimate_observation)/sensor_std;
+    return -0.5 * diff_over_sig * diff_over_sig;
+}
+
 // Generate a new random waypoint
 State generateWaypoint()
 {
@@ -106,3 +112,31 @@ void moveEstimatedState(State& state,const State& waypoint)
         state.y = waypoint.y;
     }
 }
+
+void sensorFunctionBatch(const double* __restrict xs, const double* __restrict ys, double* __restrict observations, const int64_t count)
+{
+    for (int64_t i = 0; i < count; ++i)
+    {
+        observations[i] = std::sqrt(xs[i] * xs[i] + ys[i] * ys[i]);
+    }
+}
+
+void moveEstimatedStateBatch(double* __restrict xs, double* __restrict ys, const int64_t count, const State& waypoint)
+{
+    const double waypoint_x = waypoint.x;
+    const double waypoint_y = waypoint.y;
+    for (int64_t i = 0; i < count; ++i)
+    {
+        const double dx = waypoint_x - xs[i];
+        const double dy = waypoint_y - ys[i];
+        const double dist = std::sqrt(dx * dx + dy * dy);
+
+        // Compute the full step unconditionally and select, dist == 0 only produces a NaN in the side we throw away.
+        // Keeping the branch this simple is what lets the compiler if-convert and vectorize the loop.
+        const double full_step_x = xs[i] + (dx / dist) * MAX_STEP_SIZE;
+        const double full_step_y = ys[i] + (dy / dist) * MAX_STEP_SIZE;
+        const bool take_full_step = dist >= MAX_STEP_SIZE;
+        xs[i] = take_full_step ? full_step_x : waypoint_x;
+        ys[i] = take_full_step ? full_step_y : waypoint_y;
+    }
+}
@@ -41,6 +41,8 @@
 #pragma once
 
 #include <random>
+#include <cstdint>
+#include <array>
 
 constexpr double X_MIN = 0.0;
 constexpr double Y_MIN = 0.0;
@@ -56,17 +58,48 @@ extern std::mt19937 rng_generator;
 extern std::uniform_real_distribution<double> x_waypoint_dist;
 extern std::uniform_real_distribution<double> y_waypoint_dist;
 
-struct State
+// A state with D components. D is a compile time constant, so loops over the components unroll and every
+// component can live in its own array (see ParticleStorageN).
+template<int64_t D>
+struct StateN
 {
+    static constexpr int64_t DIM = D;
+
+    std::array<double, D> values{};
+
+    double& operator[](const int64_t component) { return values[component]; }
+    double operator[](const int64_t component) const { return values[component]; }
+};
+
+// The 2D position the stock sensor and motion model work on, keeps its x and y names
+template<>
+struct StateN<2>
+{
+    static constexpr int64_t DIM = 2;
+
     double x;
     double y;
+
+    double& operator[](const int64_t component) { return component == 0 ? x : y; }
+    double operator[](const int64_t component) const { return component == 0 ? x : y; }
 };
 
+using State = StateN<2>;
+
+// Largest state the filter takes. Its per block scratch is DIM * 256 doubles, 16 KB at 8 so it still sits in L1.
+constexpr int64_t MAX_STATE_DIM = 8;
+
 double sensorFunction(const State& state); 
 double likelihoodFunction(const double sensor_observation, const double estimate_observation, const double sensor_std);
+double logLikelihoodFunction(const double sensor_observation, const double estimate_observation, const double sensor_std); // log of likelihoodFunction, never underflows
 
 // Generate a new random waypoint
 State generateWaypoint();
 
 void moveActualState(State& state, State& waypoint);
-void moveEstimatedState(State& state, const State& waypoint);
\ No newline at end of file
+void moveEstimatedState(State& state, const State& waypoint);
+
+// Batched versions over structure of arrays storage, written branch free so the compiler vectorizes them.
+// They give the same results as calling the per particle versions in a loop.
+void sensorFunctionBatch(const double* xs, const double* ys, double* observations, const int64_t count);
+void moveEstimatedStateBatch(double* xs, double* ys, const int64_t count, const State& waypoint);
\ No newline at end of file
@@ -0,0 +1,305 @@
+// Custom Non‑Commercial License
+
+// Copyright (c) 2025 Mgoodell97
+
+// Permission is hereby granted, free of charge, to any individual or
+// non‑commercial entity obtaining a copy of this software and associated
+// documentation files (the "Software"), to use, copy, modify, merge, publish,
+// and distribute the Software for personal, educational, or research purposes,
+// subject to the following conditions:
+
+// 1. Commercial Use:
+//    Any company, corporation, or organization intending to use the Software
+//    must first notify the copyright holder and obtain explicit written
+//    permission. Commercial use without such permission is strictly prohibited.
+
+// 2. Unauthorized Commercial Use:
+//    If a company is found to be using the Software without prior authorization,
+//    the copyright holder is entitled to receive 1% of the company’s gross
+//    profits moving forward, enforceable as a licensing fee.
+
+// 3. Artificial Intelligence / Machine Learning Use:
+//    If the Software is incorporated into machine learning
+//    models, neural networks, generative pre‑trained transformers (GPTs), or similar AI systems,
+//    the company deploying such use is solely responsible for compliance with
+//    this license. Responsibility cannot be shifted to the provider of training
+//    data or third‑party services.
+
+// 4. Attribution:
+//    The above copyright notice and this permission notice shall be included in
+//    all copies or substantial portions of the Software.
+
+// Disclaimer:
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+#include "particle_filter.hpp"
+#include "thread_pool.hpp"
+
+// Replace the global allocator for the test binary so we can count every heap allocation,
+// including the ones made on worker threads. Every form of operator new is replaced and counted, and every
+// delete frees with the matching std::free.
+static std::atomic<int64_t> g_heap_allocations{0};
+
+static void* countedAllocate(const std::size_t size) noexcept
+{
+    g_heap_allocations.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+// AlignedArray and the cache line aligned pool structures come through here, aligned_alloc wants a multiple of the alignment
+static void* countedAllocate(const std::size_t size, const std::align_val_t alignment) noexcept
+{
+    g_heap_allocations.fetch_add(1, std::memory_order_relaxed);
+    const std::size_t align = static_cast<std::size_t>(alignment);
+    return std::aligned_alloc(align, (std::max<std::size_t>(size, 1) + align - 1) / align * align);
+}
+
+void* operator new(std::size_t size)
+{
+    if (void* ptr = countedAllocate(size))
+    {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+    if (void* ptr = countedAllocate(size))
+    {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    return countedAllocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    return countedAllocate(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    if (void* ptr = countedAllocate(size, alignment))
+    {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+    if (void* ptr = countedAllocate(size, alignment))
+    {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return countedAllocate(size, alignment);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return countedAllocate(size, alignment);
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept
+{
+    std::free(ptr);
+}
+
+class AllocationParamsTests: public testing::TestWithParam<PF_THREAD_MODE> {};
+
+TEST(AllocationTests, TestAlignedArrayReallocatesOnlyPastItsCapacity)
+{
+    // The particle buffers are AlignedArrays, make sure the counter sees their aligned allocations at all
+    AlignedArray<double> values(1000);
+    const int64_t allocations_before = g_heap_allocations.load();
+    values.resize(10);
+    values.resize(1000);
+    EXPECT_EQ(g_heap_allocations.load() - allocations_before, 0);
+
+    values.resize(1001);
+    EXPECT_EQ(g_heap_allocations.load() - allocations_before, 1);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(values.data()) % AlignedArray<double>::ALIGNMENT, 0u);
+}
+
+TEST(AllocationTests, TestDetachedTasksDoNotAllocate)
+{
+    ThreadPool pool{4};
+    std::atomic<int64_t> counter{0};
+
+    // Warm up so one time allocations (thread locals, futex tables, etc) are out of the way
+    pool.AddDetachedTask([&counter]() { counter++; });
+    pool.waitUntilAllTasksFinished();
+
+    const int64_t allocations_before = g_heap_allocations.load();
+    for (int64_t i = 0; i < 100; ++i)
+    {
+        pool.AddDetachedTask([&counter](const int64_t value) { counter += value; }, 1);
+    }
+    pool.waitUntilAllTasksFinished();
+    {
+        ThreadPool::TaskGroup task_group{pool};
+        for (int64_t i = 0; i < 100; ++i)
+        {
+            task_group.AddTask([&counter]() { counter++; });
+        }
+        task_group.wait();
+    }
+    pool.parallel_for(0, 100000, 0, [&counter](const int64_t start_index, const int64_t end_index) { counter += end_index - start_index; });
+    const int64_t allocations_after = g_heap_allocations.load();
+
+    EXPECT_EQ(counter.load(), 1 + 100 + 100 + 100000);
+    EXPECT_EQ(allocations_after - allocations_before, 0);
+    EXPECT_EQ(pool.getHeapTaskAllocations(), 0);
+}
+
+TEST_P(AllocationParamsTests, TestParticleFilterStepDoesNotAllocate)
+{
+    for (const bool streaming_resample : {false, true})
+    {
+        PF_Params pf_params;
+        pf_params.num_of_particles = 10000;
+        pf_params.thread_mode = GetParam();
+        pf_params.streaming_resample = streaming_resample;
+        ParticleFilter test_pf{pf_params, &likelihoodFunction, &moveEstimatedState};
+
+        const State robot_state{10.0, 10.0};
+        const State waypoint{50.0, 50.0};
+        auto runStep = [&]()
+        {
+            test_pf.updateWeights(sensorFunction(robot_state), 2.5);
+            test_pf.getXHat();
+            test_pf.resample();
+            test_pf.mutateParticles(pf_params.particle_propogation_std);
+            test_pf.propogateState(waypoint);
+            test_pf.updateWeights(sensorFunction(robot_state), 2.5);
+            test_pf.resampleMutatePropagate(pf_params.particle_propogation_std, waypoint);
+        };
+
+        runStep(); // Warm up, scratch buffers get sized on the first step
+
+        const int64_t allocations_before = g_heap_allocations.load();
+        for (int64_t i = 0; i < 5; ++i)
+        {
+            runStep();
+        }
+        const int64_t allocations_after = g_heap_allocations.load();
+
+        EXPECT_EQ(allocations_after - allocations_before, 0) << "streaming_resample " << streaming_resample;
+    }
+}
+
+TEST_P(AllocationParamsTests, TestAdaptiveParticleCountDoesNotAllocate)
+{
+    PF_Params pf_params;
+    pf_params.num_of_particles = 10000;
+    pf_params.thread_mode = GetParam();
+    pf_params.adaptive_particle_count = true;
+    pf_params.kld_min_particles = 100;
+    ParticleFilter test_pf{pf_params, &likelihoodFunction, &moveEstimatedState};
+
+    const State robot_state{10.0, 10.0};
+    auto runStep = [&](const double sensor_std, const std::vector<double>& mutation_std)
+    {
+        test_pf.updateWeights(sensorFunction(robot_state), sensor_std);
+        test_pf.resample();
+        test_pf.mutateParticles(mutation_std);
+    };
+
+    const std::vector<double> small_mutation_std{0.01, 0.01};
+    const std::vector<double> large_mutation_std{20.0, 20.0};
+    runStep(2.5, pf_params.particle_propogation_std); // Warm up, scratch buffers get sized on the first step
+
+    // Shrink down to a converged cloud and grow back out again. Every buffer that would have to grow is an
+    // AlignedArray, which the counter sees (see TestAlignedArrayReallocatesOnlyPastItsCapacity).
+    const int64_t allocations_before = g_heap_allocations.load();
+    for (int64_t i = 0; i < 5; ++i)
+    {
+        runStep(0.01, small_mutation_std);
+    }
+    const int64_t converged_count = test_pf.getNumParticles();
+    runStep(100.0, large_mutation_std);
+    runStep(100.0, large_mutation_std);
+    const int64_t allocations_after = g_heap_allocations.load();
+
+    EXPECT_LT(converged_count, pf_params.num_of_particles);
+    EXPECT_GT(test_pf.getNumParticles(), converged_count);
+    EXPECT_EQ(allocations_after - allocations_before, 0);
+}
+
+INSTANTIATE_TEST_SUITE_P(TestMultiAndSingleThreaded, AllocationParamsTests, testing::Values(PF_THREAD_MODE::MULTI_THREADED, PF_THREAD_MODE::SINGLE_THREADED));
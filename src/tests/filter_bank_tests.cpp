@@ -0,0 +1,191 @@
+// Custom Non‑Commercial License
+
+// Copyright (c) 2025 Mgoodell97
+
+// Permission is hereby granted, free of charge, to any individual or
+// non‑commercial entity obtaining a copy of this software and associated
+// documentation files (the "Software"), to use, copy, modify, merge, publish,
+// and distribute the Software for personal, educational, or research purposes,
+// subject to the following conditions:
+
+// 1. Commercial Use:
+//    Any company, corporation, or organization intending to use the Software
+//    must first notify the copyright holder and obtain explicit written
+//    permission. Commercial use without such permission is strictly prohibited.
+
+// 2. Unauthorized Commercial Use:
+//    If a company is found to be using the Software without prior authorization,
+//    the copyright holder is entitled to receive 1% of the company’s gross
+//    profits moving forward, enforceable as a licensing fee.
+
+// 3. Artificial Intelligence / Machine Learning Use:
+//    If the Software is incorporated into machine learning
+//    models, neural networks, generative pre‑trained transformers (GPTs), or similar AI systems,
+//    the company deploying such use is solely responsible for compliance with
+//    this license. Responsibility cannot be shifted to the provider of training
+//    data or third‑party services.
+
+// 4. Attribution:
+//    The above copyright notice and this permission notice shall be included in
+//    all copies or substantial portions of the Software.
+
+// Disclaimer:
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+
+#include "filter_bank.hpp"
+
+class FilterBankTests : public testing::Test
+{
+void SetUp() override
+    {
+        m_pf_params.num_of_particles = 5000;
+        m_pf_params.particle_propogation_std = {0.1, 0.1};
+        for (int64_t k = 0; k < m_num_filters; ++k)
+        {
+            // Every robot somewhere else, heading somewhere else
+            m_robots.push_back(State{10.0 + 5.0 * k, 20.0 + 3.0 * k});
+            m_waypoints.push_back(State{50.0 - 2.0 * k, 40.0 + k});
+        }
+    }
+
+protected:
+    const int64_t m_num_filters = 7;
+    const double m_sensor_std_dev = 1.0;
+    PF_Params m_pf_params;
+    std::vector<State> m_robots;
+    std::vector<State> m_waypoints;
+
+    std::vector<double> observations() const
+    {
+        std::vector<double> readings;
+        for (const State& robot : m_robots)
+        {
+            readings.push_back(sensorFunction(robot));
+        }
+        return readings;
+    }
+};
+
+class FilterBankParamsTests: public FilterBankTests, public testing::WithParamInterface<PF_THREAD_MODE> {};
+
+TEST_P(FilterBankParamsTests, TestBankMatchesStandaloneFilters)
+{
+    m_pf_params.thread_mode = GetParam();
+    m_pf_params.parallel_grain_size = 1000; // So the bigger filters also split inside
+    FilterBank bank{m_pf_params, m_num_filters, &likelihoodFunction, &moveEstimatedState};
+    ASSERT_EQ(bank.size(), m_num_filters);
+
+    // Filter k is a single threaded filter seeded with random_seed + k, stepped on its own
+    std::vector<ParticleFilter<>> standalone;
+    for (int64_t k = 0; k < m_num_filters; ++k)
+    {
+        PF_Params params = m_pf_params;
+        params.thread_mode = PF_THREAD_MODE::SINGLE_THREADED;
+        params.random_seed = m_pf_params.random_seed + k;
+        standalone.emplace_back(params, &likelihoodFunction, &moveEstimatedState);
+    }
+
+    for (int64_t step = 0; step < 3; ++step)
+    {
+        bank.updateWeights(observations(), m_sensor_std_dev);
+        bank.resampleMutatePropagate(m_pf_params.particle_propogation_std, m_waypoints);
+        for (int64_t k = 0; k < m_num_filters; ++k)
+        {
+            standalone[k].updateWeights(observations()[k], m_sensor_std_dev);
+            standalone[k].resampleMutatePropagate(m_pf_params.particle_propogation_std, m_waypoints[k]);
+        }
+    }
+
+    const std::vector<State> estimates = bank.getXHats();
+    for (int64_t k = 0; k < m_num_filters; ++k)
+    {
+        const ParticleStorage& bank_particles = bank[k].getParticles();
+        const ParticleStorage& expected_particles = standalone[k].getParticles();
+        ASSERT_TRUE(std::equal(bank_particles.xs(), bank_particles.xs() + m_pf_params.num_of_particles, expected_particles.xs()));
+        ASSERT_TRUE(std::equal(bank_particles.ys(), bank_particles.ys() + m_pf_params.num_of_particles, expected_particles.ys()));
+        EXPECT_EQ(estimates[k].x, standalone[k].getXHat().x);
+        EXPECT_EQ(estimates[k].y, standalone[k].getXHat().y);
+    }
+
+    // Different seeds, different clouds
+    EXPECT_NE(bank[0].getParticles().xs()[0], bank[1].getParticles().xs()[0]);
+}
+
+TEST_P(FilterBankParamsTests, TestSeparateStagesMatchFusedStep)
+{
+    m_pf_params.thread_mode = GetParam();
+    FilterBank separate{m_pf_params, m_num_filters, &likelihoodFunction, &moveEstimatedState};
+    FilterBank fused{m_pf_params, m_num_filters, &likelihoodFunction, &moveEstimatedState};
+
+    separate.updateWeights(observations(), m_sensor_std_dev);
+    separate.resample();
+    separate.mutateParticles(m_pf_params.particle_propogation_std);
+    separate.propogateState(m_waypoints);
+
+    fused.updateWeights(observations(), m_sensor_std_dev);
+    fused.resampleMutatePropagate(m_pf_params.particle_propogation_std, m_waypoints);
+
+    const std::vector<State> separate_estimates = separate.getXHats();
+    const std::vector<State> fused_estimates = fused.getXHats();
+    for (int64_t k = 0; k < m_num_filters; ++k)
+    {
+        EXPECT_NEAR(separate_estimates[k].x, fused_estimates[k].x, 1e-9);
+        EXPECT_NEAR(separate_estimates[k].y, fused_estimates[k].y, 1e-9);
+    }
+}
+
+TEST_F(FilterBankTests, TestBankConvergesOnEveryRobot)
+{
+    m_pf_params.num_of_particles = 20000;
+    FilterBank bank{m_pf_params, m_num_filters, &likelihoodFunction, &moveEstimatedState};
+
+    // Robots stand still and a single range reading only pins a particle to the circle around the sensor, so check
+    // that each filter's cloud collapsed onto its own robot's circle
+    for (int64_t step = 0; step < 10; ++step)
+    {
+        bank.updateWeights(observations(), m_sensor_std_dev);
+        bank.resample();
+        bank.mutateParticles(m_pf_params.particle_propogation_std);
+    }
+    for (int64_t k = 0; k < m_num_filters; ++k)
+    {
+        const ParticleStorage& particles = bank[k].getParticles();
+        int64_t on_circle = 0;
+        for (int64_t i = 0; i < bank[k].getNumParticles(); ++i)
+        {
+            on_circle += std::abs(sensorFunction(particles.get(i)) - observations()[k]) < 3.0 * m_sensor_std_dev;
+        }
+        EXPECT_GT(on_circle, bank[k].getNumParticles() * 9 / 10) << "filter " << k;
+    }
+}
+
+TEST_F(FilterBankTests, TestFiltersShareTheInjectedPool)
+{
+    auto pool = std::make_shared<ThreadPool>(2);
+    m_pf_params.thread_pool = pool;
+    FilterBank bank{m_pf_params, m_num_filters, &likelihoodFunction, &moveEstimatedState};
+    EXPECT_EQ(bank.getPool(), pool);
+    for (int64_t k = 0; k < m_num_filters; ++k)
+    {
+        EXPECT_EQ(bank[k].getPool(), pool);
+    }
+    bank.initialize();
+    bank.updateWeights(observations(), m_sensor_std_dev);
+    bank.resample();
+
+    m_pf_params.thread_mode = PF_THREAD_MODE::SINGLE_THREADED;
+    FilterBank single_threaded{m_pf_params, 2, &likelihoodFunction, &moveEstimatedState};
+    EXPECT_EQ(single_threaded.getPool(), nullptr);
+}
+
+INSTANTIATE_TEST_SUITE_P(TestSingleAndMultiThreaded, FilterBankParamsTests, testing::Values(PF_THREAD_MODE::SINGLE_THREADED, PF_THREAD_MODE::MULTI_THREADED, PF_THREAD_MODE::AUTO));
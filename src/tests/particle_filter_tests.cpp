@@ -40,8 +40,12 @@
 
 #include <gtest/gtest.h>
 #include <fstream>
+#include <limits>
+#ifdef __linux__
+#include <sched.h>
+#endif
 
-#include "particle_filter.hpp"
+#include "particle_filter_impl.hpp"
 #include "helper_functions.hpp"
 
 class ParticleFilterTests : public testing::Test 
@@ -49,6 +53,7 @@ class ParticleFilterTests : public testing::Test
 void SetUp() override 
     {
         m_pf_params.num_of_particles = 100000;
+        m_pf_params.thread_pool = sharedPool(); // Ignored by the single threaded tests
         m_pf_params.starting_state_lower_bound = {X_MIN, Y_MIN};
         m_pf_params.starting_state_upper_bound = {X_MAX, Y_MAX};
         m_pf_params.particle_propogation_std = {0.1, 0.1};
@@ -59,6 +64,13 @@ void SetUp() override
     }
 
 protected: 
+    // One pool for every multithreaded filter in the suite instead of starting and joining one per filter
+    static std::shared_ptr<ThreadPool> sharedPool()
+    {
+        static const std::shared_ptr<ThreadPool> pool = makeThreadPool(PF_Params{});
+        return pool;
+    }
+
     const int64_t m_resamples = 50;
     PF_Params m_pf_params;
     const double m_sensor_std_dev = 0.001; // Very accurate sensor
@@ -71,6 +83,41 @@ protected:
 };
 
 class ParticleFilterParamsTests: public ParticleFilterTests, public testing::WithParamInterface<PF_THREAD_MODE> {};
+class ResamplingSchemeTests: public ParticleFilterTests, public testing::WithParamInterface<PF_RESAMPLING_SCHEME> {};
+
+// Same maths as the stock models but written inline, so ParticleFilter<InlineRangeModel> has nothing left to resolve at runtime
+struct InlineRangeModel
+{
+    double sensor(const State& state) const
+    {
+        return std::sqrt(state.x * state.x + state.y * state.y);
+    }
+
+    double likelihood(const double sensor_observation, const double estimate_observation, const double sensor_std) const
+    {
+        const double diff_over_sig = (sensor_observation - estimate_observation) / sensor_std;
+        return std::exp(-0.5 * diff_over_sig * diff_over_sig);
+    }
+
+    void propagate(State& state, const State& waypoint) const
+    {
+        moveEstimatedState(state, waypoint);
+    }
+};
+// Weight 1 left of the "observed" x and 0 right of it, so the effective sample size is just a count
+struct HalfPlaneModel
+{
+    double sensor(const State& state) const { return state.x; }
+    double likelihood(const double sensor_observation, const double estimate_observation, const double) const
+    {
+        return estimate_observation < sensor_observation ? 1.0 : 0.0;
+    }
+    void propagate(State&, const State&) const {}
+};
+
+static_assert(ParticleModel<InlineRangeModel>);
+static_assert(!BatchWeightModel<InlineRangeModel> && !BatchMotionModel<InlineRangeModel>);
+static_assert(BatchWeightModel<DefaultModel> && BatchMotionModel<DefaultModel>);
 
 TEST_F(ParticleFilterTests, TestConstructionAndInitalization) 
 {
@@ -78,6 +125,133 @@ TEST_F(ParticleFilterTests, TestConstructionAndInitalization)
     ParticleFilter test_pf = ParticleFilter{m_pf_params, &likelihoodFunction, &moveEstimatedState};
 }
 
+TEST_F(ParticleFilterTests, TestThreadSettingsPickThePool)
+{
+    m_pf_params.num_of_particles = 10000;
+    m_pf_params.thread_mode = PF_THREAD_MODE::MULTI_THREADED;
+
+    // A supplied pool is used as is, and the chunks follow its size, not the machine's
+    auto pool = std::make_shared<ThreadPool>(2);
+    m_pf_params.thread_pool = pool;
+    ParticleFilter shared_pf = ParticleFilter{m_pf_params, &likelihoodFunction, &moveEstimatedState};
+    EXPECT_EQ(shared_pf.getPool(), pool);
+    m_pf_params.thread_mode = PF_THREAD_MODE::SINGLE_THREADED;
+    ParticleFilter single_pf = ParticleFilter{m_pf_params, &likelihoodFunction, &moveEstimatedState};
+    EXPECT_EQ(single_pf.getPool(), nullptr);
+    for (ParticleFilter<>* pf : {&shared_pf, &single_pf})
+    {
+        pf->updateWeights(sensorFunction(m_gt_robot_state), 1.0);
+        pf->resampleMutatePropagate(m_pf_params.particle_propogation_std, m_waypoint);
+    }
+    EXPECT_TRUE(std::equal(shared_pf.getParticles().xs(), shared_pf.getParticles().xs() + m_pf_params.num_of_particles, single_pf.getParticles().xs()));
+
+    // Otherwise num_threads sizes a new one
+    m_pf_params.thread_mode = PF_THREAD_MODE::MULTI_THREADED;
+    m_pf_params.thread_pool = nullptr;
+    m_pf_params.num_threads = 3;
+    ParticleFilter sized_pf = ParticleFilter{m_pf_params, &likelihoodFunction, &moveEstimatedState};
+    EXPECT_EQ(sized_pf.getPool()->getNumberOfThreads(), 3);
+
+    // And a CPU set defaults to one worker per CPU, pinned there
+#ifdef __linux__
+    const std::vector<int> cpus = ThreadPool::availableCpus();
+    ASSERT_FALSE(cpus.empty());
+    m_pf_params.num_threads = 0;
+    m_pf_params.worker_cpus = {cpus.back()};
+    ParticleFilter pinned_pf = ParticleFilter{m_pf_params, &likelihoodFunction, &moveEstimatedState};
+    ASSERT_EQ(pinned_pf.getPool()->getNumberOfThreads(), 1);
+    int worker_cpu = -1;
+    pinned_pf.getPool()->AddTask([&worker_cpu]() { worker_cpu = sched_getcpu(); }).wait();
+    EXPECT_EQ(worker_cpu, cpus.back());
+#endif
+}
+
+TEST_F(ParticleFilterTests, TestAutoThreadModeMatchesSingleThreaded)
+{
+    m_pf_params.num_of_particles = 20000;
+    m_pf_params.thread_plan_file = std::filesystem::path("results") / "test_thread_plan.txt";
+    std::filesystem::remove(m_pf_params.thread_plan_file);
+
+    m_pf_params.thread_mode = PF_THREAD_MODE::AUTO;
+    ParticleFilter auto_pf = ParticleFilter{m_pf_params, &likelihoodFunction, &moveEstimatedState};
+    m_pf_params.thread_mode = PF_THREAD_MODE::SINGLE_THREADED;
+    ParticleFilter single_pf = ParticleFilter{m_pf_params, &likelihoodFunction, &moveEstimatedState};
+
+    // Calibrated, saved and printable, every stage was timed
+    const PF_ThreadPlan& plan = auto_pf.getThreadPlan();
+    EXPECT_EQ(plan.num_particles, m_pf_params.num_of_particles);
+    EXPECT_EQ(plan.num_threads, auto_pf.getPool()->getNumberOfThreads());
+    for (int stage = 0; stage < NUM_PF_STAGES; ++stage)
+    {
+        EXPECT_GT(plan.stages[stage].time_us, 0.0) << stageName(static_cast<PF_STAGE>(stage));
+        EXPECT_NE(plan.toString().find(stageName(static_cast<PF_STAGE>(stage))), std::string::npos);
+    }
+    ASSERT_TRUE(std::filesystem::exists(m_pf_params.thread_plan_file));
+
+    // Calibrating ran every stage, but the filter is back to the freshly constructed one and then steps the same
+    for (int64_t step = 0; step < 3; ++step)
+    {
+        for (ParticleFilter<>* pf : {&auto_pf, &single_pf})
+        {
+            pf->updateWeights(sensorFunction(m_gt_robot_state), 1.0);
+            pf->resampleMutatePropagate(m_pf_params.particle_propogation_std, m_waypoint);
+        }
+        ASSERT_TRUE(std::equal(auto_pf.getParticles().xs(), auto_pf.getParticles().xs() + m_pf_params.num_of_particles, single_pf.getParticles().xs()));
+        ASSERT_TRUE(std::equal(auto_pf.getParticles().ys(), auto_pf.getParticles().ys() + m_pf_params.num_of_particles, single_pf.getParticles().ys()));
+    }
+
+    // The next filter of the same size loads the plan instead of timing again
+    m_pf_params.thread_mode = PF_THREAD_MODE::AUTO;
+    ParticleFilter cached_pf = ParticleFilter{m_pf_params, &likelihoodFunction, &moveEstimatedState};
+    for (int stage = 0; stage < NUM_PF_STAGES; ++stage)
+    {
+        EXPECT_EQ(cached_pf.getThreadPlan().stages[stage].parallel, plan.stages[stage].parallel);
+        EXPECT_EQ(cached_pf.getThreadPlan().stages[stage].grain_size, plan.stages[stage].grain_size);
+        EXPECT_EQ(cached_pf.getThreadPlan().stages[stage].time_us, plan.stages[stage].time_us);
+    }
+
+    // A different size doesn't trust it, recalibrates and overwrites it
+    m_pf_params.num_of_particles = 5000;
+    ParticleFilter resized_pf = ParticleFilter{m_pf_params, &likelihoodFunction, &moveEstimatedState};
+    EXPECT_EQ(resized_pf.getThreadPlan().num_particles, 5000);
+    PF_ThreadPlan saved_plan;
+    ASSERT_TRUE(saved_plan.loadFromFile(m_pf_params.thread_plan_file));
+    EXPECT_EQ(saved_plan.num_particles, 5000);
+
+    // So does a setting that changes what a stage runs
+    m_pf_params.log_domain_weights = true;
+    ParticleFilter log_pf = ParticleFilter{m_pf_params, &likelihoodFunction, &moveEstimatedState};
+    EXPECT_TRUE(log_pf.getThreadPlan().log_domain_weights);
+    ASSERT_TRUE(saved_plan.loadFromFile(m_pf_params.thread_plan_file));
+    EXPECT_TRUE(saved_plan.log_domain_weights);
+    EXPECT_TRUE(saved_plan.sameSetupAs(log_pf.getThreadPlan()));
+    EXPECT_FALSE(saved_plan.sameSetupAs(resized_pf.getThreadPlan()));
+
+    // Cleanup
+    std::filesystem::remove(m_pf_params.thread_plan_file);
+}
+
+TEST_F(ParticleFilterTests, TestParallelInitializeMatchesSerial)
+{
+    m_pf_params.num_of_particles = 100003;
+    m_pf_params.thread_mode = PF_THREAD_MODE::MULTI_THREADED;
+    m_pf_params.parallel_grain_size = 777;
+    m_pf_params.thread_pool = nullptr; // Its own pool, pinned
+    m_pf_params.pin_threads = true;
+    ParticleFilter test_pf = ParticleFilter{m_pf_params, &likelihoodFunction, &moveEstimatedState};
+
+    // Particle i is still drawn from counter i of the initialize stream, whichever worker drew it
+    const CounterRng rng{m_pf_params.random_seed};
+    const ParticleStorage& particles = test_pf.getParticles();
+    for (int64_t i = 0; i < m_pf_params.num_of_particles; i++)
+    {
+        const auto [u_x, u_y] = rng.uniform2(RNG_STREAM_INITIALIZE, 0, i);
+        ASSERT_EQ(particles.xs()[i], X_MIN + u_x * (X_MAX - X_MIN));
+        ASSERT_EQ(particles.ys()[i], Y_MIN + u_y * (Y_MAX - Y_MIN));
+    }
+    EXPECT_TRUE(test_pf.hasUniformWeights());
+}
+
 TEST_F(ParticleFilterTests, TestSaveParticleStatesToFile)
 {
     bool run_pf_in_parallel = true;
@@ -254,4 +428,625 @@ TEST_P(ParticleFilterParamsTests, TestFullParticleFilterLoop)
     }
 }
 
-INSTANTIATE_TEST_SUITE_P(TestMultiAndSingleThreaded, ParticleFilterParamsTests, testing::Values(PF_THREAD_MODE::MULTI_THREADED,PF_THREAD_MODE::SINGLE_THREADED));
+TEST_P(ParticleFilterParamsTests, TestFullParticleFilterLoopWithCompileTimeModel)
+{
+    PF_THREAD_MODE run_pf_in_parallel = GetParam();
+    m_pf_params.thread_mode = run_pf_in_parallel;
+
+    double expected_error = 0.0;
+    ParticleFilter<InlineRangeModel> test_pf{m_pf_params};
+    for (uint16_t i=0; i<m_resamples;i++)
+    {
+        test_pf.updateWeights(sensorFunction(m_gt_robot_state), m_sensor_std_dev);
+        State estimate = test_pf.getXHat();
+        double l2_error = calculateError(estimate, m_gt_robot_state);
+
+        double error_threshold = m_error_thresholds[floor(i/10)];
+        EXPECT_NEAR(l2_error, expected_error, error_threshold);
+
+        test_pf.propogateState({m_waypoint});
+        moveEstimatedState(m_gt_robot_state, m_waypoint);
+
+        test_pf.resample();
+        test_pf.mutateParticles(m_pf_params.particle_propogation_std);
+    }
+}
+
+TEST_P(ParticleFilterParamsTests, TestDefaultModelMatchesStockFunctions)
+{
+    PF_THREAD_MODE run_pf_in_parallel = GetParam();
+    m_pf_params.thread_mode = run_pf_in_parallel;
+
+    // Both start from the same default seeded particles and the stock functions take the same batched paths
+    ParticleFilter function_pf = ParticleFilter{m_pf_params, &likelihoodFunction, &moveEstimatedState};
+    ParticleFilter default_pf = ParticleFilter{m_pf_params, DefaultModel{}};
+
+    function_pf.updateWeights(sensorFunction(m_gt_robot_state), m_sensor_std_dev);
+    default_pf.updateWeights(sensorFunction(m_gt_robot_state), m_sensor_std_dev);
+    function_pf.propogateState(m_waypoint);
+    default_pf.propogateState(m_waypoint);
+
+    const State function_estimate = function_pf.getXHat();
+    const State default_estimate = default_pf.getXHat();
+    EXPECT_DOUBLE_EQ(function_estimate.x, default_estimate.x);
+    EXPECT_DOUBLE_EQ(function_estimate.y, default_estimate.y);
+}
+
+TEST_P(ParticleFilterParamsTests, TestSameSeedGivesSameTrajectory)
+{
+    PF_THREAD_MODE run_pf_in_parallel = GetParam();
+    m_pf_params.thread_mode = run_pf_in_parallel;
+    m_pf_params.num_of_particles = 10000;
+
+    ParticleFilter first_pf = ParticleFilter{m_pf_params, &likelihoodFunction, &moveEstimatedState};
+    ParticleFilter second_pf = ParticleFilter{m_pf_params, &likelihoodFunction, &moveEstimatedState};
+    m_pf_params.random_seed += 1;
+    ParticleFilter other_seed_pf = ParticleFilter{m_pf_params, &likelihoodFunction, &moveEstimatedState};
+
+    for (uint16_t i = 0; i < 10; i++)
+    {
+        for (auto* pf : {&first_pf, &second_pf, &other_seed_pf})
+        {
+            pf->updateWeights(sensorFunction(m_gt_robot_state), 1.0);
+            pf->resample();
+            pf->mutateParticles(m_pf_params.particle_propogation_std);
+            pf->propogateState(m_waypoint);
+        }
+        moveEstimatedState(m_gt_robot_state, m_waypoint);
+    }
+
+    const ParticleStorage& first = first_pf.getParticles();
+    const ParticleStorage& second = second_pf.getParticles();
+    const ParticleStorage& other_seed = other_seed_pf.getParticles();
+    int64_t num_different_from_other_seed = 0;
+    for (int64_t i = 0; i < first.size(); i++)
+    {
+        ASSERT_EQ(first.xs()[i], second.xs()[i]);
+        ASSERT_EQ(first.ys()[i], second.ys()[i]);
+        num_different_from_other_seed += first.xs()[i] != other_seed.xs()[i];
+    }
+    EXPECT_GT(num_different_from_other_seed, first.size() / 2);
+
+    // Re-initializing replays the same random numbers
+    ParticleFilter fresh_pf = ParticleFilter{m_pf_params, &likelihoodFunction, &moveEstimatedState};
+    other_seed_pf.initialize();
+    for (int64_t i = 0; i < first.size(); i++)
+    {
+        ASSERT_EQ(other_seed_pf.getParticles().xs()[i], fresh_pf.getParticles().xs()[i]);
+    }
+}
+
+TEST_F(ParticleFilterTests, TestMutationDoesNotDependOnChunking)
+{
+    m_pf_params.num_of_particles = 10007;
+
+    std::vector<PF_Params> all_params;
+    m_pf_params.thread_mode = PF_THREAD_MODE::SINGLE_THREADED;
+    all_params.push_back(m_pf_params);
+    m_pf_params.thread_mode = PF_THREAD_MODE::MULTI_THREADED;
+    for (const int64_t grain_size : {0, 1, 1000, 4096})
+    {
+        m_pf_params.parallel_grain_size = grain_size;
+        all_params.push_back(m_pf_params);
+    }
+
+    ParticleFilter reference_pf = ParticleFilter{all_params[0], &likelihoodFunction, &moveEstimatedState};
+    reference_pf.mutateParticles(m_pf_params.particle_propogation_std);
+    reference_pf.mutateParticles(m_pf_params.particle_propogation_std);
+
+    for (const PF_Params& params : all_params)
+    {
+        ParticleFilter test_pf = ParticleFilter{params, &likelihoodFunction, &moveEstimatedState};
+        test_pf.mutateParticles(m_pf_params.particle_propogation_std);
+        test_pf.mutateParticles(m_pf_params.particle_propogation_std);
+        for (int64_t i = 0; i < params.num_of_particles; i++)
+        {
+            ASSERT_EQ(test_pf.getParticles().xs()[i], reference_pf.getParticles().xs()[i]);
+            ASSERT_EQ(test_pf.getParticles().ys()[i], reference_pf.getParticles().ys()[i]);
+        }
+    }
+}
+
+TEST_P(ParticleFilterParamsTests, TestResampleSwapsBuffersAndMarksWeightsUniform)
+{
+    PF_THREAD_MODE run_pf_in_parallel = GetParam();
+    m_pf_params.thread_mode = run_pf_in_parallel;
+    m_pf_params.num_of_particles = 10000;
+
+    ParticleFilter test_pf = ParticleFilter{m_pf_params, &likelihoodFunction, &moveEstimatedState};
+    EXPECT_TRUE(test_pf.hasUniformWeights());
+
+    // Uniform weights, the estimate is the plain mean of the particles
+    State mean{0.0, 0.0};
+    for (int64_t i = 0; i < test_pf.getParticles().size(); i++)
+    {
+        mean.x += test_pf.getParticles().xs()[i];
+        mean.y += test_pf.getParticles().ys()[i];
+    }
+    const State estimate = test_pf.getXHat();
+    EXPECT_NEAR(estimate.x, mean.x / m_pf_params.num_of_particles, 1e-9);
+    EXPECT_NEAR(estimate.y, mean.y / m_pf_params.num_of_particles, 1e-9);
+
+    // Resampling equal weights keeps every particle where it is and doesn't touch the buffers
+    const double* initial_xs = test_pf.getParticles().xs();
+    test_pf.resample();
+    EXPECT_EQ(test_pf.getParticles().xs(), initial_xs);
+
+    // After a weighted resample the filter reads from the other buffer and the weights are uniform again
+    test_pf.updateWeights(sensorFunction(m_gt_robot_state), m_sensor_std_dev);
+    EXPECT_FALSE(test_pf.hasUniformWeights());
+    test_pf.resample();
+    EXPECT_TRUE(test_pf.hasUniformWeights());
+    const double* resampled_xs = test_pf.getParticles().xs();
+    EXPECT_NE(resampled_xs, initial_xs);
+
+    test_pf.updateWeights(sensorFunction(m_gt_robot_state), m_sensor_std_dev);
+    test_pf.resample();
+    EXPECT_EQ(test_pf.getParticles().xs(), initial_xs);
+}
+
+TEST_P(ParticleFilterParamsTests, TestEffectiveSampleSizeAndSkippedResample)
+{
+    PF_THREAD_MODE run_pf_in_parallel = GetParam();
+    m_pf_params.thread_mode = run_pf_in_parallel;
+    m_pf_params.num_of_particles = 10000;
+    m_pf_params.resample_ess_threshold = 0.5;
+
+    ParticleFilter<HalfPlaneModel> test_pf{m_pf_params};
+    EXPECT_EQ(test_pf.getEffectiveSampleSize(), m_pf_params.num_of_particles);
+
+    auto countLeftOf = [&test_pf](const double x)
+    {
+        int64_t count = 0;
+        for (int64_t i = 0; i < test_pf.getParticles().size(); i++)
+        {
+            count += test_pf.getParticles().xs()[i] < x;
+        }
+        return count;
+    };
+
+    // About 3/4 of the particles keep their weight, that's healthy enough to skip resampling
+    const double* initial_xs = test_pf.getParticles().xs();
+    test_pf.updateWeights(75.0, 1.0);
+    EXPECT_NEAR(test_pf.getEffectiveSampleSize(), countLeftOf(75.0), 1e-6);
+    test_pf.resample();
+    EXPECT_FALSE(test_pf.hasUniformWeights());
+    EXPECT_EQ(test_pf.getParticles().xs(), initial_xs);
+
+    // The next update multiplies into the carried weights, only particles left of both cuts survive
+    test_pf.updateWeights(60.0, 1.0);
+    EXPECT_NEAR(test_pf.getEffectiveSampleSize(), countLeftOf(60.0), 1e-6);
+    test_pf.updateWeights(40.0, 1.0);
+    EXPECT_NEAR(test_pf.getEffectiveSampleSize(), countLeftOf(40.0), 1e-6);
+
+    // Now below half, so resampling goes ahead and only keeps particles with weight
+    test_pf.resample();
+    EXPECT_TRUE(test_pf.hasUniformWeights());
+    EXPECT_EQ(test_pf.getEffectiveSampleSize(), m_pf_params.num_of_particles);
+    EXPECT_EQ(countLeftOf(40.0), m_pf_params.num_of_particles);
+}
+
+TEST_P(ParticleFilterParamsTests, TestAdaptiveParticleCount)
+{
+    PF_THREAD_MODE run_pf_in_parallel = GetParam();
+    m_pf_params.thread_mode = run_pf_in_parallel;
+    m_pf_params.adaptive_particle_count = true;
+    m_pf_params.kld_min_particles = 500;
+
+    ParticleFilter test_pf = ParticleFilter{m_pf_params, &likelihoodFunction, &moveEstimatedState};
+    EXPECT_EQ(test_pf.getNumParticles(), m_pf_params.num_of_particles);
+
+    // Spread over the whole map the KL bound wants every particle it can get
+    test_pf.updateWeights(sensorFunction(m_gt_robot_state), 100.0);
+    test_pf.resample();
+    EXPECT_EQ(test_pf.getNumParticles(), m_pf_params.num_of_particles);
+
+    // Once converged a handful of bins is all that's left
+    for (uint16_t i = 0; i < 20; i++)
+    {
+        test_pf.updateWeights(sensorFunction(m_gt_robot_state), m_sensor_std_dev);
+        test_pf.propogateState(m_waypoint);
+        moveEstimatedState(m_gt_robot_state, m_waypoint);
+        test_pf.resample();
+        test_pf.mutateParticles(m_pf_params.particle_propogation_std);
+    }
+    const int64_t converged_count = test_pf.getNumParticles();
+    EXPECT_LT(converged_count, m_pf_params.num_of_particles / 10);
+    EXPECT_GE(converged_count, m_pf_params.kld_min_particles);
+    EXPECT_EQ(test_pf.getParticles().size(), converged_count);
+    test_pf.updateWeights(sensorFunction(m_gt_robot_state), m_sensor_std_dev);
+    EXPECT_LT(calculateError(test_pf.getXHat(), m_gt_robot_state), 1.0);
+    test_pf.resample();
+
+    // Losing track spreads the particles out again and the count grows back
+    test_pf.mutateParticles({20.0, 20.0});
+    test_pf.updateWeights(sensorFunction(m_gt_robot_state), 100.0);
+    test_pf.resample();
+    EXPECT_GT(test_pf.getNumParticles(), 5 * converged_count);
+
+    test_pf.initialize();
+    EXPECT_EQ(test_pf.getNumParticles(), m_pf_params.num_of_particles);
+}
+
+TEST_F(ParticleFilterTests, TestAdaptiveParticleCountChecksTheBins)
+{
+    m_pf_params.thread_mode = PF_THREAD_MODE::SINGLE_THREADED;
+    m_pf_params.adaptive_particle_count = true;
+    m_pf_params.kld_min_particles = 500;
+
+    for (const double bad_bin_size : {0.0, -1.0, std::numeric_limits<double>::quiet_NaN(), std::numeric_limits<double>::infinity()})
+    {
+        m_pf_params.kld_bin_size = {1.0, bad_bin_size};
+        EXPECT_THROW((ParticleFilter{m_pf_params, &likelihoodFunction, &moveEstimatedState}), std::invalid_argument) << bad_bin_size;
+    }
+
+    // 10^8 bins per component would need far more memory than the bound allows
+    m_pf_params.kld_bin_size = {1e-6, 1e-6};
+    EXPECT_THROW((ParticleFilter{m_pf_params, &likelihoodFunction, &moveEstimatedState}), std::invalid_argument);
+
+    // Particles far off the map or NaN go to the edge bins rather than past the end of the grid
+    m_pf_params.kld_bin_size = {1.0, 1.0};
+    ParticleFilter test_pf = ParticleFilter{m_pf_params, &likelihoodFunction, &moveEstimatedState};
+    for (const double waypoint : {1e300, -1e300, std::numeric_limits<double>::quiet_NaN()})
+    {
+        test_pf.updateWeights(sensorFunction(m_gt_robot_state), 100.0);
+        test_pf.propogateState({waypoint, waypoint});
+        test_pf.resample();
+        EXPECT_GE(test_pf.getNumParticles(), m_pf_params.kld_min_particles);
+        EXPECT_LE(test_pf.getNumParticles(), m_pf_params.num_of_particles);
+        test_pf.initialize();
+    }
+}
+
+TEST_P(ParticleFilterParamsTests, TestFusedStepMatchesSeparateCalls)
+{
+    PF_THREAD_MODE run_pf_in_parallel = GetParam();
+    m_pf_params.thread_mode = run_pf_in_parallel;
+    m_pf_params.num_of_particles = 10007;
+
+    // Plain, skipping resamples while the weights are healthy, and with the particle count changing
+    std::vector<PF_Params> all_params{m_pf_params, m_pf_params, m_pf_params};
+    all_params[1].resample_ess_threshold = 0.5;
+    all_params[2].adaptive_particle_count = true;
+    all_params[2].kld_min_particles = 100;
+
+    for (const PF_Params& params : all_params)
+    {
+        State robot_state = m_gt_robot_state;
+        ParticleFilter separate_pf = ParticleFilter{params, &likelihoodFunction, &moveEstimatedState};
+        ParticleFilter fused_pf = ParticleFilter{params, &likelihoodFunction, &moveEstimatedState};
+        for (uint16_t i = 0; i < 10; i++)
+        {
+            separate_pf.updateWeights(sensorFunction(robot_state), 1.0);
+            separate_pf.resample();
+            separate_pf.mutateParticles(params.particle_propogation_std);
+            separate_pf.propogateState(m_waypoint);
+
+            fused_pf.updateWeights(sensorFunction(robot_state), 1.0);
+            fused_pf.resampleMutatePropagate(params.particle_propogation_std, m_waypoint);
+            moveEstimatedState(robot_state, m_waypoint);
+
+            ASSERT_EQ(fused_pf.getNumParticles(), separate_pf.getNumParticles());
+            for (int64_t j = 0; j < separate_pf.getNumParticles(); j++)
+            {
+                ASSERT_EQ(fused_pf.getParticles().xs()[j], separate_pf.getParticles().xs()[j]);
+                ASSERT_EQ(fused_pf.getParticles().ys()[j], separate_pf.getParticles().ys()[j]);
+            }
+        }
+    }
+}
+
+TEST_P(ParticleFilterParamsTests, TestLogWeightsMatchLinearWeights)
+{
+    PF_THREAD_MODE run_pf_in_parallel = GetParam();
+    m_pf_params.thread_mode = run_pf_in_parallel;
+    m_pf_params.num_of_particles = 10000;
+
+    ParticleFilter linear_pf = ParticleFilter{m_pf_params, &likelihoodFunction, &moveEstimatedState};
+    m_pf_params.log_domain_weights = true;
+    ParticleFilter log_pf = ParticleFilter{m_pf_params, &likelihoodFunction, &moveEstimatedState};
+
+    // A sensor wide enough that nothing underflows, both should see the same weights. There is no resample
+    // in between so the second update multiplies into the carried weights
+    for (const double observation : {sensorFunction(m_gt_robot_state), sensorFunction(m_gt_robot_state) + 1.0})
+    {
+        linear_pf.updateWeights(observation, 20.0);
+        log_pf.updateWeights(observation, 20.0);
+        ASSERT_FALSE(log_pf.hasUniformWeights());
+
+        const State linear_estimate = linear_pf.getXHat();
+        const State log_estimate = log_pf.getXHat();
+        EXPECT_NEAR(log_estimate.x, linear_estimate.x, 1e-9);
+        EXPECT_NEAR(log_estimate.y, linear_estimate.y, 1e-9);
+        EXPECT_NEAR(log_pf.getEffectiveSampleSize(), linear_pf.getEffectiveSampleSize(), 1e-6);
+    }
+}
+
+TEST_P(ParticleFilterParamsTests, TestOriginReadingMatchesObservationUpdate)
+{
+    m_pf_params.thread_mode = GetParam();
+    m_pf_params.num_of_particles = 10000;
+    ParticleFilter observation_pf = ParticleFilter{m_pf_params, &likelihoodFunction, &moveEstimatedState};
+    ParticleFilter reading_pf = ParticleFilter{m_pf_params, &likelihoodFunction, &moveEstimatedState};
+
+    // The scalar overload is a single reading from a beacon at the origin, down to the last bit
+    const double observation = sensorFunction(m_gt_robot_state);
+    observation_pf.updateWeights(observation, 5.0);
+    const std::vector<BeaconReading> readings{BeaconReading{State{0.0, 0.0}, observation, 5.0}};
+    reading_pf.updateWeights(readings);
+    EXPECT_EQ(reading_pf.getXHat().x, observation_pf.getXHat().x);
+    EXPECT_EQ(reading_pf.getXHat().y, observation_pf.getXHat().y);
+    EXPECT_EQ(reading_pf.getEffectiveSampleSize(), observation_pf.getEffectiveSampleSize());
+
+    // No readings, no change
+    reading_pf.updateWeights(std::vector<BeaconReading>{});
+    EXPECT_EQ(reading_pf.getXHat().x, observation_pf.getXHat().x);
+}
+
+TEST_P(ParticleFilterParamsTests, TestJointReadingsMatchUpdatesOneByOne)
+{
+    m_pf_params.thread_mode = GetParam();
+    m_pf_params.num_of_particles = 10000;
+
+    // Three beacons around the robot, broad enough that nothing underflows
+    std::vector<BeaconReading> readings;
+    for (const State& beacon : {State{0.0, 0.0}, State{100.0, 0.0}, State{50.0, 100.0}})
+    {
+        const State relative{m_gt_robot_state.x - beacon.x, m_gt_robot_state.y - beacon.y};
+        readings.push_back(BeaconReading{beacon, sensorFunction(relative), 20.0});
+    }
+
+    // Stock batched model, the same maths without batch hooks, and the log domain
+    auto checkModel = [&](auto joint_pf, auto one_by_one_pf)
+    {
+        joint_pf.updateWeights(readings);
+        for (const BeaconReading& reading : readings)
+        {
+            one_by_one_pf.updateWeights(std::span<const BeaconReading>(&reading, 1));
+        }
+        EXPECT_NEAR(joint_pf.getXHat().x, one_by_one_pf.getXHat().x, 1e-9);
+        EXPECT_NEAR(joint_pf.getXHat().y, one_by_one_pf.getXHat().y, 1e-9);
+        EXPECT_NEAR(joint_pf.getEffectiveSampleSize(), one_by_one_pf.getEffectiveSampleSize(), 1e-6);
+    };
+    checkModel(ParticleFilter{m_pf_params, &likelihoodFunction, &moveEstimatedState}, ParticleFilter{m_pf_params, &likelihoodFunction, &moveEstimatedState});
+    checkModel(ParticleFilter<InlineRangeModel>{m_pf_params}, ParticleFilter<InlineRangeModel>{m_pf_params});
+    m_pf_params.log_domain_weights = true;
+    checkModel(ParticleFilter{m_pf_params, &likelihoodFunction, &moveEstimatedState}, ParticleFilter{m_pf_params, &likelihoodFunction, &moveEstimatedState});
+    checkModel(ParticleFilter<InlineRangeModel>{m_pf_params}, ParticleFilter<InlineRangeModel>{m_pf_params});
+}
+
+TEST_P(ParticleFilterParamsTests, TestBeaconsLocalizeTheRobot)
+{
+    m_pf_params.thread_mode = GetParam();
+    m_pf_params.num_of_particles = 20000;
+
+    // One range only puts the robot on a circle, three beacons pin it down
+    std::vector<BeaconReading> readings;
+    for (const State& beacon : {State{0.0, 0.0}, State{100.0, 0.0}, State{0.0, 100.0}})
+    {
+        const State relative{m_gt_robot_state.x - beacon.x, m_gt_robot_state.y - beacon.y};
+        readings.push_back(BeaconReading{beacon, sensorFunction(relative), 0.5});
+    }
+
+    ParticleFilter test_pf = ParticleFilter{m_pf_params, &likelihoodFunction, &moveEstimatedState};
+    for (int64_t step = 0; step < 10; ++step)
+    {
+        test_pf.updateWeights(readings);
+        test_pf.resample();
+        test_pf.mutateParticles(m_pf_params.particle_propogation_std);
+    }
+    test_pf.updateWeights(readings);
+    EXPECT_LT(calculateError(test_pf.getXHat(), m_gt_robot_state), 0.5);
+}
+
+TEST_P(ParticleFilterParamsTests, TestLogWeightsWithSharpSensor)
+{
+    PF_THREAD_MODE run_pf_in_parallel = GetParam();
+    m_pf_params.thread_mode = run_pf_in_parallel;
+    m_pf_params.num_of_particles = 1000;
+    const double sharp_sensor_std = 1e-4;
+    const double observation = sensorFunction(m_gt_robot_state);
+
+    // Every likelihood underflows, the filter falls back to equal weights instead of dividing by zero
+    ParticleFilter linear_pf = ParticleFilter{m_pf_params, &likelihoodFunction, &moveEstimatedState};
+    linear_pf.updateWeights(observation, sharp_sensor_std);
+    EXPECT_TRUE(linear_pf.hasUniformWeights());
+    EXPECT_TRUE(std::isfinite(linear_pf.getXHat().x));
+
+    // In the log domain the particle closest to the reading still wins
+    m_pf_params.log_domain_weights = true;
+    ParticleFilter log_pf = ParticleFilter{m_pf_params, &likelihoodFunction, &moveEstimatedState};
+    log_pf.updateWeights(observation, sharp_sensor_std);
+    EXPECT_FALSE(log_pf.hasUniformWeights());
+    EXPECT_GE(log_pf.getEffectiveSampleSize(), 1.0);
+
+    const ParticleStorage& particles = log_pf.getParticles();
+    int64_t best_index = 0;
+    for (int64_t i = 0; i < particles.size(); i++)
+    {
+        if (std::abs(sensorFunction(particles.get(i)) - observation) < std::abs(sensorFunction(particles.get(best_index)) - observation))
+        {
+            best_index = i;
+        }
+    }
+    const State estimate = log_pf.getXHat();
+    EXPECT_NEAR(estimate.x, particles.get(best_index).x, 1e-6);
+    EXPECT_NEAR(estimate.y, particles.get(best_index).y, 1e-6);
+
+    log_pf.resample();
+    for (int64_t i = 0; i < log_pf.getNumParticles(); i++)
+    {
+        ASSERT_EQ(log_pf.getParticles().xs()[i], particles.xs()[best_index]);
+    }
+}
+
+TEST_P(ParticleFilterParamsTests, TestFullParticleFilterLoopWithLogWeights)
+{
+    PF_THREAD_MODE run_pf_in_parallel = GetParam();
+    m_pf_params.thread_mode = run_pf_in_parallel;
+    m_pf_params.log_domain_weights = true;
+
+    double expected_error = 0.0;
+    ParticleFilter test_pf = ParticleFilter{m_pf_params, &likelihoodFunction, &moveEstimatedState};
+    for (uint16_t i=0; i<m_resamples;i++)
+    {
+        test_pf.updateWeights(sensorFunction(m_gt_robot_state), m_sensor_std_dev);
+        State estimate = test_pf.getXHat();
+        double l2_error = calculateError(estimate, m_gt_robot_state);
+
+        double error_threshold = m_error_thresholds[floor(i/10)];
+        EXPECT_NEAR(l2_error, expected_error, error_threshold);
+
+        test_pf.propogateState({m_waypoint});
+        moveEstimatedState(m_gt_robot_state, m_waypoint);
+
+        test_pf.resample();
+        test_pf.mutateParticles(m_pf_params.particle_propogation_std);
+    }
+}
+
+TEST_F(ParticleFilterTests, TestReductionsDoNotDependOnThreading)
+{
+    // Not a multiple of the reduction leaf size so the last leaf is a partial one
+    m_pf_params.num_of_particles = 100001;
+    m_pf_params.resample_ess_threshold = 0.5;
+
+    m_pf_params.thread_mode = PF_THREAD_MODE::SINGLE_THREADED;
+    ParticleFilter reference_pf = ParticleFilter{m_pf_params, &likelihoodFunction, &moveEstimatedState};
+
+    // Different grains split the particles the way different core counts would
+    m_pf_params.thread_mode = PF_THREAD_MODE::MULTI_THREADED;
+    std::vector<ParticleFilter<FunctionModel>> test_pfs;
+    test_pfs.reserve(3);
+    for (const int64_t grain : {0, 1000, 30000})
+    {
+        m_pf_params.parallel_grain_size = grain;
+        test_pfs.emplace_back(m_pf_params, &likelihoodFunction, &moveEstimatedState);
+    }
+
+    State robot_state = m_gt_robot_state;
+    for (int i = 0; i < 5; i++)
+    {
+        reference_pf.updateWeights(sensorFunction(robot_state), 1.0);
+        const State reference_estimate = reference_pf.getXHat();
+        const double reference_effective_sample_size = reference_pf.getEffectiveSampleSize();
+        reference_pf.resampleMutatePropagate(m_pf_params.particle_propogation_std, m_waypoint);
+
+        for (ParticleFilter<FunctionModel>& test_pf : test_pfs)
+        {
+            test_pf.updateWeights(sensorFunction(robot_state), 1.0);
+            const State estimate = test_pf.getXHat();
+            ASSERT_EQ(estimate.x, reference_estimate.x);
+            ASSERT_EQ(estimate.y, reference_estimate.y);
+            ASSERT_EQ(test_pf.getEffectiveSampleSize(), reference_effective_sample_size);
+
+            test_pf.resampleMutatePropagate(m_pf_params.particle_propogation_std, m_waypoint);
+            ASSERT_EQ(test_pf.getNumParticles(), reference_pf.getNumParticles());
+            for (int64_t j = 0; j < reference_pf.getNumParticles(); j++)
+            {
+                ASSERT_EQ(test_pf.getParticles().xs()[j], reference_pf.getParticles().xs()[j]);
+                ASSERT_EQ(test_pf.getParticles().ys()[j], reference_pf.getParticles().ys()[j]);
+            }
+        }
+        moveEstimatedState(robot_state, m_waypoint);
+    }
+}
+
+TEST_P(ParticleFilterParamsTests, TestStreamingResampleMatchesPrefixSum)
+{
+    m_pf_params.thread_mode = GetParam();
+    m_pf_params.num_of_particles = 100001; // Last block is a partial one
+    m_pf_params.parallel_grain_size = 3000; // Chunks that don't line up with the blocks
+
+    for (const PF_RESAMPLING_SCHEME scheme : {PF_RESAMPLING_SCHEME::SYSTEMATIC, PF_RESAMPLING_SCHEME::STRATIFIED})
+    {
+        m_pf_params.resampling_scheme = scheme;
+        m_pf_params.streaming_resample = false;
+        ParticleFilter prefix_sum_pf = ParticleFilter{m_pf_params, &likelihoodFunction, &moveEstimatedState};
+        m_pf_params.streaming_resample = true;
+        ParticleFilter streaming_pf = ParticleFilter{m_pf_params, &likelihoodFunction, &moveEstimatedState};
+
+        // A wide sensor first, then a sharp one so most blocks end up with no spokes at all
+        State robot_state = m_gt_robot_state;
+        for (const double sensor_std : {10.0, 1.0, 0.1})
+        {
+            prefix_sum_pf.updateWeights(sensorFunction(robot_state), sensor_std);
+            streaming_pf.updateWeights(sensorFunction(robot_state), sensor_std);
+            prefix_sum_pf.resampleMutatePropagate(m_pf_params.particle_propogation_std, m_waypoint);
+            streaming_pf.resampleMutatePropagate(m_pf_params.particle_propogation_std, m_waypoint);
+            moveEstimatedState(robot_state, m_waypoint);
+
+            for (int64_t i = 0; i < prefix_sum_pf.getNumParticles(); i++)
+            {
+                ASSERT_EQ(streaming_pf.getParticles().xs()[i], prefix_sum_pf.getParticles().xs()[i]) << "scheme " << scheme << " at " << i;
+                ASSERT_EQ(streaming_pf.getParticles().ys()[i], prefix_sum_pf.getParticles().ys()[i]) << "scheme " << scheme << " at " << i;
+            }
+        }
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(TestMultiAndSingleThreaded, ParticleFilterParamsTests, testing::Values(PF_THREAD_MODE::MULTI_THREADED,PF_THREAD_MODE::SINGLE_THREADED,PF_THREAD_MODE::AUTO));
+
+TEST_P(ResamplingSchemeTests, TestResamplingIsUnbiased)
+{
+    m_pf_params.resampling_scheme = GetParam();
+    m_pf_params.metropolis_iterations = 256; // Long enough for the chain to forget where it started with these weights
+
+    for (const PF_THREAD_MODE thread_mode : {PF_THREAD_MODE::SINGLE_THREADED, PF_THREAD_MODE::MULTI_THREADED})
+    {
+        m_pf_params.thread_mode = thread_mode;
+        ParticleFilter test_pf = ParticleFilter{m_pf_params, &likelihoodFunction, &moveEstimatedState};
+
+        // A wide sensor so plenty of particles carry weight and rejection stays cheap
+        test_pf.updateWeights(sensorFunction(m_gt_robot_state), 5.0);
+        const State weighted_estimate = test_pf.getXHat();
+        test_pf.resample();
+        ASSERT_TRUE(test_pf.hasUniformWeights());
+
+        // The resampled cloud should have the weighted cloud's mean
+        const State resampled_estimate = test_pf.getXHat();
+        EXPECT_NEAR(resampled_estimate.x, weighted_estimate.x, 0.5);
+        EXPECT_NEAR(resampled_estimate.y, weighted_estimate.y, 0.5);
+
+        // And only keep particles near the measured range
+        const ParticleStorage& particles = test_pf.getParticles();
+        const double measured_range = sensorFunction(m_gt_robot_state);
+        int64_t num_far = 0;
+        for (int64_t i = 0; i < particles.size(); i++)
+        {
+            num_far += std::abs(sensorFunction(particles.get(i)) - measured_range) > 5.0 * 5.0;
+        }
+        EXPECT_EQ(num_far, 0);
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(TestAllSchemes, ResamplingSchemeTests, testing::Values(PF_RESAMPLING_SCHEME::SYSTEMATIC, PF_RESAMPLING_SCHEME::STRATIFIED,
+    PF_RESAMPLING_SCHEME::RESIDUAL, PF_RESAMPLING_SCHEME::MULTINOMIAL, PF_RESAMPLING_SCHEME::METROPOLIS, PF_RESAMPLING_SCHEME::REJECTION));
+
+TEST_F(ParticleFilterTests, TestScanFreeResamplingDoesNotDependOnChunking)
+{
+    // Metropolis and rejection only compare weights, so the ancestors can't depend on how the work was split
+    m_pf_params.num_of_particles = 10007;
+    for (const PF_RESAMPLING_SCHEME scheme : {PF_RESAMPLING_SCHEME::METROPOLIS, PF_RESAMPLING_SCHEME::REJECTION})
+    {
+        m_pf_params.resampling_scheme = scheme;
+        m_pf_params.thread_mode = PF_THREAD_MODE::SINGLE_THREADED;
+        ParticleFilter reference_pf = ParticleFilter{m_pf_params, &likelihoodFunction, &moveEstimatedState};
+        reference_pf.updateWeights(sensorFunction(m_gt_robot_state), 5.0);
+        reference_pf.resample();
+
+        m_pf_params.thread_mode = PF_THREAD_MODE::MULTI_THREADED;
+        for (const int64_t grain_size : {0, 1, 1000, 4096})
+        {
+            m_pf_params.parallel_grain_size = grain_size;
+            ParticleFilter test_pf = ParticleFilter{m_pf_params, &likelihoodFunction, &moveEstimatedState};
+            test_pf.updateWeights(sensorFunction(m_gt_robot_state), 5.0);
+            test_pf.resample();
+            for (int64_t i = 0; i < m_pf_params.num_of_particles; i++)
+            {
+                ASSERT_EQ(test_pf.getParticles().xs()[i], reference_pf.getParticles().xs()[i]);
+                ASSERT_EQ(test_pf.getParticles().ys()[i], reference_pf.getParticles().ys()[i]);
+            }
+        }
+    }
+}
@@ -0,0 +1,107 @@
+// Custom Non‑Commercial License
+
+// Copyright (c) 2025 Mgoodell97
+
+// Permission is hereby granted, free of charge, to any individual or
+// non‑commercial entity obtaining a copy of this software and associated
+// documentation files (the "Software"), to use, copy, modify, merge, publish,
+// and distribute the Software for personal, educational, or research purposes,
+// subject to the following conditions:
+
+// 1. Commercial Use:
+//    Any company, corporation, or organization intending to use the Software
+//    must first notify the copyright holder and obtain explicit written
+//    permission. Commercial use without such permission is strictly prohibited.
+
+// 2. Unauthorized Commercial Use:
+//    If a company is found to be using the Software without prior authorization,
+//    the copyright holder is entitled to receive 1% of the company’s gross
+//    profits moving forward, enforceable as a licensing fee.
+
+// 3. Artificial Intelligence / Machine Learning Use:
+//    If the Software is incorporated into machine learning
+//    models, neural networks, generative pre‑trained transformers (GPTs), or similar AI systems,
+//    the company deploying such use is solely responsible for compliance with
+//    this license. Responsibility cannot be shifted to the provider of training
+//    data or third‑party services.
+
+// 4. Attribution:
+//    The above copyright notice and this permission notice shall be included in
+//    all copies or substantial portions of the Software.
+
+// Disclaimer:
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <set>
+
+#include "philox.hpp"
+
+TEST(PhiloxTests, TestKnownAnswers)
+{
+    // Known answer vectors from the Random123 distribution (kat_vectors, philox4x32_10)
+    EXPECT_EQ(Philox4x32::generate({0, 0, 0, 0}, {0, 0}),
+              (Philox4x32::Counter{0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8}));
+    EXPECT_EQ(Philox4x32::generate({0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff}, {0xffffffff, 0xffffffff}),
+              (Philox4x32::Counter{0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd}));
+    EXPECT_EQ(Philox4x32::generate({0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344}, {0xa4093822, 0x299f31d0}),
+              (Philox4x32::Counter{0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1}));
+}
+
+TEST(PhiloxTests, TestDrawsAreUniquePerStreamStepAndIndex)
+{
+    const CounterRng rng(42);
+    std::set<Philox4x32::Counter> draws;
+    for (const RNG_STREAM stream : {RNG_STREAM_INITIALIZE, RNG_STREAM_MUTATE, RNG_STREAM_RESAMPLE})
+    {
+        for (uint64_t step = 0; step < 10; ++step)
+        {
+            for (uint64_t index = 0; index < 100; ++index)
+            {
+                draws.insert(rng.draw(stream, step, index));
+            }
+        }
+    }
+    EXPECT_EQ(draws.size(), 3u * 10u * 100u);
+
+    // Same key and counter, same bits
+    EXPECT_EQ(CounterRng(42).draw(RNG_STREAM_MUTATE, 7, 123), rng.draw(RNG_STREAM_MUTATE, 7, 123));
+    EXPECT_NE(CounterRng(43).draw(RNG_STREAM_MUTATE, 7, 123), rng.draw(RNG_STREAM_MUTATE, 7, 123));
+}
+
+TEST(PhiloxTests, TestUniformAndNormalMoments)
+{
+    const CounterRng rng(7);
+    constexpr int64_t NUM_DRAWS = 200000;
+
+    double uniform_sum = 0.0;
+    double normal_sum = 0.0;
+    double normal_square_sum = 0.0;
+    for (int64_t i = 0; i < NUM_DRAWS; ++i)
+    {
+        const auto [u_0, u_1] = rng.uniform2(RNG_STREAM_INITIALIZE, 0, i);
+        ASSERT_GE(u_0, 0.0);
+        ASSERT_LT(u_0, 1.0);
+        ASSERT_GE(u_1, 0.0);
+        ASSERT_LT(u_1, 1.0);
+        uniform_sum += u_0 + u_1;
+
+        const auto [n_0, n_1] = rng.normal2(RNG_STREAM_MUTATE, 0, i);
+        ASSERT_TRUE(std::isfinite(n_0) && std::isfinite(n_1));
+        normal_sum += n_0 + n_1;
+        normal_square_sum += n_0 * n_0 + n_1 * n_1;
+    }
+
+    // Several standard errors of slack, the draws are fixed so this can't flake
+    EXPECT_NEAR(uniform_sum / (2.0 * NUM_DRAWS), 0.5, 0.005);
+    EXPECT_NEAR(normal_sum / (2.0 * NUM_DRAWS), 0.0, 0.01);
+    EXPECT_NEAR(normal_square_sum / (2.0 * NUM_DRAWS), 1.0, 0.01);
+}
@@ -0,0 +1,383 @@
+// Custom Non‑Commercial License
+
+// Copyright (c) 2025 Mgoodell97
+
+// Permission is hereby granted, free of charge, to any individual or
+// non‑commercial entity obtaining a copy of this software and associated
+// documentation files (the "Software"), to use, copy, modify, merge, publish,
+// and distribute the Software for personal, educational, or research purposes,
+// subject to the following conditions:
+
+// 1. Commercial Use:
+//    Any company, corporation, or organization intending to use the Software
+//    must first notify the copyright holder and obtain explicit written
+//    permission. Commercial use without such permission is strictly prohibited.
+
+// 2. Unauthorized Commercial Use:
+//    If a company is found to be using the Software without prior authorization,
+//    the copyright holder is entitled to receive 1% of the company’s gross
+//    profits moving forward, enforceable as a licensing fee.
+
+// 3. Artificial Intelligence / Machine Learning Use:
+//    If the Software is incorporated into machine learning
+//    models, neural networks, generative pre‑trained transformers (GPTs), or similar AI systems,
+//    the company deploying such use is solely responsible for compliance with
+//    this license. Responsibility cannot be shifted to the provider of training
+//    data or third‑party services.
+
+// 4. Attribution:
+//    The above copyright notice and this permission notice shall be included in
+//    all copies or substantial portions of the Software.
+
+// Disclaimer:
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <gtest/gtest.h>
+
+#include <bit>
+#include <cmath>
+#include <numbers>
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "philox.hpp"
+#include "simd_kernels.hpp"
+#include "state_functions.hpp"
+
+// Distance between two doubles in units in the last place
+static uint64_t ulpDistance(const double a, const double b)
+{
+    // Map the sign magnitude bit patterns onto a monotonic integer line
+    auto toOrdered = [](const double value)
+    {
+        const int64_t bits = std::bit_cast<int64_t>(value);
+        return bits < 0 ? INT64_MIN - bits : bits;
+    };
+    const int64_t ordered_a = toOrdered(a);
+    const int64_t ordered_b = toOrdered(b);
+    return ordered_a > ordered_b ? static_cast<uint64_t>(ordered_a - ordered_b) : static_cast<uint64_t>(ordered_b - ordered_a);
+}
+
+// Odd size so every level runs its scalar tail as well as the vector body
+constexpr int64_t SIMD_TEST_COUNT = 100003;
+
+class SimdKernelParamsTests: public testing::TestWithParam<SIMD_LEVEL>
+{
+protected:
+    void SetUp() override
+    {
+        if (GetParam() > detectSimdLevel())
+        {
+            GTEST_SKIP() << "CPU does not support this SIMD level";
+        }
+    }
+};
+
+TEST(SimdKernelTests, TestAutoPicksDetectedLevel)
+{
+    EXPECT_EQ(getSimdKernels().level, detectSimdLevel());
+    EXPECT_EQ(getSimdKernels(SIMD_AUTO).level, detectSimdLevel());
+    EXPECT_EQ(getSimdKernels(SIMD_SCALAR).level, SIMD_SCALAR);
+}
+
+TEST_P(SimdKernelParamsTests, TestExpMaxUlp)
+{
+    const SimdKernels& kernels = getSimdKernels(GetParam());
+    ASSERT_EQ(kernels.level, GetParam());
+
+    // Everything the likelihood can produce (-0.5 * z^2 <= 0) down to the smallest normal result, and some positives
+    std::vector<double> inputs;
+    for (int64_t i = 0; i < SIMD_TEST_COUNT; ++i)
+    {
+        inputs.push_back(-708.0 * static_cast<double>(i) / static_cast<double>(SIMD_TEST_COUNT - 1));
+    }
+    std::mt19937_64 rng(7);
+    std::uniform_real_distribution<double> small_dist(-1.0, 1.0);
+    std::uniform_real_distribution<double> positive_dist(0.0, 700.0);
+    for (int64_t i = 0; i < 10000; ++i)
+    {
+        inputs.push_back(small_dist(rng));
+        inputs.push_back(positive_dist(rng));
+    }
+
+    std::vector<double> outputs(inputs.size());
+    kernels.exp(inputs.data(), outputs.data(), static_cast<int64_t>(inputs.size()));
+
+    uint64_t max_ulp = 0;
+    for (size_t i = 0; i < inputs.size(); ++i)
+    {
+        max_ulp = std::max(max_ulp, ulpDistance(outputs[i], std::exp(inputs[i])));
+    }
+    EXPECT_LE(max_ulp, 1u);
+
+    // Results too small to be normal doubles are flushed to zero (or exactly std::exp for the scalar level)
+    const double tiny_input = -720.0;
+    double tiny_output = 1.0;
+    kernels.exp(&tiny_input, &tiny_output, 1);
+    EXPECT_LE(tiny_output, std::exp(tiny_input));
+}
+
+TEST_P(SimdKernelParamsTests, TestRangeSensorMatchesScalar)
+{
+    const SimdKernels& kernels = getSimdKernels(GetParam());
+
+    std::mt19937_64 rng(11);
+    std::uniform_real_distribution<double> dist(-200.0, 200.0);
+    std::vector<double> xs(SIMD_TEST_COUNT);
+    std::vector<double> ys(SIMD_TEST_COUNT);
+    for (int64_t i = 0; i < SIMD_TEST_COUNT; ++i)
+    {
+        xs[i] = dist(rng);
+        ys[i] = dist(rng);
+    }
+
+    std::vector<double> observations(SIMD_TEST_COUNT);
+    kernels.range_sensor(xs.data(), ys.data(), observations.data(), SIMD_TEST_COUNT);
+
+    // sqrt is correctly rounded everywhere so this is exact
+    for (int64_t i = 0; i < SIMD_TEST_COUNT; ++i)
+    {
+        ASSERT_EQ(observations[i], sensorFunction({xs[i], ys[i]})) << "index " << i;
+    }
+}
+
+TEST_P(SimdKernelParamsTests, TestGaussianLikelihoodMaxUlp)
+{
+    const SimdKernels& kernels = getSimdKernels(GetParam());
+
+    const double observation = 50.0;
+    const double sensor_std = 2.5;
+    std::mt19937_64 rng(13);
+    std::uniform_real_distribution<double> dist(0.0, 141.0);
+    std::vector<double> estimate_observations(SIMD_TEST_COUNT);
+    for (auto& estimate : estimate_observations)
+    {
+        estimate = dist(rng);
+    }
+
+    std::vector<double> weights(SIMD_TEST_COUNT);
+    const double weight_sum = kernels.gaussian_likelihood(estimate_observations.data(), weights.data(), SIMD_TEST_COUNT, 
+                                                          observation, sensor_std);
+
+    uint64_t max_ulp = 0;
+    double expected_sum = 0.0;
+    for (int64_t i = 0; i < SIMD_TEST_COUNT; ++i)
+    {
+        const double expected = likelihoodFunction(observation, estimate_observations[i], sensor_std);
+        expected_sum += expected;
+        if (std::fpclassify(expected) == FP_NORMAL)
+        {
+            max_ulp = std::max(max_ulp, ulpDistance(weights[i], expected));
+        }
+        else
+        {
+            EXPECT_LE(weights[i], expected);
+        }
+    }
+    EXPECT_LE(max_ulp, 1u);
+    EXPECT_NEAR(weight_sum, expected_sum, 1e-12 * expected_sum);
+}
+
+TEST_P(SimdKernelParamsTests, TestVectorLevelsAreBitIdentical)
+{
+    if (GetParam() == SIMD_SCALAR)
+    {
+        GTEST_SKIP() << "The scalar level is the std::exp reference";
+    }
+
+    const double observation = 20.0;
+    const double sensor_std = 0.5;
+    std::vector<double> estimate_observations(SIMD_TEST_COUNT);
+    for (int64_t i = 0; i < SIMD_TEST_COUNT; ++i)
+    {
+        estimate_observations[i] = 40.0 * static_cast<double>(i) / static_cast<double>(SIMD_TEST_COUNT);
+    }
+
+    std::vector<double> expected(SIMD_TEST_COUNT);
+    std::vector<double> weights(SIMD_TEST_COUNT);
+    getSimdKernels(SIMD_SSE2).gaussian_likelihood(estimate_observations.data(), expected.data(), SIMD_TEST_COUNT, observation, sensor_std);
+    getSimdKernels(GetParam()).gaussian_likelihood(estimate_observations.data(), weights.data(), SIMD_TEST_COUNT, observation, sensor_std);
+
+    for (int64_t i = 0; i < SIMD_TEST_COUNT; ++i)
+    {
+        ASSERT_EQ(std::bit_cast<uint64_t>(weights[i]), std::bit_cast<uint64_t>(expected[i])) << "index " << i;
+    }
+}
+
+// Normals from the same Philox uniforms the filter uses
+static std::vector<double> generateNormals(const SimdKernels& kernels, const int64_t count)
+{
+    const CounterRng rng(2024);
+    std::vector<double> u_radius(count);
+    std::vector<double> u_angle(count);
+    rng.uniformBlock(RNG_STREAM_MUTATE, 0, 0, count, u_radius.data(), u_angle.data());
+
+    std::vector<double> normals(2 * count);
+    kernels.box_muller(u_radius.data(), u_angle.data(), normals.data(), normals.data() + count, count);
+    return normals;
+}
+
+TEST_P(SimdKernelParamsTests, TestBoxMullerMatchesScalar)
+{
+    const SimdKernels& kernels = getSimdKernels(GetParam());
+
+    const CounterRng rng(5);
+    std::vector<double> u_radius(SIMD_TEST_COUNT);
+    std::vector<double> u_angle(SIMD_TEST_COUNT);
+    rng.uniformBlock(RNG_STREAM_MUTATE, 0, 0, SIMD_TEST_COUNT, u_radius.data(), u_angle.data());
+    // The ends of the range, including the largest radius there is
+    u_radius[0] = 0.0;
+    u_radius[1] = 1.0 - 0x1.0p-53;
+    u_angle[0] = 0.0;
+    u_angle[1] = 0.25;
+    u_angle[2] = 0.5;
+    u_angle[3] = 0.75;
+    u_angle[4] = 1.0 - 0x1.0p-53;
+
+    std::vector<double> normals_cos(SIMD_TEST_COUNT);
+    std::vector<double> normals_sin(SIMD_TEST_COUNT);
+    kernels.box_muller(u_radius.data(), u_angle.data(), normals_cos.data(), normals_sin.data(), SIMD_TEST_COUNT);
+
+    std::vector<double> expected_cos(SIMD_TEST_COUNT);
+    std::vector<double> expected_sin(SIMD_TEST_COUNT);
+    getSimdKernels(SIMD_SCALAR).box_muller(u_radius.data(), u_angle.data(), expected_cos.data(), expected_sin.data(), SIMD_TEST_COUNT);
+
+    // Near the zeros of sin and cos an ulp bound is meaningless (the scalar path rounds 2 * pi * u first), so bound the absolute error
+    for (int64_t i = 0; i < SIMD_TEST_COUNT; ++i)
+    {
+        ASSERT_NEAR(normals_cos[i], expected_cos[i], 1e-14) << "index " << i;
+        ASSERT_NEAR(normals_sin[i], expected_sin[i], 1e-14) << "index " << i;
+    }
+
+    // With no angle the output is the radius alone, which checks the log on its own
+    std::fill(u_angle.begin(), u_angle.end(), 0.0);
+    kernels.box_muller(u_radius.data(), u_angle.data(), normals_cos.data(), normals_sin.data(), SIMD_TEST_COUNT);
+    uint64_t max_ulp = 0;
+    for (int64_t i = 0; i < SIMD_TEST_COUNT; ++i)
+    {
+        max_ulp = std::max(max_ulp, ulpDistance(normals_cos[i], std::sqrt(-2.0 * std::log(1.0 - u_radius[i]))));
+        ASSERT_EQ(normals_sin[i], 0.0);
+    }
+    EXPECT_LE(max_ulp, 1u);
+}
+
+TEST_P(SimdKernelParamsTests, TestBoxMullerMoments)
+{
+    constexpr int64_t NUM_PAIRS = 500000;
+    const std::vector<double> normals = generateNormals(getSimdKernels(GetParam()), NUM_PAIRS);
+    const double n = static_cast<double>(normals.size());
+
+    double mean = 0.0;
+    for (const double value : normals)
+    {
+        mean += value;
+    }
+    mean /= n;
+
+    double m2 = 0.0;
+    double m3 = 0.0;
+    double m4 = 0.0;
+    for (const double value : normals)
+    {
+        const double d = value - mean;
+        m2 += d * d;
+        m3 += d * d * d;
+        m4 += d * d * d * d;
+    }
+    m2 /= n;
+    m3 /= n;
+    m4 /= n;
+
+    // Standard errors at n = 1e6 are about 0.001 (mean), 0.0014 (variance), 0.0025 (skewness) and 0.005 (kurtosis).
+    // The inputs are fixed, so these bounds are several standard errors wide and can't flake.
+    EXPECT_NEAR(mean, 0.0, 0.005);
+    EXPECT_NEAR(m2, 1.0, 0.007);
+    EXPECT_NEAR(m3 / std::pow(m2, 1.5), 0.0, 0.0125);
+    EXPECT_NEAR(m4 / (m2 * m2) - 3.0, 0.0, 0.025);
+}
+
+TEST_P(SimdKernelParamsTests, TestBoxMullerKolmogorovSmirnov)
+{
+    constexpr int64_t NUM_PAIRS = 100000;
+    std::vector<double> normals = generateNormals(getSimdKernels(GetParam()), NUM_PAIRS);
+    std::sort(normals.begin(), normals.end());
+    const double n = static_cast<double>(normals.size());
+
+    double max_distance = 0.0;
+    for (size_t i = 0; i < normals.size(); ++i)
+    {
+        const double cdf = 0.5 * std::erfc(-normals[i] / std::numbers::sqrt2);
+        max_distance = std::max(max_distance, std::max(cdf - static_cast<double>(i) / n, static_cast<double>(i + 1) / n - cdf));
+    }
+
+    // Critical value at alpha = 0.001 is 1.95 / sqrt(n)
+    EXPECT_LT(max_distance, 1.95 / std::sqrt(n));
+}
+
+TEST_P(SimdKernelParamsTests, TestPrefixSum)
+{
+    const SimdKernels& kernels = getSimdKernels(GetParam());
+
+    // Small whole numbers add up exactly in any order, so every level has to match the serial scan exactly
+    std::vector<double> values(SIMD_TEST_COUNT);
+    std::vector<double> expected(SIMD_TEST_COUNT);
+    double running_total = 0.0;
+    for (int64_t i = 0; i < SIMD_TEST_COUNT; ++i)
+    {
+        values[i] = static_cast<double>(i % 7);
+        running_total += values[i];
+        expected[i] = running_total;
+    }
+
+    std::vector<double> scanned(SIMD_TEST_COUNT);
+    EXPECT_EQ(kernels.prefix_sum(values.data(), scanned.data(), SIMD_TEST_COUNT), running_total);
+    for (int64_t i = 0; i < SIMD_TEST_COUNT; ++i)
+    {
+        ASSERT_EQ(scanned[i], expected[i]) << "at " << i;
+    }
+
+    // In place, and every length up to a few vectors so each tail is covered
+    for (int64_t count = 0; count <= 20; ++count)
+    {
+        std::vector<double> in_place(values.begin(), values.begin() + count);
+        const double total = kernels.prefix_sum(in_place.data(), in_place.data(), count);
+        EXPECT_EQ(total, count > 0 ? expected[count - 1] : 0.0);
+        for (int64_t i = 0; i < count; ++i)
+        {
+            ASSERT_EQ(in_place[i], expected[i]) << "count " << count << " at " << i;
+        }
+    }
+
+    // General values round differently, but stay close
+    for (int64_t i = 0; i < SIMD_TEST_COUNT; ++i)
+    {
+        values[i] = 1.0 / static_cast<double>(i + 1);
+    }
+    kernels.prefix_sum(values.data(), scanned.data(), SIMD_TEST_COUNT);
+    getSimdKernels(SIMD_SCALAR).prefix_sum(values.data(), expected.data(), SIMD_TEST_COUNT);
+    for (int64_t i = 0; i < SIMD_TEST_COUNT; ++i)
+    {
+        ASSERT_NEAR(scanned[i], expected[i], 1e-12 * expected[i]);
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(SimdKernelTests, SimdKernelParamsTests,
+                         testing::Values(SIMD_SCALAR, SIMD_SSE2, SIMD_AVX2, SIMD_AVX512),
+                         [](const testing::TestParamInfo<SIMD_LEVEL>& info)
+                         {
+                             switch (info.param)
+                             {
+                                 case SIMD_SSE2: return "SSE2";
+                                 case SIMD_AVX2: return "AVX2";
+                                 case SIMD_AVX512: return "AVX512";
+                                 default: return "Scalar";
+                             }
+                         });
@@ -0,0 +1,368 @@
+// Custom Non‑Commercial License
+
+// Copyright (c) 2025 Mgoodell97
+
+// Permission is hereby granted, free of charge, to any individual or
+// non‑commercial entity obtaining a copy of this software and associated
+// documentation files (the "Software"), to use, copy, modify, merge, publish,
+// and distribute the Software for personal, educational, or research purposes,
+// subject to the following conditions:
+
+// 1. Commercial Use:
+//    Any company, corporation, or organization intending to use the Software
+//    must first notify the copyright holder and obtain explicit written
+//    permission. Commercial use without such permission is strictly prohibited.
+
+// 2. Unauthorized Commercial Use:
+//    If a company is found to be using the Software without prior authorization,
+//    the copyright holder is entitled to receive 1% of the company’s gross
+//    profits moving forward, enforceable as a licensing fee.
+
+// 3. Artificial Intelligence / Machine Learning Use:
+//    If the Software is incorporated into machine learning
+//    models, neural networks, generative pre‑trained transformers (GPTs), or similar AI systems,
+//    the company deploying such use is solely responsible for compliance with
+//    this license. Responsibility cannot be shifted to the provider of training
+//    data or third‑party services.
+
+// 4. Attribution:
+//    The above copyright notice and this permission notice shall be included in
+//    all copies or substantial portions of the Software.
+
+// Disclaimer:
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+#include "particle_filter_impl.hpp"
+
+// Range to the first three components, whatever else the state carries
+template<int64_t D>
+double range3D(const StateN<D>& state)
+{
+    return std::sqrt(state[0] * state[0] + state[1] * state[1] + state[2] * state[2]);
+}
+
+// Position in 3D, the waypoint is the displacement for the step
+struct PositionModel3D
+{
+    using StateType = StateN<3>;
+
+    double sensor(const StateType& state) const { return range3D(state); }
+
+    double likelihood(const double sensor_observation, const double estimate_observation, const double sensor_std) const
+    {
+        return likelihoodFunction(sensor_observation, estimate_observation, sensor_std);
+    }
+
+    double logLikelihood(const double sensor_observation, const double estimate_observation, const double sensor_std) const
+    {
+        return logLikelihoodFunction(sensor_observation, estimate_observation, sensor_std);
+    }
+
+    void propagate(StateType& state, const StateType& waypoint) const
+    {
+        for (int64_t d = 0; d < 3; ++d)
+        {
+            state[d] += waypoint[d];
+        }
+    }
+};
+
+// Constant velocity in 3D, (x, y, z, vx, vy, vz). The waypoint isn't used, the particles move with their own velocity.
+struct ConstantVelocityModel
+{
+    using StateType = StateN<6>;
+
+    double sensor(const StateType& state) const { return range3D(state); }
+
+    double likelihood(const double sensor_observation, const double estimate_observation, const double sensor_std) const
+    {
+        return likelihoodFunction(sensor_observation, estimate_observation, sensor_std);
+    }
+
+    void propagate(StateType& state, const StateType&) const
+    {
+        for (int64_t d = 0; d < 3; ++d)
+        {
+            state[d] += state[d + 3];
+        }
+    }
+};
+
+// PositionModel3D with 2D batch hooks that would leave out z (and write nonsense), they must never be called
+struct PositionModel3DWithBatchHooks : PositionModel3D
+{
+    double updateWeightsBatch(const SimdKernels&, const double*, const double*, double* weights, const int64_t count, const double, const double) const
+    {
+        std::fill(weights, weights + count, 1.0);
+        return static_cast<double>(count);
+    }
+
+    void updateLogWeightsBatch(const SimdKernels&, const double*, const double*, double* log_weights, const int64_t count, const double, const double) const
+    {
+        std::fill(log_weights, log_weights + count, 0.0);
+    }
+};
+
+class StateDimensionTests : public testing::Test
+{
+protected:
+    // Four beacons off one plane pin down a 3D position
+    template<int64_t D>
+    std::vector<BeaconReadingN<D>> readings(const StateN<D>& robot, const double sensor_std) const
+    {
+        std::vector<BeaconReadingN<D>> beacon_readings;
+        for (const std::array<double, 3>& position : {std::array<double, 3>{0.0, 0.0, 0.0}, std::array<double, 3>{100.0, 0.0, 0.0},
+                                                     std::array<double, 3>{0.0, 100.0, 0.0}, std::array<double, 3>{0.0, 0.0, 100.0}})
+        {
+            BeaconReadingN<D> reading;
+            StateN<D> relative = robot;
+            for (int64_t d = 0; d < 3; ++d)
+            {
+                reading.beacon[d] = position[d];
+                relative[d] -= position[d];
+            }
+            reading.observation = range3D(relative);
+            reading.sensor_std = sensor_std;
+            beacon_readings.push_back(reading);
+        }
+        return beacon_readings;
+    }
+
+    PF_Params paramsFor3D() const
+    {
+        PF_Params pf_params;
+        pf_params.num_of_particles = 20000;
+        pf_params.starting_state_lower_bound = {0.0, 0.0, 0.0};
+        pf_params.starting_state_upper_bound = {100.0, 100.0, 100.0};
+        pf_params.particle_propogation_std = {0.2, 0.2, 0.2};
+        return pf_params;
+    }
+
+    PF_Params paramsForConstantVelocity() const
+    {
+        PF_Params pf_params;
+        pf_params.num_of_particles = 50000;
+        pf_params.starting_state_lower_bound = {0.0, 0.0, 0.0, -2.0, -2.0, -2.0};
+        pf_params.starting_state_upper_bound = {100.0, 100.0, 100.0, 2.0, 2.0, 2.0};
+        pf_params.particle_propogation_std = {0.2, 0.2, 0.2, 0.05, 0.05, 0.05};
+        return pf_params;
+    }
+};
+
+class StateDimensionParamsTests: public StateDimensionTests, public testing::WithParamInterface<PF_THREAD_MODE> {};
+
+TEST_F(StateDimensionTests, TestTwoComponentStateKeepsItsNames)
+{
+    State state{3.0, 4.0};
+    EXPECT_EQ(state[0], 3.0);
+    EXPECT_EQ(state[1], 4.0);
+    state[1] = 5.0;
+    EXPECT_EQ(state.y, 5.0);
+    EXPECT_EQ(State::DIM, 2);
+
+    // Bigger states are zeroed unless told otherwise
+    const StateN<6> pose;
+    for (int64_t d = 0; d < 6; ++d)
+    {
+        EXPECT_EQ(pose[d], 0.0);
+    }
+    EXPECT_EQ(ParticleFilter<ConstantVelocityModel>::DIM, 6);
+}
+
+TEST_F(StateDimensionTests, TestBatchHooksAreOnlyUsedFor2DModels)
+{
+    static_assert(BatchWeightModel<DefaultModel> && BatchLogWeightModel<DefaultModel> && BatchMotionModel<DefaultModel>);
+    static_assert(!BatchWeightModel<PositionModel3DWithBatchHooks> && !BatchLogWeightModel<PositionModel3DWithBatchHooks>);
+
+    // The hooks are ignored, so the weights follow the 3D sensor exactly like the model without them
+    for (const bool log_domain : {false, true})
+    {
+        PF_Params pf_params = paramsFor3D();
+        pf_params.num_of_particles = 2000;
+        pf_params.thread_mode = PF_THREAD_MODE::SINGLE_THREADED;
+        pf_params.log_domain_weights = log_domain;
+        ParticleFilter<PositionModel3D> plain_pf{pf_params};
+        ParticleFilter<PositionModel3DWithBatchHooks> hooked_pf{pf_params};
+
+        const StateN<3> robot{30.0, 60.0, 20.0};
+        plain_pf.updateWeights(readings(robot, 5.0));
+        hooked_pf.updateWeights(readings(robot, 5.0));
+        EXPECT_LT(hooked_pf.getEffectiveSampleSize(), 0.5 * static_cast<double>(pf_params.num_of_particles));
+        EXPECT_EQ(hooked_pf.getEffectiveSampleSize(), plain_pf.getEffectiveSampleSize());
+        for (int64_t d = 0; d < 3; ++d)
+        {
+            EXPECT_EQ(hooked_pf.getXHat()[d], plain_pf.getXHat()[d]);
+        }
+    }
+}
+
+TEST_F(StateDimensionTests, TestParticlesStartInsideEveryBound)
+{
+    PF_Params pf_params = paramsForConstantVelocity();
+    pf_params.thread_mode = PF_THREAD_MODE::SINGLE_THREADED;
+    ParticleFilter<ConstantVelocityModel> test_pf{pf_params};
+
+    const auto& particles = test_pf.getParticles();
+    ASSERT_EQ(particles.size(), pf_params.num_of_particles);
+    for (int64_t d = 0; d < 6; ++d)
+    {
+        double mean = 0.0;
+        for (int64_t i = 0; i < particles.size(); ++i)
+        {
+            ASSERT_GE(particles.component(d)[i], pf_params.starting_state_lower_bound[d]);
+            ASSERT_LT(particles.component(d)[i], pf_params.starting_state_upper_bound[d]);
+            mean += particles.component(d)[i];
+        }
+        // Uniform, so about in the middle of each bound. Components come from different draws, not copies of each other.
+        mean /= static_cast<double>(particles.size());
+        const double middle = (pf_params.starting_state_lower_bound[d] + pf_params.starting_state_upper_bound[d]) / 2.0;
+        const double range = pf_params.starting_state_upper_bound[d] - pf_params.starting_state_lower_bound[d];
+        EXPECT_NEAR(mean, middle, 0.02 * range);
+        if (d > 0)
+        {
+            EXPECT_NE(particles.component(d)[0], particles.component(d - 1)[0]);
+        }
+    }
+}
+
+TEST_F(StateDimensionTests, TestSettingsMustMatchTheDimension)
+{
+    // The defaults are for the 2D model
+    EXPECT_THROW(ParticleFilter<PositionModel3D>{PF_Params{}}, std::invalid_argument);
+
+    PF_Params pf_params = paramsFor3D();
+    pf_params.num_of_particles = 100;
+    pf_params.thread_mode = PF_THREAD_MODE::SINGLE_THREADED;
+    ParticleFilter<PositionModel3D> test_pf{pf_params};
+    EXPECT_THROW(test_pf.mutateParticles({1.0, 1.0}), std::invalid_argument);
+
+    pf_params.particle_propogation_std = {1.0, 1.0};
+    EXPECT_THROW(ParticleFilter<PositionModel3D>{pf_params}, std::invalid_argument);
+
+    pf_params = paramsFor3D();
+    pf_params.adaptive_particle_count = true;
+    pf_params.kld_bin_size = {1.0, 1.0, 1.0, 1.0};
+    EXPECT_THROW(ParticleFilter<PositionModel3D>{pf_params}, std::invalid_argument);
+}
+
+TEST_P(StateDimensionParamsTests, TestBeaconsLocalizeA3DPosition)
+{
+    PF_Params pf_params = paramsFor3D();
+    pf_params.thread_mode = GetParam();
+    ParticleFilter<PositionModel3D> test_pf{pf_params};
+
+    StateN<3> robot{30.0, 60.0, 20.0};
+    const StateN<3> step{1.0, -0.5, 0.5};
+    for (int64_t i = 0; i < 15; ++i)
+    {
+        test_pf.updateWeights(readings(robot, 0.5));
+        test_pf.resample();
+        test_pf.mutateParticles(pf_params.particle_propogation_std);
+        test_pf.propogateState(step);
+        for (int64_t d = 0; d < 3; ++d)
+        {
+            robot[d] += step[d];
+        }
+    }
+    test_pf.updateWeights(readings(robot, 0.5));
+
+    const StateN<3> estimate = test_pf.getXHat();
+    for (int64_t d = 0; d < 3; ++d)
+    {
+        EXPECT_NEAR(estimate[d], robot[d], 0.5) << "component " << d;
+    }
+}
+
+TEST_P(StateDimensionParamsTests, TestConstantVelocityFilterFindsTheVelocity)
+{
+    PF_Params pf_params = paramsForConstantVelocity();
+    pf_params.thread_mode = GetParam();
+
+    // Range alone never sees the velocity, it shows up in how the position changes from step to step. Six components
+    // need far more particles to cover a wide start, so this one tracks from a rough fix instead.
+    pf_params.starting_state_lower_bound = {20.0, 50.0, 10.0, -2.0, -2.0, -2.0};
+    pf_params.starting_state_upper_bound = {40.0, 70.0, 30.0, 2.0, 2.0, 2.0};
+    ParticleFilter<ConstantVelocityModel> test_pf{pf_params};
+
+    StateN<6> robot{30.0, 60.0, 20.0, 1.0, -0.5, 0.5};
+    for (int64_t i = 0; i < 30; ++i)
+    {
+        test_pf.updateWeights(readings(robot, 0.5));
+        test_pf.resampleMutatePropagate(pf_params.particle_propogation_std, StateN<6>{});
+        for (int64_t d = 0; d < 3; ++d)
+        {
+            robot[d] += robot[d + 3];
+        }
+    }
+    test_pf.updateWeights(readings(robot, 0.5));
+
+    const StateN<6> estimate = test_pf.getXHat();
+    for (int64_t d = 0; d < 3; ++d)
+    {
+        EXPECT_NEAR(estimate[d], robot[d], 0.5) << "component " << d;
+        EXPECT_NEAR(estimate[d + 3], robot[d + 3], 0.1) << "component " << d + 3;
+    }
+}
+
+TEST_P(StateDimensionParamsTests, TestEveryThreadModeDrawsTheSameParticles)
+{
+    PF_Params pf_params = paramsForConstantVelocity();
+    pf_params.num_of_particles = 10000;
+    pf_params.thread_mode = PF_THREAD_MODE::SINGLE_THREADED;
+    ParticleFilter<ConstantVelocityModel> serial_pf{pf_params};
+    pf_params.thread_mode = GetParam();
+    ParticleFilter<ConstantVelocityModel> test_pf{pf_params};
+
+    const StateN<6> robot{30.0, 60.0, 20.0, 1.0, -0.5, 0.5};
+    for (ParticleFilter<ConstantVelocityModel>* pf : {&serial_pf, &test_pf})
+    {
+        pf->updateWeights(readings(robot, 5.0));
+        pf->resample();
+        pf->mutateParticles(pf_params.particle_propogation_std);
+        pf->propogateState(StateN<6>{});
+    }
+
+    for (int64_t d = 0; d < 6; ++d)
+    {
+        for (int64_t i = 0; i < pf_params.num_of_particles; ++i)
+        {
+            ASSERT_EQ(test_pf.getParticles().component(d)[i], serial_pf.getParticles().component(d)[i]) << "component " << d << " particle " << i;
+        }
+    }
+}
+
+TEST_P(StateDimensionParamsTests, TestAdaptiveParticleCountBinsThePositionOnly)
+{
+    PF_Params pf_params = paramsForConstantVelocity();
+    pf_params.thread_mode = GetParam();
+    pf_params.adaptive_particle_count = true;
+    pf_params.kld_min_particles = 500;
+    pf_params.kld_bin_size = {1.0, 1.0, 1.0}; // A 100^3 grid, binning the velocity as well would be 10^6 times that
+    ParticleFilter<ConstantVelocityModel> test_pf{pf_params};
+
+    const StateN<6> robot{30.0, 60.0, 20.0, 0.0, 0.0, 0.0};
+    for (int64_t i = 0; i < 10; ++i)
+    {
+        test_pf.updateWeights(readings(robot, 0.5));
+        test_pf.resample();
+        test_pf.mutateParticles(pf_params.particle_propogation_std);
+    }
+
+    // Converged on a few bins, so far fewer particles than the spread out start needed
+    EXPECT_LT(test_pf.getNumParticles(), pf_params.num_of_particles / 4);
+    EXPECT_GE(test_pf.getNumParticles(), pf_params.kld_min_particles);
+}
+
+INSTANTIATE_TEST_SUITE_P(TestSingleAndMultiThreaded, StateDimensionParamsTests, testing::Values(PF_THREAD_MODE::SINGLE_THREADED, PF_THREAD_MODE::MULTI_THREADED, PF_THREAD_MODE::AUTO));
@@ -39,6 +39,7 @@
 // SOFTWARE.
 
 #include <gtest/gtest.h>
+#include <cmath>
 
 #include "state_functions.hpp"
 
@@ -81,4 +82,49 @@ TEST(StateFunctionTest, TestMoveActualState)
     };
     EXPECT_NEAR(test_state.y, expected_final_waypoint.y, 1e-6);
     EXPECT_NEAR(test_state.y, expected_final_waypoint.y, 1e-6);
-}
\ No newline at end of file
+}
+
+TEST(StateFunctionTest, TestBatchFunctionsMatchScalar) 
+{
+    std::vector<State> states;
+    for (int64_t i = 0; i < 100; ++i)
+    {
+        states.push_back(generateWaypoint());
+    }
+    states.push_back(State{50.0, 50.0}); // Exactly on the waypoint
+    states.push_back(State{51.0, 50.0}); // Inside one step of the waypoint
+
+    std::vector<double> xs, ys;
+    for (const State& state : states)
+    {
+        xs.push_back(state.x);
+        ys.push_back(state.y);
+    }
+
+    std::vector<double> observations(states.size());
+    sensorFunctionBatch(xs.data(), ys.data(), observations.data(), states.size());
+
+    const State waypoint{50.0, 50.0};
+    moveEstimatedStateBatch(xs.data(), ys.data(), states.size(), waypoint);
+
+    for (int64_t i = 0; i < states.size(); ++i)
+    {
+        EXPECT_DOUBLE_EQ(observations[i], sensorFunction(states[i]));
+
+        moveEstimatedState(states[i], waypoint);
+        EXPECT_DOUBLE_EQ(xs[i], states[i].x);
+        EXPECT_DOUBLE_EQ(ys[i], states[i].y);
+    }
+}
+
+TEST(StateFunctionTest, TestLogLikelihoodMatchesLikelihood) 
+{
+    for (const double estimate : {10.0, 10.5, 12.0, 20.0})
+    {
+        EXPECT_NEAR(logLikelihoodFunction(10.0, estimate, 1.0), std::log(likelihoodFunction(10.0, estimate, 1.0)), 1e-12);
+    }
+
+    // Far enough out that the likelihood underflows, the log is still there to compare particles with
+    EXPECT_EQ(likelihoodFunction(10.0, 11.0, 1e-3), 0.0);
+    EXPECT_DOUBLE_EQ(logLikelihoodFunction(10.0, 11.0, 1e-3), -0.5e6);
+}
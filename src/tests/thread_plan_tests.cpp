@@ -0,0 +1,186 @@
+// Custom Non‑Commercial License
+
+// Copyright (c) 2025 Mgoodell97
+
+// Permission is hereby granted, free of charge, to any individual or
+// non‑commercial entity obtaining a copy of this software and associated
+// documentation files (the "Software"), to use, copy, modify, merge, publish,
+// and distribute the Software for personal, educational, or research purposes,
+// subject to the following conditions:
+
+// 1. Commercial Use:
+//    Any company, corporation, or organization intending to use the Software
+//    must first notify the copyright holder and obtain explicit written
+//    permission. Commercial use without such permission is strictly prohibited.
+
+// 2. Unauthorized Commercial Use:
+//    If a company is found to be using the Software without prior authorization,
+//    the copyright holder is entitled to receive 1% of the company’s gross
+//    profits moving forward, enforceable as a licensing fee.
+
+// 3. Artificial Intelligence / Machine Learning Use:
+//    If the Software is incorporated into machine learning
+//    models, neural networks, generative pre‑trained transformers (GPTs), or similar AI systems,
+//    the company deploying such use is solely responsible for compliance with
+//    this license. Responsibility cannot be shifted to the provider of training
+//    data or third‑party services.
+
+// 4. Attribution:
+//    The above copyright notice and this permission notice shall be included in
+//    all copies or substantial portions of the Software.
+
+// Disclaimer:
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+#include "thread_plan.hpp"
+#include "particle_filter.hpp"
+
+TEST(ThreadPlanTests, TestSaveAndLoadRoundTrip)
+{
+    PF_ThreadPlan plan;
+    plan.num_particles = 123456;
+    plan.num_threads = 12;
+    plan.resampling_scheme = 2;
+    plan.streaming_resample = true;
+    plan.log_domain_weights = true;
+    plan.adaptive_particle_count = true;
+    plan.metropolis_iterations = 16;
+    plan.pool_mode = 1;
+    plan.parallel_grain_size = 512;
+    plan.simd_level = 3;
+    plan.state_dim = 6;
+    plan.model = "13DefaultModel";
+    plan.host = currentHostName();
+    for (int stage = 0; stage < NUM_PF_STAGES; ++stage)
+    {
+        plan.stages[stage] = PF_StagePlan{stage % 2 == 0, 1000 * stage, 10.5 * (stage + 1)};
+    }
+
+    const std::filesystem::path filepath = std::filesystem::path("results") / "test_thread_plan_round_trip.txt";
+    plan.saveToFile(filepath);
+
+    PF_ThreadPlan loaded;
+    ASSERT_TRUE(loaded.loadFromFile(filepath));
+    EXPECT_EQ(loaded.num_particles, plan.num_particles);
+    EXPECT_EQ(loaded.num_threads, plan.num_threads);
+    EXPECT_EQ(loaded.resampling_scheme, plan.resampling_scheme);
+    EXPECT_TRUE(loaded.sameSetupAs(plan));
+    EXPECT_EQ(loaded.metropolis_iterations, plan.metropolis_iterations);
+    EXPECT_EQ(loaded.pool_mode, plan.pool_mode);
+    EXPECT_EQ(loaded.parallel_grain_size, plan.parallel_grain_size);
+    EXPECT_EQ(loaded.model, plan.model);
+    EXPECT_EQ(loaded.host, plan.host);
+    for (int stage = 0; stage < NUM_PF_STAGES; ++stage)
+    {
+        EXPECT_EQ(loaded.stages[stage].parallel, plan.stages[stage].parallel);
+        EXPECT_EQ(loaded.stages[stage].grain_size, plan.stages[stage].grain_size);
+        EXPECT_DOUBLE_EQ(loaded.stages[stage].time_us, plan.stages[stage].time_us);
+    }
+
+    // Cleanup
+    std::filesystem::remove(filepath);
+}
+
+TEST(ThreadPlanTests, TestLoadRejectsMissingAndBrokenFiles)
+{
+    PF_ThreadPlan plan;
+    plan.num_particles = 42;
+    EXPECT_FALSE(plan.loadFromFile(std::filesystem::path("results") / "no_such_thread_plan.txt"));
+
+    // Stages out of order, nothing is taken from it
+    const std::filesystem::path filepath = std::filesystem::path("results") / "test_thread_plan_broken.txt";
+    std::filesystem::create_directories(filepath.parent_path());
+    std::ofstream(filepath) << "num_particles 7\nnum_threads 1\nresampling_scheme 0\nweights 1 0 1.0\n";
+    EXPECT_FALSE(plan.loadFromFile(filepath));
+    EXPECT_EQ(plan.num_particles, 42);
+
+    // Cleanup
+    std::filesystem::remove(filepath);
+}
+
+TEST(ThreadPlanTests, TestEverySetupFieldMustMatch)
+{
+    PF_ThreadPlan plan;
+    plan.num_particles = 1000;
+    plan.num_threads = 4;
+    plan.state_dim = 2;
+    plan.model = "13DefaultModel";
+    plan.host = "robot";
+    EXPECT_TRUE(plan.sameSetupAs(plan));
+
+    // Each of these changes what a stage runs, or where
+    const std::vector<void(*)(PF_ThreadPlan&)> changes{
+        [](PF_ThreadPlan& other) { other.num_particles = 2000; },
+        [](PF_ThreadPlan& other) { other.num_threads = 8; },
+        [](PF_ThreadPlan& other) { other.resampling_scheme = 1; },
+        [](PF_ThreadPlan& other) { other.streaming_resample = true; },
+        [](PF_ThreadPlan& other) { other.log_domain_weights = true; },
+        [](PF_ThreadPlan& other) { other.adaptive_particle_count = true; },
+        [](PF_ThreadPlan& other) { other.metropolis_iterations = 32; },
+        [](PF_ThreadPlan& other) { other.pool_mode = 1; },
+        [](PF_ThreadPlan& other) { other.parallel_grain_size = 4096; },
+        [](PF_ThreadPlan& other) { other.simd_level = 1; },
+        [](PF_ThreadPlan& other) { other.state_dim = 3; },
+        [](PF_ThreadPlan& other) { other.model = "13FunctionModel"; },
+        [](PF_ThreadPlan& other) { other.host = "laptop"; }
+    };
+    for (size_t i = 0; i < changes.size(); ++i)
+    {
+        PF_ThreadPlan other = plan;
+        changes[i](other);
+        EXPECT_FALSE(other.sameSetupAs(plan)) << "change " << i;
+    }
+}
+
+TEST(ThreadPlanTests, TestMetropolisIterationsRecalibrate)
+{
+    PF_Params pf_params;
+    pf_params.num_of_particles = 5000;
+    pf_params.thread_mode = PF_THREAD_MODE::AUTO;
+    pf_params.resampling_scheme = PF_RESAMPLING_SCHEME::METROPOLIS;
+    pf_params.metropolis_iterations = 1;
+    pf_params.thread_plan_file = std::filesystem::path("results") / "test_thread_plan_metropolis.txt";
+    std::filesystem::remove(pf_params.thread_plan_file);
+
+    const ParticleFilter short_chain_pf{pf_params, &likelihoodFunction, &moveEstimatedState};
+    PF_ThreadPlan saved_plan;
+    ASSERT_TRUE(saved_plan.loadFromFile(pf_params.thread_plan_file));
+    EXPECT_EQ(saved_plan.metropolis_iterations, 1);
+
+    // Resampling costs 32 times as much now, the plan timed on a chain of 1 isn't reused
+    pf_params.metropolis_iterations = 32;
+    const ParticleFilter long_chain_pf{pf_params, &likelihoodFunction, &moveEstimatedState};
+    EXPECT_EQ(long_chain_pf.getThreadPlan().metropolis_iterations, 32);
+    ASSERT_TRUE(saved_plan.loadFromFile(pf_params.thread_plan_file));
+    EXPECT_EQ(saved_plan.metropolis_iterations, 32);
+    EXPECT_FALSE(saved_plan.sameSetupAs(short_chain_pf.getThreadPlan()));
+
+    // Cleanup
+    std::filesystem::remove(pf_params.thread_plan_file);
+}
+
+TEST(ThreadPlanTests, TestToStringNamesEveryStage)
+{
+    PF_ThreadPlan plan;
+    plan[PF_STAGE::STAGE_WEIGHTS] = PF_StagePlan{true, 0, 0.0};
+    plan[PF_STAGE::STAGE_MUTATE] = PF_StagePlan{true, 4096, 12.0};
+    const std::string text = plan.toString();
+    for (int stage = 0; stage < NUM_PF_STAGES; ++stage)
+    {
+        EXPECT_NE(text.find(stageName(static_cast<PF_STAGE>(stage))), std::string::npos);
+    }
+    EXPECT_NE(text.find("parallel, grain auto"), std::string::npos);
+    EXPECT_NE(text.find("parallel, grain 4096 (12.0 us)"), std::string::npos);
+    EXPECT_NE(text.find("serial"), std::string::npos);
+}
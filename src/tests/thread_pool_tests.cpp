@@ -0,0 +1,401 @@
+// Custom Non‑Commercial License
+
+// Copyright (c) 2025 Mgoodell97
+
+// Permission is hereby granted, free of charge, to any individual or
+// non‑commercial entity obtaining a copy of this software and associated
+// documentation files (the "Software"), to use, copy, modify, merge, publish,
+// and distribute the Software for personal, educational, or research purposes,
+// subject to the following conditions:
+
+// 1. Commercial Use:
+//    Any company, corporation, or organization intending to use the Software
+//    must first notify the copyright holder and obtain explicit written
+//    permission. Commercial use without such permission is strictly prohibited.
+
+// 2. Unauthorized Commercial Use:
+//    If a company is found to be using the Software without prior authorization,
+//    the copyright holder is entitled to receive 1% of the company’s gross
+//    profits moving forward, enforceable as a licensing fee.
+
+// 3. Artificial Intelligence / Machine Learning Use:
+//    If the Software is incorporated into machine learning
+//    models, neural networks, generative pre‑trained transformers (GPTs), or similar AI systems,
+//    the company deploying such use is solely responsible for compliance with
+//    this license. Responsibility cannot be shifted to the provider of training
+//    data or third‑party services.
+
+// 4. Attribution:
+//    The above copyright notice and this permission notice shall be included in
+//    all copies or substantial portions of the Software.
+
+// Disclaimer:
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <gtest/gtest.h>
+#include <numeric>
+#include <random>
+#include <cstring>
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+#include "thread_pool.hpp"
+
+class ThreadPoolParamsTests: public testing::TestWithParam<THREAD_POOL_MODE> {};
+
+TEST(WorkStealingDequeTests, TestOwnerIsLifoAndThievesAreFifo)
+{
+    WorkStealingDeque<int> deque{8};
+    int items[3] = {0, 1, 2};
+    for (int& item : items)
+    {
+        ASSERT_TRUE(deque.push(&item));
+    }
+    EXPECT_EQ(deque.size(), 3);
+
+    EXPECT_EQ(deque.steal(), &items[0]);
+    EXPECT_EQ(deque.pop(), &items[2]);
+    EXPECT_EQ(deque.pop(), &items[1]);
+    EXPECT_EQ(deque.pop(), nullptr);
+    EXPECT_EQ(deque.steal(), nullptr);
+}
+
+TEST(WorkStealingDequeTests, TestPushFailsWhenFull)
+{
+    WorkStealingDeque<int> deque{2};
+    int items[3] = {0, 1, 2};
+    EXPECT_TRUE(deque.push(&items[0]));
+    EXPECT_TRUE(deque.push(&items[1]));
+    EXPECT_FALSE(deque.push(&items[2]));
+
+    // Stealing frees up a slot again
+    EXPECT_EQ(deque.steal(), &items[0]);
+    EXPECT_TRUE(deque.push(&items[2]));
+}
+
+TEST_P(ThreadPoolParamsTests, TestAddTaskReturnsResults)
+{
+    ThreadPool pool{4, GetParam()};
+
+    std::vector<std::future<int64_t>> futures;
+    for (int64_t i = 0; i < 1000; ++i)
+    {
+        futures.push_back(pool.AddTask([](const int64_t value) { return value * 2; }, i));
+    }
+
+    int64_t sum = 0;
+    for (auto& future : futures)
+    {
+        sum += future.get();
+    }
+    EXPECT_EQ(sum, 999 * 1000);
+}
+
+TEST_P(ThreadPoolParamsTests, TestWaitUntilAllTasksFinished)
+{
+    ThreadPool pool{4, GetParam()};
+
+    std::atomic<int64_t> counter{0};
+    for (int64_t i = 0; i < 1000; ++i)
+    {
+        pool.AddTask([&counter]() { counter++; });
+    }
+    pool.waitUntilAllTasksFinished();
+
+    EXPECT_EQ(counter.load(), 1000);
+    EXPECT_EQ(pool.getQueueSize(), 0);
+}
+
+TEST_P(ThreadPoolParamsTests, TestTasksCanSubmitTasks)
+{
+    ThreadPool pool{4, GetParam()};
+
+    std::atomic<int64_t> counter{0};
+    for (int64_t i = 0; i < 100; ++i)
+    {
+        pool.AddTask([&pool, &counter]()
+        {
+            for (int64_t j = 0; j < 100; ++j)
+            {
+                pool.AddTask([&counter]() { counter++; });
+            }
+        });
+    }
+
+    // Children are submitted before their parent finishes so the unfinished count never hits zero early
+    pool.waitUntilAllTasksFinished();
+    EXPECT_EQ(counter.load(), 100 * 100);
+}
+
+TEST_P(ThreadPoolParamsTests, TestShutdownDrainsQueue)
+{
+    std::atomic<int64_t> counter{0};
+    {
+        ThreadPool pool{2, GetParam()};
+        for (int64_t i = 0; i < 1000; ++i)
+        {
+            pool.AddTask([&counter]() { counter++; });
+        }
+    }
+    EXPECT_EQ(counter.load(), 1000);
+}
+
+TEST_P(ThreadPoolParamsTests, TestTaskGroupWaitsForItsOwnTasks)
+{
+    ThreadPool pool{4, GetParam()};
+
+    std::vector<int64_t> results(1000, 0);
+    ThreadPool::TaskGroup task_group{pool};
+    for (int64_t i = 0; i < results.size(); ++i)
+    {
+        task_group.AddTask([&results](const int64_t index) { results[index] = index; }, i);
+    }
+    task_group.wait();
+
+    for (int64_t i = 0; i < results.size(); ++i)
+    {
+        EXPECT_EQ(results[i], i);
+    }
+}
+
+TEST_P(ThreadPoolParamsTests, TestTaskGroupIgnoresUnrelatedTasks)
+{
+    ThreadPool pool{2, GetParam()};
+
+    // Keep one worker busy until the group is done, waitUntilAllTasksFinished would hang here
+    std::atomic<bool> release_blocker{false};
+    pool.AddTask([&release_blocker]()
+    {
+        while (!release_blocker.load())
+        {
+            std::this_thread::yield();
+        }
+    });
+
+    std::atomic<int64_t> counter{0};
+    {
+        ThreadPool::TaskGroup task_group{pool};
+        for (int64_t i = 0; i < 100; ++i)
+        {
+            task_group.AddTask([&counter]() { counter++; });
+        }
+        task_group.wait();
+    }
+    EXPECT_EQ(counter.load(), 100);
+
+    release_blocker = true;
+    pool.waitUntilAllTasksFinished();
+}
+
+TEST_P(ThreadPoolParamsTests, TestNestedTaskGroupsDoNotDeadlock)
+{
+    // Fewer workers than outer tasks, every outer task blocks on its own inner group
+    ThreadPool pool{2, GetParam()};
+
+    std::atomic<int64_t> counter{0};
+    ThreadPool::TaskGroup outer_group{pool};
+    for (int64_t i = 0; i < 8; ++i)
+    {
+        outer_group.AddTask([&pool, &counter]()
+        {
+            ThreadPool::TaskGroup inner_group{pool};
+            for (int64_t j = 0; j < 8; ++j)
+            {
+                inner_group.AddTask([&counter]() { counter++; });
+            }
+            inner_group.wait();
+        });
+    }
+    outer_group.wait();
+    EXPECT_EQ(counter.load(), 64);
+}
+
+TEST_P(ThreadPoolParamsTests, TestParallelForVisitsEveryIndexOnce)
+{
+    ThreadPool pool{4, GetParam()};
+
+    for (const int64_t grain : {0, 1, 7, 1000, 5000})
+    {
+        std::vector<std::atomic<int64_t>> visits(3001);
+        pool.parallel_for(1, visits.size(), grain, [&visits](const int64_t start_index, const int64_t end_index)
+        {
+            for (int64_t i = start_index; i < end_index; ++i)
+            {
+                visits[i]++;
+            }
+        });
+
+        EXPECT_EQ(visits[0].load(), 0);
+        for (int64_t i = 1; i < visits.size(); ++i)
+        {
+            EXPECT_EQ(visits[i].load(), 1) << "grain " << grain << " index " << i;
+        }
+    }
+}
+
+TEST_P(ThreadPoolParamsTests, TestParallelForChunksFollowGrain)
+{
+    ThreadPool pool{4, GetParam()};
+
+    const int64_t grain = 64;
+    std::atomic<int64_t> bad_chunks{0};
+    pool.parallel_for(0, 1000, grain, [&bad_chunks, grain](const int64_t start_index, const int64_t end_index)
+    {
+        if (start_index % grain != 0 || (end_index - start_index != grain && end_index != 1000))
+        {
+            bad_chunks++;
+        }
+    });
+    EXPECT_EQ(bad_chunks.load(), 0);
+
+    // Empty ranges never call fn
+    pool.parallel_for(10, 10, grain, [&bad_chunks](const int64_t, const int64_t) { bad_chunks++; });
+    EXPECT_EQ(bad_chunks.load(), 0);
+}
+
+TEST_P(ThreadPoolParamsTests, TestParallelReduce)
+{
+    ThreadPool pool{4, GetParam()};
+
+    std::vector<int64_t> values(100000);
+    std::iota(values.begin(), values.end(), 0);
+
+    auto localSum = [&values](const int64_t start_index, const int64_t end_index)
+    {
+        return std::accumulate(values.begin() + start_index, values.begin() + end_index, int64_t{0});
+    };
+
+    for (const int64_t grain : {0, 1, 333, 200000})
+    {
+        const int64_t sum = pool.parallel_reduce(0, values.size(), grain, int64_t{0}, localSum, std::plus<int64_t>());
+        EXPECT_EQ(sum, int64_t{99999} * 100000 / 2);
+    }
+    EXPECT_EQ(pool.parallel_reduce(5, 5, 0, int64_t{42}, localSum, std::plus<int64_t>()), 42);
+}
+
+TEST_P(ThreadPoolParamsTests, TestParallelPairwiseReduceIsBitIdentical)
+{
+    // Values over many orders of magnitude so a different summation order would almost surely round differently
+    std::mt19937_64 generator{7};
+    std::uniform_real_distribution<double> exponent{-12.0, 12.0};
+    std::vector<double> values(300001);
+    for (double& value : values)
+    {
+        value = std::pow(10.0, exponent(generator));
+    }
+
+    auto localSum = [&values](const int64_t start_index, const int64_t end_index)
+    {
+        return std::accumulate(values.begin() + start_index, values.begin() + end_index, 0.0);
+    };
+
+    const double serial_sum = pairwiseReduce(0, values.size(), 1000, 0.0, localSum, std::plus<double>());
+    for (const int64_t num_threads : {1, 2, 3, 8})
+    {
+        ThreadPool pool{num_threads, GetParam()};
+        for (const int64_t grain : {0, 1, 4096, 77777, 1000000})
+        {
+            const double sum = pool.parallel_pairwise_reduce(0, values.size(), 1000, grain, 0.0, localSum, std::plus<double>());
+            EXPECT_EQ(std::memcmp(&sum, &serial_sum, sizeof(double)), 0) << num_threads << " threads, grain " << grain;
+        }
+        EXPECT_EQ(pool.parallel_pairwise_reduce(5, 5, 1000, 0, 42.0, localSum, std::plus<double>()), 42.0);
+    }
+    EXPECT_NEAR(serial_sum, std::accumulate(values.begin(), values.end(), 0.0), 1e-9 * serial_sum);
+}
+
+TEST_P(ThreadPoolParamsTests, TestParallelScanIsBitIdentical)
+{
+    std::mt19937_64 generator{11};
+    std::uniform_real_distribution<double> exponent{-12.0, 12.0};
+    std::vector<double> values(250007);
+    for (double& value : values)
+    {
+        value = std::pow(10.0, exponent(generator));
+    }
+
+    // Reference with the same shape, a serial scan per block plus the running total of the blocks before it
+    constexpr int64_t BLOCK_SIZE = 1000;
+    std::vector<double> expected(values.size());
+    double block_offset = 0.0;
+    for (int64_t block_start = 0; block_start < static_cast<int64_t>(values.size()); block_start += BLOCK_SIZE)
+    {
+        const int64_t block_end = std::min<int64_t>(block_start + BLOCK_SIZE, values.size());
+        double block_sum = 0.0;
+        for (int64_t i = block_start; i < block_end; ++i)
+        {
+            block_sum += values[i];
+            expected[i] = block_start > 0 ? block_sum + block_offset : block_sum;
+        }
+        block_offset += block_sum;
+    }
+
+    std::vector<double> scanned(values.size());
+    auto scanBlock = [&](const int64_t block_begin, const int64_t block_end)
+    {
+        double block_sum = 0.0;
+        for (int64_t i = block_begin; i < block_end; ++i)
+        {
+            block_sum += values[i];
+            scanned[i] = block_sum;
+        }
+        return block_sum;
+    };
+    auto addOffset = [&](const int64_t block_begin, const int64_t block_end, const double offset)
+    {
+        for (int64_t i = block_begin; i < block_end; ++i)
+        {
+            scanned[i] += offset;
+        }
+    };
+
+    // The same states across pools and repeats, stale flags from the last scan must not be picked up
+    ScanBlockStates<double> states;
+    for (const int64_t num_threads : {1, 2, 3, 8})
+    {
+        ThreadPool pool{num_threads, GetParam()};
+        for (int repeat = 0; repeat < 3; ++repeat)
+        {
+            std::fill(scanned.begin(), scanned.end(), -1.0);
+            pool.parallel_scan(values.size(), BLOCK_SIZE, states, scanBlock, addOffset, std::plus<double>());
+            ASSERT_EQ(std::memcmp(scanned.data(), expected.data(), values.size() * sizeof(double)), 0) << num_threads << " threads";
+        }
+    }
+
+    // Nothing to scan, nothing called
+    ThreadPool pool{2, GetParam()};
+    pool.parallel_scan(0, BLOCK_SIZE, states, scanBlock, addOffset, std::plus<double>());
+}
+
+TEST_P(ThreadPoolParamsTests, TestPinnedWorkersStayOnTheirCpu)
+{
+#ifdef __linux__
+    const std::vector<int> cpus = ThreadPool::availableCpus();
+    ASSERT_FALSE(cpus.empty());
+
+    // Worker i is pinned to worker_cpus[i % size], so with a single CPU listed every worker shares it
+    ThreadPool pool{3, GetParam(), {cpus.back()}};
+    std::atomic<int> tasks_off_cpu{0};
+    for (int64_t i = 0; i < 200; ++i)
+    {
+        pool.AddTask([&]()
+        {
+            if (sched_getcpu() != cpus.back())
+            {
+                tasks_off_cpu.fetch_add(1);
+            }
+        }).wait();
+    }
+    EXPECT_EQ(tasks_off_cpu.load(), 0);
+#else
+    GTEST_SKIP() << "Pinning is Linux only";
+#endif
+}
+
+INSTANTIATE_TEST_SUITE_P(TestWorkStealingAndSharedQueue, ThreadPoolParamsTests, testing::Values(THREAD_POOL_MODE::WORK_STEALING, THREAD_POOL_MODE::SHARED_QUEUE));
@@ -0,0 +1,180 @@
+// Custom Non‑Commercial License
+
+// Copyright (c) 2025 Mgoodell97
+
+// Permission is hereby granted, free of charge, to any individual or
+// non‑commercial entity obtaining a copy of this software and associated
+// documentation files (the "Software"), to use, copy, modify, merge, publish,
+// and distribute the Software for personal, educational, or research purposes,
+// subject to the following conditions:
+
+// 1. Commercial Use:
+//    Any company, corporation, or organization intending to use the Software
+//    must first notify the copyright holder and obtain explicit written
+//    permission. Commercial use without such permission is strictly prohibited.
+
+// 2. Unauthorized Commercial Use:
+//    If a company is found to be using the Software without prior authorization,
+//    the copyright holder is entitled to receive 1% of the company’s gross
+//    profits moving forward, enforceable as a licensing fee.
+
+// 3. Artificial Intelligence / Machine Learning Use:
+//    If the Software is incorporated into machine learning
+//    models, neural networks, generative pre‑trained transformers (GPTs), or similar AI systems,
+//    the company deploying such use is solely responsible for compliance with
+//    this license. Responsibility cannot be shifted to the provider of training
+//    data or third‑party services.
+
+// 4. Attribution:
+//    The above copyright notice and this permission notice shall be included in
+//    all copies or substantial portions of the Software.
+
+// Disclaimer:
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <limits>
+
+#include "thread_plan.hpp"
+
+#if defined(__linux__) || defined(__APPLE__)
+    #include <unistd.h>
+#endif
+
+const char* stageName(const PF_STAGE stage)
+{
+    switch(stage)
+    {
+        case PF_STAGE::STAGE_INITIALIZE: return "initialize";
+        case PF_STAGE::STAGE_WEIGHTS:    return "weights";
+        case PF_STAGE::STAGE_ESTIMATE:   return "estimate";
+        case PF_STAGE::STAGE_SCAN:       return "scan";
+        case PF_STAGE::STAGE_RESAMPLE:   return "resample";
+        case PF_STAGE::STAGE_MUTATE:     return "mutate";
+        case PF_STAGE::STAGE_PROPAGATE:  return "propagate";
+        case PF_STAGE::NUM_PF_STAGES:    break;
+    }
+    return "unknown";
+}
+
+std::string currentHostName()
+{
+#if defined(__linux__) || defined(__APPLE__)
+    char name[256] = {};
+    if (gethostname(name, sizeof(name) - 1) == 0 && name[0] != '\0')
+    {
+        return name;
+    }
+#endif
+    return "unknown";
+}
+
+bool PF_ThreadPlan::sameSetupAs(const PF_ThreadPlan& other) const
+{
+    return num_particles == other.num_particles && num_threads == other.num_threads && resampling_scheme == other.resampling_scheme &&
+           streaming_resample == other.streaming_resample && log_domain_weights == other.log_domain_weights &&
+           adaptive_particle_count == other.adaptive_particle_count && metropolis_iterations == other.metropolis_iterations &&
+           pool_mode == other.pool_mode && parallel_grain_size == other.parallel_grain_size && simd_level == other.simd_level &&
+           state_dim == other.state_dim && model == other.model && host == other.host;
+}
+
+std::string PF_ThreadPlan::toString() const
+{
+    std::ostringstream out;
+    out << "thread plan for " << num_particles << " particles on " << num_threads << " threads\n";
+    out << std::fixed << std::setprecision(1);
+    for (int stage = 0; stage < NUM_PF_STAGES; ++stage)
+    {
+        const PF_StagePlan& stage_plan = stages[stage];
+        out << "  " << std::left << std::setw(12) << stageName(static_cast<PF_STAGE>(stage)) << std::right;
+        if (stage_plan.parallel)
+        {
+            out << "parallel, grain " << (stage_plan.grain_size > 0 ? std::to_string(stage_plan.grain_size) : std::string("auto"));
+        }
+        else
+        {
+            out << "serial";
+        }
+        if (stage_plan.time_us > 0.0)
+        {
+            out << " (" << stage_plan.time_us << " us)";
+        }
+        out << "\n";
+    }
+    return out.str();
+}
+
+void PF_ThreadPlan::saveToFile(const std::filesystem::path& filepath) const
+{
+    if (filepath.has_parent_path())
+    {
+        std::filesystem::create_directories(filepath.parent_path());
+    }
+
+    std::ofstream file(filepath);
+    if (!file.is_open())
+    {
+        std::cerr << "Error opening file: " << filepath << std::endl;
+        return;
+    }
+
+    file << std::setprecision(std::numeric_limits<double>::max_digits10); // Times read back exactly
+    file << "num_particles " << num_particles << "\n";
+    file << "num_threads " << num_threads << "\n";
+    file << "resampling_scheme " << resampling_scheme << "\n";
+    file << "streaming_resample " << streaming_resample << "\n";
+    file << "log_domain_weights " << log_domain_weights << "\n";
+    file << "adaptive_particle_count " << adaptive_particle_count << "\n";
+    file << "metropolis_iterations " << metropolis_iterations << "\n";
+    file << "pool_mode " << pool_mode << "\n";
+    file << "parallel_grain_size " << parallel_grain_size << "\n";
+    file << "simd_level " << simd_level << "\n";
+    file << "state_dim " << state_dim << "\n";
+    file << "model " << (model.empty() ? "-" : model) << "\n"; // A word either way, so the file still reads back
+    file << "host " << (host.empty() ? "-" : host) << "\n";
+    for (int stage = 0; stage < NUM_PF_STAGES; ++stage)
+    {
+        file << stageName(static_cast<PF_STAGE>(stage)) << " " << stages[stage].parallel << " " << stages[stage].grain_size << " " << stages[stage].time_us << "\n";
+    }
+}
+
+bool PF_ThreadPlan::loadFromFile(const std::filesystem::path& filepath)
+{
+    std::ifstream file(filepath);
+    if (!file.is_open())
+    {
+        return false;
+    }
+
+    PF_ThreadPlan plan;
+    std::string name;
+    file >> name >> plan.num_particles >> name >> plan.num_threads >> name >> plan.resampling_scheme;
+    file >> name >> plan.streaming_resample >> name >> plan.log_domain_weights >> name >> plan.adaptive_particle_count;
+    file >> name >> plan.metropolis_iterations >> name >> plan.pool_mode >> name >> plan.parallel_grain_size;
+    file >> name >> plan.simd_level >> name >> plan.state_dim >> name >> plan.model >> name >> plan.host;
+    if (!file || name != "host")
+    {
+        return false;
+    }
+    plan.model = plan.model == "-" ? std::string{} : plan.model;
+    plan.host = plan.host == "-" ? std::string{} : plan.host;
+    for (int stage = 0; stage < NUM_PF_STAGES; ++stage)
+    {
+        file >> name >> plan.stages[stage].parallel >> plan.stages[stage].grain_size >> plan.stages[stage].time_us;
+        if (!file || name != stageName(static_cast<PF_STAGE>(stage)))
+        {
+            return false;
+        }
+    }
+    *this = plan;
+    return true;
+}
@@ -0,0 +1,108 @@
+// Custom Non‑Commercial License
+
+// Copyright (c) 2025 Mgoodell97
+
+// Permission is hereby granted, free of charge, to any individual or
+// non‑commercial entity obtaining a copy of this software and associated
+// documentation files (the "Software"), to use, copy, modify, merge, publish,
+// and distribute the Software for personal, educational, or research purposes,
+// subject to the following conditions:
+
+// 1. Commercial Use:
+//    Any company, corporation, or organization intending to use the Software
+//    must first notify the copyright holder and obtain explicit written
+//    permission. Commercial use without such permission is strictly prohibited.
+
+// 2. Unauthorized Commercial Use:
+//    If a company is found to be using the Software without prior authorization,
+//    the copyright holder is entitled to receive 1% of the company’s gross
+//    profits moving forward, enforceable as a licensing fee.
+
+// 3. Artificial Intelligence / Machine Learning Use:
+//    If the Software is incorporated into machine learning
+//    models, neural networks, generative pre‑trained transformers (GPTs), or similar AI systems,
+//    the company deploying such use is solely responsible for compliance with
+//    this license. Responsibility cannot be shifted to the provider of training
+//    data or third‑party services.
+
+// 4. Attribution:
+//    The above copyright notice and this permission notice shall be included in
+//    all copies or substantial portions of the Software.
+
+// Disclaimer:
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+// The parts of a filter step that are each run either serially or on the pool, see PF_ThreadPlan
+enum PF_STAGE
+{
+    STAGE_INITIALIZE, // Drawing the starting particles
+    STAGE_WEIGHTS,    // updateWeights
+    STAGE_ESTIMATE,   // getXHat
+    STAGE_SCAN,       // Prefix sum of the weights for systematic, stratified and residual resampling
+    STAGE_RESAMPLE,   // Picking the ancestors and gathering them
+    STAGE_MUTATE,     // mutateParticles, and the gather + noise + motion pass of resampleMutatePropagate
+    STAGE_PROPAGATE,  // propogateState
+    NUM_PF_STAGES
+};
+
+const char* stageName(const PF_STAGE stage);
+
+// Name of this machine, so a plan file carried over to another one is recalibrated rather than trusted
+std::string currentHostName();
+
+struct PF_StagePlan
+{
+    bool parallel{false};
+    int64_t grain_size{0}; // Particles per parallel_for chunk when parallel, 0 lets the thread pool pick
+    double time_us{0.0};   // What calibration measured for this choice, 0 when it wasn't calibrated
+};
+
+// Serial or parallel, and the grain, for every stage. SINGLE_THREADED and MULTI_THREADED fill it with the same choice
+// for every stage, AUTO times each stage both ways at construction and keeps the faster. The plan only changes speed,
+// the reductions and random numbers don't depend on it so the particles are the same whatever it says.
+struct PF_ThreadPlan
+{
+    std::array<PF_StagePlan, NUM_PF_STAGES> stages{};
+
+    // What the plan was calibrated for, a cached plan is only reused when every one of these matches (sameSetupAs).
+    // Together they decide what each stage actually runs, and the host what it runs on.
+    int64_t num_particles{0};
+    int64_t num_threads{0};
+    int64_t resampling_scheme{0};
+    bool streaming_resample{false};
+    bool log_domain_weights{false};
+    bool adaptive_particle_count{false};
+    int64_t metropolis_iterations{0}; // Resampling cost grows with it under METROPOLIS
+    int64_t pool_mode{0};             // THREAD_POOL_MODE of the pool the stages were timed on
+    int64_t parallel_grain_size{0};   // The grain the "pool default" candidate ran with
+    int64_t simd_level{0};
+    int64_t state_dim{0};
+    std::string model{}; // typeid name of the filter's model
+    std::string host{};  // See currentHostName
+
+    bool sameSetupAs(const PF_ThreadPlan& other) const;
+
+    const PF_StagePlan& operator[](const PF_STAGE stage) const { return stages[stage]; }
+    PF_StagePlan& operator[](const PF_STAGE stage) { return stages[stage]; }
+
+    // One line per stage, for logs
+    std::string toString() const;
+
+    // Plain text, one "name value" line per setup field and then one "stage parallel grain_size time_us" line per stage
+    void saveToFile(const std::filesystem::path& filepath) const;
+    // False when the file is missing or unreadable, the plan is left as it was
+    bool loadFromFile(const std::filesystem::path& filepath);
+};
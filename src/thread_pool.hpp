@@ -45,19 +45,325 @@
 #include <thread>
 #include <vector>
 #include <queue>
+#include <deque>
 #include <functional>
 #include <cmath>
 #include <atomic>
+#include <memory>
+#include <algorithm>
+#include <new>
+#include <cstddef>
+#include <array>
+#include <type_traits>
+#include <bit>
+
+#ifdef __linux__
+    #include <pthread.h>
+    #include <sched.h>
+#endif
+
+// Tell the CPU we are in a spin loop (saves power and frees the pipeline for the SMT sibling)
+inline void cpuRelax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#else
+    std::this_thread::yield();
+#endif
+}
+
+enum THREAD_POOL_MODE
+{
+    WORK_STEALING, // Every worker owns a lock-free deque and idle workers steal from the others
+    SHARED_QUEUE   // Every worker pops from one mutex guarded queue
+};
+
+// Chase-Lev work stealing deque (fixed capacity version of "Correct and Efficient Work-Stealing for Weak Memory Models", Le et al. 2013)
+// Only the owning worker may push() and pop() from the bottom, any thread may steal() from the top.
+// Items are raw pointers so a slot can be read and written atomically.
+template<typename T>
+class WorkStealingDeque
+{
+public:
+    // capacity must be a power of two so we can mask instead of mod
+    explicit WorkStealingDeque(const int64_t capacity) : m_capacity(capacity), m_mask(capacity - 1), m_buffer(new std::atomic<T*>[capacity])
+    {
+    }
+
+    WorkStealingDeque(const WorkStealingDeque&) = delete;
+    WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+    // Owner only. Returns false when the deque is full so the caller can fall back to another queue
+    bool push(T* item)
+    {
+        const int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+        const int64_t top    = m_top.load(std::memory_order_acquire);
+        if (bottom - top >= m_capacity)
+        {
+            return false;
+        }
+        m_buffer[bottom & m_mask].store(item, std::memory_order_relaxed);
+        m_bottom.store(bottom + 1, std::memory_order_release); // Publishes the item to thieves
+        return true;
+    }
+
+    // Owner only. LIFO end, the most recently pushed task is still hot in cache
+    T* pop()
+    {
+        const int64_t bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+        // seq_cst store then load instead of a standalone fence, same StoreLoad ordering but ThreadSanitizer understands it
+        m_bottom.store(bottom, std::memory_order_seq_cst);
+        int64_t top = m_top.load(std::memory_order_seq_cst);
+
+        if (top > bottom) // Empty
+        {
+            m_bottom.store(bottom + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        T* item = m_buffer[bottom & m_mask].load(std::memory_order_relaxed);
+        if (top == bottom) // Last item, we have to race the thieves for it
+        {
+            if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            {
+                item = nullptr; // A thief won
+            }
+            m_bottom.store(bottom + 1, std::memory_order_relaxed);
+        }
+        return item;
+    }
+
+    // Any thread. FIFO end, returns nullptr if empty or if another thread won the race for the item
+    T* steal()
+    {
+        int64_t top = m_top.load(std::memory_order_seq_cst);
+        const int64_t bottom = m_bottom.load(std::memory_order_seq_cst);
+
+        if (top >= bottom)
+        {
+            return nullptr;
+        }
+
+        T* item = m_buffer[top & m_mask].load(std::memory_order_relaxed);
+        if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+        {
+            return nullptr;
+        }
+        return item;
+    }
+
+    int64_t size() const
+    {
+        const int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+        const int64_t top    = m_top.load(std::memory_order_relaxed);
+        return std::max<int64_t>(bottom - top, 0);
+    }
+
+private:
+    // top and bottom live on different cache lines since thieves hammer top while the owner works on bottom
+    alignas(64) std::atomic<int64_t> m_top{0};
+    alignas(64) std::atomic<int64_t> m_bottom{0};
+    const int64_t m_capacity;
+    const int64_t m_mask;
+    std::unique_ptr<std::atomic<T*>[]> m_buffer;
+};
+
+// Type erased void() callable with inline storage, the pool keeps a preallocated array of these
+// so submitting a task doesn't touch the heap. Callables that don't fit fall back to the heap.
+class alignas(64) PoolTask
+{
+public:
+    static constexpr size_t INLINE_STORAGE_SIZE = 96;
+
+    template<typename F>
+    static constexpr bool fitsInline()
+    {
+        return sizeof(F) <= INLINE_STORAGE_SIZE && alignof(F) <= alignof(std::max_align_t);
+    }
+
+    // Returns false if the callable had to be heap allocated
+    template<typename F>
+    bool emplace(F&& f)
+    {
+        using Callable = std::decay_t<F>;
+        if constexpr (fitsInline<Callable>())
+        {
+            new (m_storage) Callable(std::forward<F>(f));
+            m_run = [](void* storage)
+            {
+                Callable* callable = std::launder(reinterpret_cast<Callable*>(storage));
+                (*callable)();
+                callable->~Callable();
+            };
+            return true;
+        }
+        else
+        {
+            new (m_storage) Callable*(new Callable(std::forward<F>(f)));
+            m_run = [](void* storage)
+            {
+                Callable* callable = *std::launder(reinterpret_cast<Callable**>(storage));
+                (*callable)();
+                delete callable;
+            };
+            return false;
+        }
+    }
+
+    // Runs and destroys the callable
+    void run()
+    {
+        m_run(m_storage);
+    }
+
+    std::atomic<bool> m_in_use{false};
+    bool m_heap_allocated{false}; // Set when the slot array was exhausted and the task itself came from new
+
+private:
+    alignas(std::max_align_t) unsigned char m_storage[INLINE_STORAGE_SIZE];
+    void (*m_run)(void*){nullptr};
+};
+
+// Fixed capacity FIFO of task pointers, not thread safe (callers hold a lock).
+// Overflows into a std::deque so it never fails, but in steady state it never allocates.
+class TaskRing
+{
+public:
+    static constexpr int64_t CAPACITY = 1024;
+
+    bool empty() const
+    {
+        return m_size == 0 && m_overflow.empty();
+    }
+
+    void push(PoolTask* task)
+    {
+        if (m_size < CAPACITY && m_overflow.empty())
+        {
+            m_buffer[(m_head + m_size) % CAPACITY] = task;
+            m_size++;
+        }
+        else
+        {
+            m_overflow.push_back(task);
+        }
+    }
+
+    PoolTask* pop()
+    {
+        if (m_size > 0)
+        {
+            PoolTask* task = m_buffer[m_head];
+            m_head = (m_head + 1) % CAPACITY;
+            m_size--;
+            return task;
+        }
+        if (!m_overflow.empty())
+        {
+            PoolTask* task = m_overflow.front();
+            m_overflow.pop_front();
+            return task;
+        }
+        return nullptr;
+    }
+
+private:
+    PoolTask* m_buffer[CAPACITY];
+    int64_t m_head{0};
+    int64_t m_size{0};
+    std::deque<PoolTask*> m_overflow;
+};
+
+// Pairwise tree over the leaves [first_leaf, last_leaf), leaf(i) -> T and combine(T, T) -> T.
+// The split is always at the largest power of two below the leaf count, so every power of two aligned
+// run of leaves is a subtree. Reducing such runs separately and then combining their results with this
+// same function gives exactly the same tree (and the same rounding) as reducing all the leaves at once.
+template<typename T, typename LeafF, typename CombineF>
+T pairwiseReduceLeaves(const int64_t first_leaf, const int64_t last_leaf, LeafF&& leaf, CombineF&& combine)
+{
+    const int64_t num_leaves = last_leaf - first_leaf;
+    if (num_leaves == 1)
+    {
+        return leaf(first_leaf);
+    }
+    const int64_t split = first_leaf + static_cast<int64_t>(std::bit_floor(static_cast<uint64_t>(num_leaves - 1)));
+    return combine(pairwiseReduceLeaves<T>(first_leaf, split, leaf, combine), pairwiseReduceLeaves<T>(split, last_leaf, leaf, combine));
+}
+
+// Reduces [begin, end) split into leaves of leaf_size elements, map(leaf_begin, leaf_end) -> T per leaf.
+// The leaves and the tree only depend on the range and leaf_size, ThreadPool::parallel_pairwise_reduce
+// gives a bit identical result on any number of threads.
+template<typename T, typename MapF, typename CombineF>
+T pairwiseReduce(const int64_t begin, const int64_t end, const int64_t leaf_size, const T& identity, MapF&& map, CombineF&& combine)
+{
+    if (end <= begin)
+    {
+        return identity;
+    }
+    const int64_t num_leaves = (end - begin + leaf_size - 1) / leaf_size;
+    auto reduceLeaf = [&](const int64_t leaf)
+    {
+        const int64_t leaf_begin = begin + leaf * leaf_size;
+        return map(leaf_begin, std::min(leaf_begin + leaf_size, end));
+    };
+    return pairwiseReduceLeaves<T>(0, num_leaves, reduceLeaf, combine);
+}
+
+// Per block state for ThreadPool::parallel_scan. Keep one around and pass it to every scan so scanning doesn't
+// allocate. Flags are tagged with the scan's generation, so nothing needs clearing between scans.
+template<typename T>
+class ScanBlockStates
+{
+public:
+    void reserve(const int64_t num_blocks)
+    {
+        if (num_blocks > m_capacity)
+        {
+            m_states = std::make_unique<BlockState[]>(num_blocks);
+            m_capacity = num_blocks;
+        }
+    }
+
+private:
+    friend class ThreadPool;
+
+    // One cache line each, neighbouring blocks are published by different workers
+    struct alignas(64) BlockState
+    {
+        std::atomic<uint64_t> flag{0}; // generation * 4 + AGGREGATE or PREFIX
+        T aggregate{};
+        T inclusive_prefix{};
+    };
+    static constexpr uint64_t AGGREGATE = 1;
+    static constexpr uint64_t PREFIX = 2;
+
+    std::unique_ptr<BlockState[]> m_states;
+    int64_t m_capacity{0};
+    uint64_t m_generation{0};
+};
 
 class ThreadPool{
 public:
+    using Task = PoolTask;
+
     // Constructor that spawns a number of threads equal to size
-    ThreadPool(const int64_t size) : busy_threads(size), m_threads(std::vector<std::thread>(size)), m_shutdown_requested(false)
+    // worker_cpus pins worker i to CPU worker_cpus[i % worker_cpus.size()] (Linux only, ignored elsewhere). Empty leaves
+    // the workers to the scheduler. Pinning happens before the worker runs anything, so memory it first touches is
+    // placed on its NUMA node and stays there.
+    ThreadPool(const int64_t size, const THREAD_POOL_MODE mode = THREAD_POOL_MODE::WORK_STEALING, const std::vector<int>& worker_cpus = {})
+        : m_threads(std::vector<std::thread>(size)), m_mode(mode), m_shutdown_requested(false), m_worker_cpus(worker_cpus)
     {
         m_number_of_threads = size;
+        m_task_slots = std::make_unique<PoolTask[]>(TASK_SLOTS);
+        for (int64_t i = 0; m_mode == THREAD_POOL_MODE::WORK_STEALING && i < size; ++i)
+        {
+            m_worker_queues.push_back(std::make_unique<WorkerQueues>());
+        }
         for (int64_t i = 0; i < size; ++i)
         {
-            m_threads[i] = std::thread(ThreadWorker(this));
+            m_threads[i] = std::thread(ThreadWorker(this, i));
         }
     }
 
@@ -72,69 +378,291 @@ public:
     ThreadPool& operator=(const ThreadPool&) = delete;
     ThreadPool& operator=(ThreadPool&&)      = delete;
 
+    // Number of tasks that are queued but have not been picked up by a worker yet
     int getQueueSize()
     {
-        std::unique_lock<std::mutex> lock(m_mutex);
-        return m_queue.size();
+        return static_cast<int>(std::max<int64_t>(m_queued_tasks.load(), 0));
     }
 
-    void waitUntilAllTasksFinished()
+    THREAD_POOL_MODE getMode() const
     {
-        while (true)
+        return m_mode;
+    }
+
+    int64_t getNumberOfThreads() const
+    {
+        return m_number_of_threads;
+    }
+
+    // CPUs this process may run on, in order. Consecutive CPUs are usually on the same NUMA node, so handing this to
+    // the constructor keeps neighbouring workers together. Empty where affinity isn't supported.
+    static std::vector<int> availableCpus()
+    {
+        std::vector<int> cpus;
+    #ifdef __linux__
+        cpu_set_t cpu_set;
+        CPU_ZERO(&cpu_set);
+        if (sched_getaffinity(0, sizeof(cpu_set), &cpu_set) == 0)
         {
+            for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
             {
-                std::unique_lock<std::mutex> lock(m_mutex);
-                if (m_queue.empty() && busy_threads.load() == 0)
+                if (CPU_ISSET(cpu, &cpu_set))
                 {
-                    break;
+                    cpus.push_back(cpu);
                 }
             }
-            std::this_thread::sleep_for(std::chrono::microseconds(1));
         }
+    #endif
+        return cpus;
+    }
+
+    // Waits for every task in the pool, including ones other callers submitted.
+    // Prefer a TaskGroup when you only care about your own tasks.
+    void waitUntilAllTasksFinished()
+    {
+        waitUntilZero(m_unfinished_tasks);
+    }
+
+    // Tracks only the tasks submitted through it so waits don't depend on unrelated work in the pool.
+    // wait() spins for a short while (helping run queued tasks), then sleeps on a futex (std::atomic::wait).
+    // Tasks added through a group are fire and forget, write results into memory the caller owns.
+    class TaskGroup
+    {
+    public:
+        explicit TaskGroup(ThreadPool& pool) : m_pool(pool)
+        {
+        }
+
+        ~TaskGroup()
+        {
+            wait();
+        }
+
+        TaskGroup(const TaskGroup&) = delete;
+        TaskGroup& operator=(const TaskGroup&) = delete;
+
+        template<typename F, typename... Args>
+        void AddTask(F&& f, Args&&... args)
+        {
+            auto func = std::bind(std::forward<F>(f), std::forward<Args>(args)...);
+
+            m_pending_tasks.fetch_add(1, std::memory_order_relaxed);
+
+            // Capture the pool separately, once the count hits zero the waiter may destroy the group
+            m_pool.pushTask(m_pool.makeTask([group = this, pool = &m_pool, func = std::move(func)]() mutable
+            {
+                func();
+                if (group->m_pending_tasks.fetch_sub(1) == 1)
+                {
+                    pool->signalCompletion();
+                }
+            }));
+        }
+
+        void wait()
+        {
+            m_pool.waitUntilZero(m_pending_tasks);
+        }
+
+    private:
+        ThreadPool& m_pool;
+        alignas(64) std::atomic<int64_t> m_pending_tasks{0};
+    };
+
+    // Resolves the grain (elements per chunk) parallel_for will actually use.
+    // grain <= 0 means automatic: CHUNKS_PER_THREAD chunks per worker so stealing can rebalance uneven cores.
+    int64_t getGrainSize(const int64_t count, const int64_t grain) const
+    {
+        constexpr int64_t CHUNKS_PER_THREAD = 4;
+        if (grain > 0)
+        {
+            return grain;
+        }
+        const int64_t num_chunks = std::max<int64_t>(m_number_of_threads * CHUNKS_PER_THREAD, 1);
+        return std::max<int64_t>((count + num_chunks - 1) / num_chunks, 1);
     }
 
-    static std::vector<std::vector<int64_t>> getSplitWorkIndices(const int64_t m_number_of_threads, const int64_t input_size) 
+    // Calls fn(chunk_begin, chunk_end) over [begin, end) split into chunks of grain elements.
+    // Chunks are handed out dynamically through one atomic counter, so fast workers just take more of them.
+    // The calling thread works on chunks too and returns once every chunk is done.
+    template<typename F>
+    void parallel_for(const int64_t begin, const int64_t end, const int64_t grain, F&& fn)
     {
-        const int64_t p = std::min(m_number_of_threads, input_size);
-        std::vector<std::vector<int64_t>> result;
-        for (int64_t i = 0; i < p; ++i)
+        if (end <= begin)
         {
-            std::vector<int64_t> chunk = {};
+            return;
+        }
+        const int64_t chunk_size = getGrainSize(end - begin, grain);
+        const int64_t num_chunks = (end - begin + chunk_size - 1) / chunk_size;
 
-            int64_t start_index = std::floor((i * input_size)/(p));
-            int64_t end_index   = std::floor(((i+1) * input_size)/(p));
-            for (int64_t j = start_index; j < end_index; ++j)
+        alignas(64) std::atomic<int64_t> next_chunk{0};
+        auto runChunks = [&]()
+        {
+            for (int64_t chunk = next_chunk.fetch_add(1, std::memory_order_relaxed); chunk < num_chunks; chunk = next_chunk.fetch_add(1, std::memory_order_relaxed))
             {
-                chunk.push_back(j);
+                const int64_t chunk_begin = begin + chunk * chunk_size;
+                fn(chunk_begin, std::min(chunk_begin + chunk_size, end));
             }
-            result.push_back(chunk);
+        };
+        static_assert(PoolTask::fitsInline<decltype(runChunks)>(), "parallel_for tasks must fit in a PoolTask");
+
+        TaskGroup task_group{*this};
+        const int64_t num_helpers = std::min(m_number_of_threads, num_chunks) - 1;
+        for (int64_t i = 0; i < num_helpers; ++i)
+        {
+            task_group.AddTask(runChunks);
         }
+        runChunks();
+        task_group.wait();
+    }
 
+    // Reduces [begin, end) with map(chunk_begin, chunk_end) -> T per chunk and combine(T, T) -> T across chunks.
+    // Chunk results are combined in chunk order so the result only depends on the grain, not on which worker ran what.
+    // Partials live on the stack, so the grain is raised if needed to keep at most MAX_REDUCE_CHUNKS chunks.
+    template<typename T, typename MapF, typename CombineF>
+    T parallel_reduce(const int64_t begin, const int64_t end, const int64_t grain, const T& identity, MapF&& map, CombineF&& combine)
+    {
+        if (end <= begin)
+        {
+            return identity;
+        }
+        const int64_t min_chunk_size = (end - begin + MAX_REDUCE_CHUNKS - 1) / MAX_REDUCE_CHUNKS;
+        const int64_t chunk_size = std::max(getGrainSize(end - begin, grain), min_chunk_size);
+        const int64_t num_chunks = (end - begin + chunk_size - 1) / chunk_size;
+
+        std::array<T, MAX_REDUCE_CHUNKS> partials;
+        parallel_for(begin, end, chunk_size, [&](const int64_t chunk_begin, const int64_t chunk_end)
+        {
+            partials[(chunk_begin - begin) / chunk_size] = map(chunk_begin, chunk_end);
+        });
+
+        T result = identity;
+        for (int64_t chunk = 0; chunk < num_chunks; ++chunk)
+        {
+            result = combine(result, partials[chunk]);
+        }
         return result;
     }
 
-    // You need to profile if this is worth it
-    template<typename T>
-    void copyVector(std::vector<T>& output_vec, const std::vector<T>& input_vec)
+    // Same result as pairwiseReduce(begin, end, leaf_size, ...) down to the last bit, whatever the thread count or grain.
+    // Chunks are a power of two number of leaves so each one is a subtree of the fixed tree, the chunk results are
+    // then combined with the top of that tree. Use this when runs need to be diffed across machines.
+    template<typename T, typename MapF, typename CombineF>
+    T parallel_pairwise_reduce(const int64_t begin, const int64_t end, const int64_t leaf_size, const int64_t grain, const T& identity, MapF&& map, CombineF&& combine)
     {
-        auto copyLocal = [](const std::vector<T>& input_vec, std::vector<T>& output_vec, const std::vector<int64_t>& indices_chunk) 
-        { 
-            for (int64_t i = indices_chunk.front(); i <= indices_chunk.back(); ++i)
+        if (end <= begin)
+        {
+            return identity;
+        }
+        const int64_t num_leaves = (end - begin + leaf_size - 1) / leaf_size;
+        const int64_t grain_leaves = (getGrainSize(end - begin, grain) + leaf_size - 1) / leaf_size;
+        const int64_t min_chunk_leaves = (num_leaves + MAX_REDUCE_CHUNKS - 1) / MAX_REDUCE_CHUNKS;
+        const int64_t chunk_leaves = static_cast<int64_t>(std::bit_ceil(static_cast<uint64_t>(std::max(grain_leaves, min_chunk_leaves))));
+        const int64_t num_chunks = (num_leaves + chunk_leaves - 1) / chunk_leaves;
+
+        auto reduceLeaf = [&](const int64_t leaf)
+        {
+            const int64_t leaf_begin = begin + leaf * leaf_size;
+            return map(leaf_begin, std::min(leaf_begin + leaf_size, end));
+        };
+
+        std::array<T, MAX_REDUCE_CHUNKS> partials;
+        parallel_for(0, num_chunks, 1, [&](const int64_t first_chunk, const int64_t last_chunk)
+        {
+            for (int64_t chunk = first_chunk; chunk < last_chunk; ++chunk)
             {
-                output_vec[i] = input_vec[i];
+                const int64_t first_leaf = chunk * chunk_leaves;
+                partials[chunk] = pairwiseReduceLeaves<T>(first_leaf, std::min(first_leaf + chunk_leaves, num_leaves), reduceLeaf, combine);
             }
+        });
+
+        auto chunkPartial = [&](const int64_t chunk)
+        {
+            return partials[chunk];
         };
+        return pairwiseReduceLeaves<T>(0, num_chunks, chunkPartial, combine);
+    }
 
-        // Split work evenly
-        std::vector<std::vector<int64_t>> mutation_indicies_chunks = getSplitWorkIndices(input_vec.size());
+    // Single pass inclusive scan with decoupled look-back (Merrill and Garland, "Single-pass Parallel Prefix Scan with
+    // Decoupled Look-back"). [0, count) is split into blocks of block_size that are claimed in order from one counter.
+    // scan_block(block_begin, block_end) -> T scans a block on its own and returns its total, which is published
+    // straight away. The block then looks back over its predecessors until one has published its running total,
+    // publishes its own, and calls add_offset(block_begin, block_end, offset) while the block is still in cache.
+    // add_offset isn't called for block 0. Every element is read and written once, with no barrier between phases.
+    //
+    // The look-back combines the totals it found in block order, so a block's offset is always the left fold
+    // ((t0 + t1) + t2) + ... of the block totals and the result doesn't depend on the thread count or timing.
+    template<typename T, typename ScanBlockF, typename AddOffsetF, typename CombineF>
+    void parallel_scan(const int64_t count, const int64_t block_size, ScanBlockStates<T>& states, ScanBlockF&& scan_block, AddOffsetF&& add_offset, CombineF&& combine)
+    {
+        if (count <= 0)
+        {
+            return;
+        }
+        const int64_t num_blocks = (count + block_size - 1) / block_size;
+        states.reserve(num_blocks);
+        const uint64_t generation = ++states.m_generation;
+        const uint64_t aggregate_flag = generation * 4 + ScanBlockStates<T>::AGGREGATE;
+        const uint64_t prefix_flag = generation * 4 + ScanBlockStates<T>::PREFIX;
+        auto* block_states = states.m_states.get();
+
+        alignas(64) std::atomic<int64_t> next_block{0};
+        auto runBlocks = [&]()
+        {
+            // Blocks are claimed in order, so the blocks being waited on are always already being worked on
+            for (int64_t block = next_block.fetch_add(1, std::memory_order_relaxed); block < num_blocks; block = next_block.fetch_add(1, std::memory_order_relaxed))
+            {
+                const int64_t block_begin = block * block_size;
+                const int64_t block_end = std::min(block_begin + block_size, count);
+                const T aggregate = scan_block(block_begin, block_end);
+
+                auto& state = block_states[block];
+                if (block == 0)
+                {
+                    state.inclusive_prefix = aggregate;
+                    state.flag.store(prefix_flag, std::memory_order_release);
+                    continue;
+                }
+                state.aggregate = aggregate;
+                state.flag.store(aggregate_flag, std::memory_order_release);
+
+                int64_t lookback = block - 1;
+                while (waitForScanFlag(block_states[lookback].flag, aggregate_flag) != prefix_flag)
+                {
+                    --lookback;
+                }
+                T offset = block_states[lookback].inclusive_prefix;
+                for (int64_t previous = lookback + 1; previous < block; ++previous)
+                {
+                    offset = combine(offset, block_states[previous].aggregate);
+                }
+                state.inclusive_prefix = combine(offset, aggregate);
+                state.flag.store(prefix_flag, std::memory_order_release);
+
+                add_offset(block_begin, block_end, offset);
+            }
+        };
+        static_assert(PoolTask::fitsInline<decltype(runBlocks)>(), "parallel_scan tasks must fit in a PoolTask");
 
-        std::vector<std::future<void>> futures;
-        for (const auto& indices_chunk : mutation_indicies_chunks)
+        TaskGroup task_group{*this};
+        const int64_t num_helpers = std::min(m_number_of_threads, num_blocks) - 1;
+        for (int64_t i = 0; i < num_helpers; ++i)
         {
-            auto future = this->AddTask(copyLocal, std::ref(input_vec), std::ref(output_vec), std::ref(indices_chunk));
-            futures.push_back(std::move(future));
+            task_group.AddTask(runBlocks);
         }
-        this->waitUntilAllTasksFinished();
+        runBlocks();
+        task_group.wait();
+    }
+
+    // You need to profile if this is worth it
+    template<typename T>
+    void copyVector(std::vector<T>& output_vec, const std::vector<T>& input_vec)
+    {
+        output_vec.resize(input_vec.size());
+        parallel_for(0, input_vec.size(), 0, [&](const int64_t chunk_begin, const int64_t chunk_end)
+        {
+            std::copy(input_vec.begin() + chunk_begin, input_vec.begin() + chunk_end, output_vec.begin() + chunk_begin);
+        });
     }
 
     // Template by F (function type) and args because we have an unknown amount of args
@@ -157,18 +685,25 @@ public:
         // we need to be able to copy it to put it into the lambda
         auto task_ptr = std::make_shared<std::packaged_task<decltype(f(args...))()>>(func);
 
-        auto wrapper_func = [task_ptr]() { (*task_ptr)(); };
-
-        {
-            std::lock_guard<std::mutex> lock(m_mutex);
-            m_queue.push(wrapper_func);
-            // Wake up one thread if its waiting
-            m_condition_variable.notify_one(); // Notify threads by using the condition variable that there is a new task
-        }
+        pushTask(makeTask([task_ptr]() { (*task_ptr)(); }));
 
         return task_ptr->get_future();
     }
 
+    // Fire and forget version of AddTask. No future, no packaged_task, and the task lives in a
+    // preallocated slot so in steady state this never touches the heap.
+    template<typename F, typename... Args>
+    void AddDetachedTask(F&& f, Args&&... args)
+    {
+        pushTask(makeTask(std::bind(std::forward<F>(f), std::forward<Args>(args)...)));
+    }
+
+    // Number of tasks that needed the heap because the callable was too big or every slot was busy
+    int64_t getHeapTaskAllocations() const
+    {
+        return m_heap_task_allocations.load(std::memory_order_relaxed);
+    }
+
     // Waits until threads finish their current task and shutdowns the pool
     void Shutdown()
     {
@@ -190,37 +725,96 @@ public:
     class ThreadWorker
     {
       public:
-        ThreadWorker(ThreadPool* pool) : thread_pool(pool)
+        ThreadWorker(ThreadPool* pool, const int64_t worker_index) : thread_pool(pool), m_worker_index(worker_index)
         {
         }
 
         void operator()() // Function the thread work will immidiatly execute when it is spawned regaredless of tasks
+        {
+            tls_current_pool  = thread_pool;
+            tls_worker_index  = m_worker_index;
+            pinToCpu();
+
+            switch (thread_pool->m_mode)
+            {
+                case THREAD_POOL_MODE::WORK_STEALING:
+                    runWorkStealing();
+                    break;
+                case THREAD_POOL_MODE::SHARED_QUEUE:
+                    runSharedQueue();
+                    break;
+            }
+        }
+
+      private:
+        void pinToCpu()
+        {
+            const std::vector<int>& worker_cpus = thread_pool->m_worker_cpus;
+            if (worker_cpus.empty())
+            {
+                return;
+            }
+        #ifdef __linux__
+            cpu_set_t cpu_set;
+            CPU_ZERO(&cpu_set);
+            CPU_SET(worker_cpus[m_worker_index % static_cast<int64_t>(worker_cpus.size())], &cpu_set);
+            pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set); // Best effort, an unpinned worker still works
+        #endif
+        }
+
+        void runWorkStealing()
+        {
+            while (true)
+            {
+                Task* task = thread_pool->findTask(m_worker_index);
+                if (task != nullptr)
+                {
+                    thread_pool->executeTask(task);
+                    continue;
+                }
+
+                // Nothing to run or steal, go to sleep until someone submits more work
+                std::unique_lock<std::mutex> lock(thread_pool->m_mutex);
+                if (thread_pool->m_shutdown_requested && thread_pool->m_queued_tasks.load() <= 0)
+                {
+                    break;
+                }
+                // The submitter reads m_sleeping_threads after publishing its task, so either it sees us here
+                // and notifies under the lock or we see its task in the predicate. No lost wakeups.
+                thread_pool->m_sleeping_threads++;
+                thread_pool->m_condition_variable.wait(lock, [this]{
+                    return this->thread_pool->m_shutdown_requested || this->thread_pool->m_queued_tasks.load() > 0;
+                });
+                thread_pool->m_sleeping_threads--;
+            }
+        }
+
+        void runSharedQueue()
         {
             std::unique_lock<std::mutex> lock(thread_pool->m_mutex); // Inquire the lock
             while(!thread_pool->m_shutdown_requested || (thread_pool->m_shutdown_requested && !thread_pool->m_queue.empty()))
             { // Keep doing something until the program is shutdown
-                thread_pool->busy_threads--;
                 thread_pool->m_condition_variable.wait(lock, [this]{ // Basically the thread goes to sleep until we need to shutdown or there is a new task to do
                     // There can be spurious wakeups so we need to check the condition in a loop
                     // DIFFICULT BUG TO FIND!
                     return this->thread_pool->m_shutdown_requested || !this->thread_pool->m_queue.empty();
                 });
-                thread_pool->busy_threads++;
 
                 if (!this->thread_pool->m_queue.empty()) // If the queue is not empty then we have work to do!
                 {
-                    auto func = thread_pool->m_queue.front();
-                    thread_pool->m_queue.pop();
+                    Task* task = thread_pool->m_queue.pop();
+                    thread_pool->m_queued_tasks--;
 
                     lock.unlock(); // We only unlock while doing the work everything above has a lock
-                    func();
+                    thread_pool->executeTask(task);
                     lock.lock(); // Relock
                 }
             }
         }
-    private:
+
         // The work needs ascess to the thread pool since it needs access to the queue, mutex, etc
         ThreadPool* thread_pool;
+        int64_t m_worker_index;
     };
 
   public:
@@ -228,13 +822,251 @@ public:
     int64_t m_number_of_threads;
 
   private:
+    static constexpr int64_t DEQUE_CAPACITY = 4096;
+    static constexpr int64_t TASK_SLOTS = 1024; // Power of two
+    static constexpr int64_t MAX_REDUCE_CHUNKS = 1024;
+
+    // Per worker queues. The deque is lock-free and only pushed to by its owner, threads outside the pool
+    // hand tasks to a worker through its inbox instead (Chase-Lev only allows the owner to push).
+    // Round robining the inboxes keeps submitters from all fighting over one lock.
+    struct alignas(64) WorkerQueues
+    {
+        WorkStealingDeque<Task> deque{DEQUE_CAPACITY};
+        std::mutex inbox_mutex;
+        TaskRing inbox;
+    };
+
+    // Grabs a free preallocated slot, the cursor spreads threads over the array so the first try almost always wins
+    template<typename F>
+    Task* makeTask(F&& f)
+    {
+        Task* task = nullptr;
+        for (int64_t attempt = 0; attempt < TASK_SLOTS && task == nullptr; ++attempt)
+        {
+            Task& slot = m_task_slots[m_next_task_slot.fetch_add(1, std::memory_order_relaxed) & (TASK_SLOTS - 1)];
+            bool expected = false;
+            if (!slot.m_in_use.load(std::memory_order_relaxed) && slot.m_in_use.compare_exchange_strong(expected, true, std::memory_order_acquire))
+            {
+                task = &slot;
+            }
+        }
+        if (task == nullptr)
+        {
+            task = new Task();
+            task->m_heap_allocated = true;
+            m_heap_task_allocations.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        if (!task->emplace(std::forward<F>(f)))
+        {
+            m_heap_task_allocations.fetch_add(1, std::memory_order_relaxed);
+        }
+        return task;
+    }
+
+    void pushTask(Task* task)
+    {
+        m_unfinished_tasks++;
+
+        if (m_mode == THREAD_POOL_MODE::SHARED_QUEUE)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_queue.push(task);
+            m_queued_tasks++;
+            // Wake up one thread if its waiting
+            m_condition_variable.notify_one(); // Notify threads by using the condition variable that there is a new task
+            return;
+        }
+
+        if (tls_current_pool == this && m_worker_queues[tls_worker_index]->deque.push(task))
+        {
+            // Tasks spawned from inside a worker stay on that worker unless someone steals them
+        }
+        else
+        {
+            const int64_t target = m_next_inbox.fetch_add(1, std::memory_order_relaxed) % m_number_of_threads;
+            std::lock_guard<std::mutex> lock(m_worker_queues[target]->inbox_mutex);
+            m_worker_queues[target]->inbox.push(task);
+        }
+        m_queued_tasks++;
+
+        if (m_sleeping_threads.load() > 0)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_condition_variable.notify_one();
+        }
+    }
+
+    Task* popInbox(const int64_t index)
+    {
+        WorkerQueues& queues = *m_worker_queues[index];
+        std::lock_guard<std::mutex> lock(queues.inbox_mutex);
+        return queues.inbox.pop();
+    }
+
+    // Own deque first (hot in cache), then own inbox, then try to steal from everyone else
+    Task* findTask(const int64_t index)
+    {
+        Task* task = m_worker_queues[index]->deque.pop();
+        if (task == nullptr)
+        {
+            task = popInbox(index);
+        }
+        for (int64_t offset = 1; task == nullptr && offset < m_number_of_threads; ++offset)
+        {
+            const int64_t victim = (index + offset) % m_number_of_threads;
+            task = m_worker_queues[victim]->deque.steal();
+            if (task == nullptr)
+            {
+                task = popInbox(victim);
+            }
+        }
+
+        if (task != nullptr)
+        {
+            m_queued_tasks--;
+        }
+        return task;
+    }
+
+    void executeTask(Task* task)
+    {
+        busy_threads++;
+        task->run();
+        if (task->m_heap_allocated)
+        {
+            delete task;
+        }
+        else
+        {
+            task->m_in_use.store(false, std::memory_order_release);
+        }
+        busy_threads--;
+        if (m_unfinished_tasks.fetch_sub(1) == 1)
+        {
+            signalCompletion();
+        }
+    }
+
+    // Runs one queued task on the calling worker if there is one. A worker waiting on nested tasks has to
+    // help, otherwise every worker could end up blocked on children nobody is left to run.
+    // Threads outside the pool never help so their waits don't depend on unrelated (possibly long) tasks.
+    bool tryRunPendingTask()
+    {
+        if (tls_current_pool != this)
+        {
+            return false;
+        }
+
+        Task* task = nullptr;
+        if (m_mode == THREAD_POOL_MODE::SHARED_QUEUE)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            task = m_queue.pop();
+            if (task != nullptr)
+            {
+                m_queued_tasks--;
+            }
+        }
+        else if (m_queued_tasks.load(std::memory_order_relaxed) > 0)
+        {
+            task = findTask(tls_worker_index);
+        }
+
+        if (task == nullptr)
+        {
+            return false;
+        }
+        executeTask(task);
+        return true;
+    }
+
+    // Every time a counter someone may be waiting on hits zero we bump the epoch and wake the sleepers.
+    // The epoch lives in the pool (which outlives every TaskGroup) so the last task never touches a dead group.
+    void signalCompletion()
+    {
+        m_completion_epoch.fetch_add(1);
+        m_completion_epoch.notify_all();
+    }
+
+    // Spins until a parallel_scan block has published at least its total in this scan, returns the flag.
+    // The block is always claimed by a running thread, so this only yields in case that thread lost its core.
+    static uint64_t waitForScanFlag(const std::atomic<uint64_t>& flag, const uint64_t aggregate_flag)
+    {
+        constexpr int64_t SPIN_ITERATIONS = 256;
+        for (int64_t i = 0; ; ++i)
+        {
+            const uint64_t value = flag.load(std::memory_order_acquire);
+            if (value >= aggregate_flag)
+            {
+                return value;
+            }
+            if (i < SPIN_ITERATIONS)
+            {
+                cpuRelax();
+            }
+            else
+            {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    void waitUntilZero(const std::atomic<int64_t>& counter)
+    {
+        constexpr int64_t SPIN_ITERATIONS = 2048;
+
+        // Spin phase, the barrier usually resolves within a cache line round trip
+        for (int64_t i = 0; i < SPIN_ITERATIONS; ++i)
+        {
+            if (counter.load(std::memory_order_acquire) == 0)
+            {
+                return;
+            }
+            if (!tryRunPendingTask())
+            {
+                cpuRelax();
+            }
+        }
+
+        // Sleep phase. Load the epoch before re-checking the counter, if the last task finishes in between
+        // the epoch has already moved and wait() returns immediately.
+        while (true)
+        {
+            const uint32_t epoch = m_completion_epoch.load();
+            if (counter.load() == 0)
+            {
+                return;
+            }
+            if (tryRunPendingTask())
+            {
+                continue;
+            }
+            m_completion_epoch.wait(epoch);
+        }
+    }
+
+    inline static thread_local ThreadPool* tls_current_pool = nullptr;
+    inline static thread_local int64_t tls_worker_index = -1;
+
     mutable std::mutex m_mutex;
     std::condition_variable m_condition_variable;
 
     std::vector<std::thread> m_threads;
+    const THREAD_POOL_MODE m_mode;
     bool m_shutdown_requested{false};
+    const std::vector<int> m_worker_cpus; // Empty unless the workers are pinned
 
-    std::queue<std::function<void()>> m_queue;
-};
+    TaskRing m_queue; // Only used in SHARED_QUEUE mode
+    std::vector<std::unique_ptr<WorkerQueues>> m_worker_queues; // Only used in WORK_STEALING mode
+    std::atomic<int64_t> m_next_inbox{0};
 
+    std::unique_ptr<PoolTask[]> m_task_slots;
+    std::atomic<int64_t> m_next_task_slot{0};
+    std::atomic<int64_t> m_heap_task_allocations{0};
 
+    std::atomic<int64_t> m_queued_tasks{0};     // Submitted but not picked up yet
+    std::atomic<int64_t> m_unfinished_tasks{0}; // Submitted but not finished yet
+    std::atomic<int64_t> m_sleeping_threads{0};
+    std::atomic<uint32_t> m_completion_epoch{0};
+};